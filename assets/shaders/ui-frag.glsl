@@ -1,23 +1,36 @@
 #version 330
 
 in vec2 texCoord0;
+flat in vec4 addColor;
+flat in vec4 multColor;
+flat in vec4 topMult;
+flat in vec4 texRect;	// (x, y, width, height) of the texture in its layer, in texels
+flat in vec4 texInfo;	// (layer, is glyph, unused, unused)
+
 out vec4 outputColor;
 
-uniform sampler2D gTexture;
+uniform sampler2DArray gTexture;
+uniform sampler2DArray gGlyphTexture;
 uniform sampler2D gDitherTexture;
 
-uniform vec4 gAddColor;
-uniform vec4 gMultColor;
-uniform vec4 gTopMult;
-
+vec3 layerCoord(vec2 coord, sampler2DArray layers);
 int inBorder();
 
 void main()
 {
-	vec4 texColor = gAddColor
-		+ gMultColor * texture(gTexture, vec2(texCoord0.s, texCoord0.t));
-
-	texColor = texColor * mix(gTopMult,
+	// Glyphs use multColor as the text color and the glyph's red channel as alpha.
+	if (texInfo.y > 0.5)
+	{
+		vec3 glyphCoord = layerCoord(vec2(texCoord0.s, 1 - texCoord0.t), gGlyphTexture);
+		outputColor = vec4(multColor.rgb,
+			multColor.a * texture(gGlyphTexture, glyphCoord).r);
+		return;
+	}
+
+	vec4 texColor = addColor
+		+ multColor * texture(gTexture, layerCoord(texCoord0, gTexture));
+
+	texColor = texColor * mix(topMult,
 							  vec4(1, 1, 1, 1),
 							  texCoord0.t);
 	//gl_FragCoord.y/960);
@@ -29,6 +42,16 @@ void main()
 	outputColor += texture(gDitherTexture, gl_FragCoord.xy / 8.0).r / 32.0 - (1.0 / 128.0);
 }
 
+vec3 layerCoord(vec2 coord, sampler2DArray layers)
+{
+	// Stay half a texel inside the texture's rect, so that filtering doesn't
+	// pick up whatever is packed next to it.
+	vec2 texel = clamp(texRect.xy + coord * texRect.zw,
+					   texRect.xy + 0.5,
+					   texRect.xy + texRect.zw - 0.5);
+	return vec3(texel / textureSize(layers, 0).xy, texInfo.x);
+}
+
 int inBorder()
 {
 	// Note - This is not a great way of doing this, it basically only works
@@ -0,0 +1,13 @@
+#version 330
+
+in vec2 texCoord0;
+
+out vec4 outputColor;
+
+// The retained UI layer, with premultiplied alpha.
+uniform sampler2D gTexture;
+
+void main()
+{
+	outputColor = texture(gTexture, texCoord0);
+}
@@ -0,0 +1,12 @@
+#version 330
+
+layout(location = 0) in vec3 position;
+
+out vec2 texCoord0;
+
+// Stretches the UI plane, which spans [0, 1], over the whole screen.
+void main()
+{
+	gl_Position = vec4(position.xy * 2.0 - 1.0, 0.0, 1.0);
+	texCoord0 = position.xy;
+}
@@ -0,0 +1,32 @@
+#version 330
+
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 normal;
+layout(location = 2) in vec2 texCoord;
+
+// Per-instance values (see DrawSystem::UIInstance).
+layout(location = 3) in mat4 instWorld;
+layout(location = 7) in vec4 instAddColor;
+layout(location = 8) in vec4 instMultColor;
+layout(location = 9) in vec4 instTopMult;
+layout(location = 10) in vec4 instTexRect;
+layout(location = 11) in vec4 instTexInfo;
+
+out vec2 texCoord0;
+flat out vec4 addColor;
+flat out vec4 multColor;
+flat out vec4 topMult;
+flat out vec4 texRect;
+flat out vec4 texInfo;
+
+void main()
+{
+	gl_Position = instWorld * vec4(position, 1.0);
+	texCoord0 = texCoord;
+
+	addColor = instAddColor;
+	multColor = instMultColor;
+	topMult = instTopMult;
+	texRect = instTexRect;
+	texInfo = instTexInfo;
+}
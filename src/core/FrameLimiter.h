@@ -0,0 +1,37 @@
+#pragma once
+
+#include "core/BaseTypes.h"
+
+namespace tetrad {
+
+/** @brief Holds frames to a target frame time.
+ *
+ * OS sleeps are only accurate to a millisecond or so, and often overshoot by
+ * more. The limiter sleeps in short slices for as long as it's safe to,
+ * estimating how long a slice really takes as it goes, and spins for the rest
+ * of the frame. This hits the target with far less jitter than a single sleep,
+ * while only spinning for a small part of the frame.
+ */
+class FrameLimiter
+{
+ public:
+  FrameLimiter();
+
+  /** @brief Set the target frame time. 0 disables the limiter. */
+  void SetTargetFrameTime(deltaTime_t frameTime);
+  inline deltaTime_t GetTargetFrameTime() const { return m_TargetNs * 1e-9f; }
+  inline bool IsEnabled() const { return m_TargetNs > 0; }
+
+  /** @brief Wait until a full target frame time has passed since the last Wait. */
+  void Wait();
+
+ private:
+  int64_t m_TargetNs;
+  int64_t m_FrameStart;  // Deadline of the previous frame
+
+  // EMWA of the mean and variance of how long a sleep slice really takes.
+  double m_SleepAvg;
+  double m_SleepVariance;
+};
+
+}  // namespace tetrad
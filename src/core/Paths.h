@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Config.h"
+#include "core/Platform.h"
 
 namespace tetrad {
 
@@ -9,6 +10,7 @@ const std::string TEXTURE_PATH = ASSET_PATH + "textures/";
 const std::string SHADER_PATH = ASSET_PATH + "shaders/";
 const std::string FONT_PATH = ASSET_PATH + "fonts/";
 const std::string MODEL_PATH = ASSET_PATH + "models/";
+const std::string SHADER_CACHE_PATH = getUserCachePath() + "shader-cache/";
 
 /** Textures */
 const std::string FLOOR_PATH = TEXTURE_PATH + "Floor.tga";
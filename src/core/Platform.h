@@ -11,6 +11,10 @@ extern const std::string kVersionString;
 // Run at the beginning of execution to do platform-specific initialization
 bool programInitialize();
 
+// Directory for files the game can regenerate, outside of the asset tree.
+// Doesn't create it.
+std::string getUserCachePath();
+
 #define EP_INVALID 0
 #define EP_LINUX   1
 #define EP_WINDOWS 2
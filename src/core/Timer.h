@@ -6,8 +6,9 @@ namespace tetrad {
 
 /** @brief Handles timing details (particularily with pausing and getting delta times).
  *
- * Essentially abstracts away GLFW-specific details from the rest
- * of the game.
+ * Times are kept as 64-bit nanosecond counts of a monotonic clock, so they
+ * don't lose precision as the game runs, and are only converted to
+ * deltaTime_t once they're relative.
  */
 class Timer
 {
@@ -23,14 +24,25 @@ class Timer
   void Pause();
   void Resume();
 
+  /** @brief Get the time since the last Tick, clamped to MAX_DELTA_TIME.
+   *
+   * The clamp keeps a long stall (e.g. a breakpoint or the window being
+   * dragged) from turning into a huge simulation step.
+   */
   deltaTime_t Tick();
   deltaTime_t GetTotalTime();
 
+  /** @brief Current time of the monotonic clock, in nanoseconds. */
+  static int64_t GetTimeNs();
+
+ public:
+  static const deltaTime_t MAX_DELTA_TIME;
+
  private:
-  deltaTime_t m_StartTime;
+  int64_t m_StartTime;
 
-  deltaTime_t m_CurrTime;
-  deltaTime_t m_PrevTime;
+  int64_t m_CurrTime;
+  int64_t m_PrevTime;
   deltaTime_t m_DeltaTime;
 
   bool m_Paused;
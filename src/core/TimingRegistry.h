@@ -0,0 +1,63 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "core/BaseTypes.h"
+
+namespace tetrad {
+
+/** @brief Named set of timings (e.g. render passes), tracked in milliseconds.
+ *
+ * Each timing keeps its latest sample along with an EMWA, so that values are
+ * readable in the debug overlay. Timings are kept in the order they were
+ * first recorded.
+ *
+ * Timings can be recorded and read from different threads, so reads return
+ * copies.
+ */
+class TimingRegistry
+{
+ public:
+  struct Timing
+  {
+    std::string name;
+    float lastMs;
+    float avgMs;  // EMWA of samples.
+    uint64_t sampleCount;
+  };
+
+  explicit TimingRegistry(float avgAlpha = .125f);
+
+  /** @brief Add a sample to a timing, creating the timing if needed. */
+  void Record(const std::string &name, float ms);
+
+  /** @brief Get a timing by name.
+   *
+   * @return false if the timing was never recorded.
+   */
+  bool Find(const std::string &name, Timing &timing) const;
+
+  std::vector<Timing> GetTimings() const;
+
+  /** @brief Write all timings to a CSV file, with a header row. */
+  bool DumpCsv(const std::string &path) const;
+
+  /** @brief Returns a static instance of TimingRegistry. */
+  static TimingRegistry &GetGlobalInstance()
+  {
+    static TimingRegistry registry;
+    return registry;
+  }
+
+ private:
+  float m_AvgAlpha;
+
+  mutable std::mutex m_Mutex;
+  std::vector<Timing> m_Timings;
+  std::unordered_map<std::string, size_t> m_Indices;
+};
+
+}  // namespace tetrad
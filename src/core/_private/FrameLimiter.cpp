@@ -0,0 +1,75 @@
+#include "core/FrameLimiter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+#include "core/Timer.h"
+
+namespace tetrad {
+
+namespace {
+constexpr int64_t kSleepSliceNs = 1000000;
+
+// The estimate is seeded pessimistically, and keeps adapting in case the
+// scheduler's behavior changes.
+constexpr double kInitialSleepEstimateNs = 5e6;
+constexpr double kSleepAlpha = .05;
+}  // namespace
+
+FrameLimiter::FrameLimiter()
+    : m_TargetNs(0),
+      m_FrameStart(0),
+      m_SleepAvg(kInitialSleepEstimateNs),
+      m_SleepVariance(0)
+{}
+
+void FrameLimiter::SetTargetFrameTime(deltaTime_t frameTime)
+{
+  m_TargetNs = std::max<int64_t>(int64_t(double(frameTime) * 1e9), 0);
+  m_FrameStart = Timer::GetTimeNs();
+}
+
+void FrameLimiter::Wait()
+{
+  if (!IsEnabled())
+  {
+    return;
+  }
+
+  const int64_t deadline = m_FrameStart + m_TargetNs;
+  int64_t now = Timer::GetTimeNs();
+
+  // Sleep while a slice, at its pessimistic estimate, still ends before the deadline.
+  while (true)
+  {
+    double estimate = m_SleepAvg + std::sqrt(m_SleepVariance);
+    if (double(deadline - now) <= estimate)
+    {
+      break;
+    }
+
+    std::this_thread::sleep_for(std::chrono::nanoseconds(kSleepSliceNs));
+    int64_t after = Timer::GetTimeNs();
+    double observed = double(after - now);
+    now = after;
+
+    double delta = observed - m_SleepAvg;
+    m_SleepAvg += kSleepAlpha * delta;
+    m_SleepVariance = (1 - kSleepAlpha) * (m_SleepVariance + kSleepAlpha * delta * delta);
+  }
+
+  // Spin out the rest of the frame.
+  while (now < deadline)
+  {
+    std::this_thread::yield();
+    now = Timer::GetTimeNs();
+  }
+
+  // Late frames restart the schedule instead of trying to catch up with
+  // several short frames in a row.
+  m_FrameStart = (now - deadline > m_TargetNs) ? now : deadline;
+}
+
+}  // namespace tetrad
@@ -1,5 +1,7 @@
 #include "core/Platform.h"
 
+#include <cstdlib>
+
 namespace tetrad {
 #if (SYSTEM_TYPE == EP_WINDOWS)
 #include <windows.h>
@@ -24,6 +26,32 @@ bool programInitialize()
   return success;
 }
 
+std::string getUserCachePath()
+{
+  const char *pBase = nullptr;
+  std::string subPath;
+#if (SYSTEM_TYPE == EP_WINDOWS)
+  pBase = std::getenv("LOCALAPPDATA");
+#elif (SYSTEM_TYPE == EP_MAC_OSX)
+  pBase = std::getenv("HOME");
+  subPath = "/Library/Caches";
+#else
+  pBase = std::getenv("XDG_CACHE_HOME");
+  if (!pBase || !*pBase)
+  {
+    pBase = std::getenv("HOME");
+    subPath = "/.cache";
+  }
+#endif
+
+  if (!pBase || !*pBase)
+  {
+    // Relative to the working directory, as a last resort
+    return "tetrad-cache/";
+  }
+  return std::string(pBase) + subPath + "/tetrad/";
+}
+
 #ifdef _CUSTOM_BSWAP
 uint16_t bswap16(uint16_t value)
 {
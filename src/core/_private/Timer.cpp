@@ -1,17 +1,20 @@
 #include "core/Timer.h"
 
-#include "core/GlTypes.h"
+#include <algorithm>
+#include <chrono>
 
 namespace tetrad {
-const deltaTime_t MAX_DELTA_TIME = 0.1f;
+const deltaTime_t Timer::MAX_DELTA_TIME = 0.1f;
 const deltaTime_t DEFAULT_DELTA_TIME = 0.016666f;
 
-Timer::Timer() : m_StartTime(0.0), m_CurrTime(0.0), m_PrevTime(0.0), m_Paused(true) {}
+Timer::Timer()
+    : m_StartTime(0), m_CurrTime(0), m_PrevTime(0), m_DeltaTime(0), m_Paused(true)
+{}
 
 void Timer::Start()
 {
-  m_StartTime = (deltaTime_t)glfwGetTime();
-  m_PrevTime = (deltaTime_t)m_StartTime;
+  m_StartTime = GetTimeNs();
+  m_PrevTime = m_CurrTime = m_StartTime;
 
   m_Paused = false;
 }
@@ -20,7 +23,7 @@ void Timer::Pause() { m_Paused = true; }
 
 void Timer::Resume()
 {
-  m_PrevTime = (deltaTime_t)glfwGetTime();
+  m_PrevTime = GetTimeNs();
 
   m_Paused = false;
 }
@@ -31,13 +34,19 @@ deltaTime_t Timer::Tick()
   {
     return (m_DeltaTime = 0.0);
   }
-  m_CurrTime = (deltaTime_t)glfwGetTime();
-  m_DeltaTime = m_CurrTime - m_PrevTime;
+  m_CurrTime = GetTimeNs();
+  m_DeltaTime = std::min(deltaTime_t((m_CurrTime - m_PrevTime) * 1e-9), MAX_DELTA_TIME);
   m_PrevTime = m_CurrTime;
 
   return m_DeltaTime;
 }
 
-deltaTime_t Timer::GetTotalTime() { return (m_CurrTime - m_StartTime); }
+deltaTime_t Timer::GetTotalTime() { return deltaTime_t((m_CurrTime - m_StartTime) * 1e-9); }
+
+int64_t Timer::GetTimeNs()
+{
+  using namespace std::chrono;
+  return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
 
 }  // namespace tetrad
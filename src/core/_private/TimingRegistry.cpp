@@ -0,0 +1,68 @@
+#include "core/TimingRegistry.h"
+
+#include <fstream>
+
+#include "core/Log.h"
+
+namespace tetrad {
+
+TimingRegistry::TimingRegistry(float avgAlpha) : m_AvgAlpha(avgAlpha) {}
+
+void TimingRegistry::Record(const std::string &name, float ms)
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  auto it = m_Indices.find(name);
+  if (it == m_Indices.end())
+  {
+    m_Indices[name] = m_Timings.size();
+    m_Timings.push_back({name, ms, ms, 1});
+    return;
+  }
+
+  Timing &timing = m_Timings[it->second];
+  timing.lastMs = ms;
+  timing.avgMs = (m_AvgAlpha * ms) + ((1 - m_AvgAlpha) * timing.avgMs);
+  ++timing.sampleCount;
+}
+
+bool TimingRegistry::Find(const std::string &name, Timing &timing) const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  auto it = m_Indices.find(name);
+  if (it == m_Indices.end())
+  {
+    return false;
+  }
+
+  timing = m_Timings[it->second];
+  return true;
+}
+
+std::vector<TimingRegistry::Timing> TimingRegistry::GetTimings() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_Timings;
+}
+
+bool TimingRegistry::DumpCsv(const std::string &path) const
+{
+  std::vector<Timing> timings = GetTimings();
+
+  std::ofstream csvFile(path, std::ios::out | std::ios::trunc);
+  if (!csvFile)
+  {
+    LOG_ERROR("Failed to open " << path << " to dump timings\n");
+    return false;
+  }
+
+  csvFile << "name,last_ms,avg_ms,samples\n";
+  for (const Timing &timing : timings)
+  {
+    csvFile << '"' << timing.name << "\"," << timing.lastMs << ',' << timing.avgMs << ','
+            << timing.sampleCount << '\n';
+  }
+
+  return bool(csvFile);
+}
+
+}  // namespace tetrad
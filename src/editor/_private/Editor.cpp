@@ -87,13 +87,13 @@ void Editor::OnInitialized()
   ObserverComponent *pObserver = m_CameraEntity.Add<ObserverComponent>();
   pObserver->Subscribe(*m_pInputSystem);
   pObserver->AddEvent(EGameEvent(EGE_PLAYER1_LEFT),
-                      new Action_Move(m_CameraEntity, Action_Move::EMD_LEFT));
+                      Action_Move(m_CameraEntity, Action_Move::EMD_LEFT));
   pObserver->AddEvent(EGameEvent(EGE_PLAYER1_RIGHT),
-                      new Action_Move(m_CameraEntity, Action_Move::EMD_RIGHT));
+                      Action_Move(m_CameraEntity, Action_Move::EMD_RIGHT));
   pObserver->AddEvent(EGameEvent(EGE_PLAYER1_FORWARDS),
-                      new Action_Move(m_CameraEntity, Action_Move::EMD_FORWARDS));
+                      Action_Move(m_CameraEntity, Action_Move::EMD_FORWARDS));
   pObserver->AddEvent(EGameEvent(EGE_PLAYER1_BACKWARDS),
-                      new Action_Move(m_CameraEntity, Action_Move::EMD_BACKWARDS));
+                      Action_Move(m_CameraEntity, Action_Move::EMD_BACKWARDS));
 
   // Create viewport 1
   entity = EntityManager::CreateEntity();
@@ -188,7 +188,7 @@ void Editor::AddSystems()
   // Create the system observer
   m_pSystemObserver = EntityManager::CreateEntity().Add<ObserverComponent>();
   m_pSystemObserver->Subscribe(*m_pInputSystem);
-  m_pSystemObserver->AddEvent(EGE_PAUSE, new Action_ExitGame(&GetCurrentScreen()));
+  m_pSystemObserver->AddEvent(EGE_PAUSE, Action_ExitGame(&GetCurrentScreen()));
 }
 
 }  // namespace tetrad
@@ -14,9 +14,11 @@ int main()
   LOG_DEBUG("Platform-specific editor initialization successful\n");
 
   Editor editor;
-  GameAttributes attributes(ScreenAttributes(1280, 960, false, true, false, 4, 4, 4,
+  GameAttributes attributes(ScreenAttributes(1280, 960, false, true, false, 4,
                                              "Tetrad Editor " + kVersionString),
                             MouseMode::NORMAL);
+  // The editor's UI rarely changes, so it's drawn from a cached layer
+  attributes.m_RetainUi = true;
   if (!editor.Initialize(attributes))
   {
     return -1;
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "engine/ecs/EntityManager.h"
+
+namespace tetrad {
+
+/** @brief Cached pointer to a component of an entity.
+ *
+ * Looks the component up through the EntityManager on first use, and keeps
+ * the pointer until Refresh is called. Whatever holds the reference must call
+ * Refresh whenever the entity's components may have changed, which is exactly
+ * when the entity's components get refreshed.
+ *
+ * @note Only refer to components of the entity whose Refresh calls reach the
+ * reference (for actions, the entity of the ObserverComponent holding them).
+ * Components of other entities can go away without it being told.
+ */
+template <class T>
+class ComponentRef
+{
+ public:
+  ComponentRef(Entity entity) : m_Entity(entity), m_pComponent(nullptr) {}
+
+  /** @return The component, or nullptr if the entity doesn't have one. */
+  T *Get()
+  {
+    if (!m_pComponent)
+    {
+      T *pComponent = EntityManager::GetComponent<T>(m_Entity);
+      m_pComponent = pComponent->GetID() != 0 ? pComponent : nullptr;
+    }
+    return m_pComponent;
+  }
+
+  /** @brief Drop the cached pointer, looking the component up again next time. */
+  void Refresh() { m_pComponent = nullptr; }
+
+  Entity GetEntity() const { return m_Entity; }
+
+ private:
+  Entity m_Entity;
+  T *m_pComponent;
+};
+
+}  // namespace tetrad
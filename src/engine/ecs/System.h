@@ -25,6 +25,14 @@ class System
   /** @brief Execute system functionality for this game tick. */
   virtual void Tick(deltaTime_t dt) = 0;
 
+  /** @brief Whether the system simulates the game state.
+   *
+   * Simulation systems are ticked at a fixed rate (possibly several times, or
+   * not at all, in a frame), so that their results don't depend on frame rate.
+   * Other systems are ticked once per frame.
+   */
+  virtual bool IsFixedStep() const { return false; }
+
  protected:
   virtual bool OnInitialize() { return true; }
   virtual void OnShutdown() {}
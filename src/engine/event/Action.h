@@ -0,0 +1,188 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "engine/event/Constants.h"
+
+namespace tetrad {
+
+/** @brief A reaction to a game event.
+ *
+ * An action is the method used to react to game events, whether those
+ * events are generated internally (e.g. achievements) or externally
+ * (e.g. user input). Actions are linked to Events by the ObserverComponent.
+ * @see ObserverComponent
+ *
+ * Holds any callable taking an EEventAction and returning a bool (a functor
+ * class, or a lambda). Callables of up to kBufferSize bytes are stored inside
+ * the Action itself, so they are never heap allocated and calling one is a
+ * single indirect call. Bigger ones are heap allocated instead.
+ *
+ * If the callable has a void Refresh() method, it is called whenever the
+ * observer holding the action is refreshed. Like in components, that is where
+ * cached component pointers (such as in a ComponentRef) must be dropped. This
+ * lets actions keep pointers to the components they use, making them cheap
+ * enough to react to frequent events.
+ */
+class Action
+{
+ public:
+  static constexpr size_t kBufferSize = 40;
+
+  Action() : m_pOps(nullptr) {}
+
+  template <typename F, typename Callable = typename std::decay<F>::type,
+            typename = typename std::enable_if<
+                !std::is_same<Callable, Action>::value>::type>
+  Action(F &&callable) : m_pOps(&OpsFor<Callable>::kOps)
+  {
+    OpsFor<Callable>::Construct(m_Storage, std::forward<F>(callable));
+  }
+
+  Action(Action &&other) : m_pOps(other.m_pOps)
+  {
+    if (m_pOps)
+    {
+      m_pOps->move(m_Storage, other.m_Storage);
+      other.m_pOps = nullptr;
+    }
+  }
+
+  Action &operator=(Action &&other)
+  {
+    if (this != &other)
+    {
+      Reset();
+      m_pOps = other.m_pOps;
+      if (m_pOps)
+      {
+        m_pOps->move(m_Storage, other.m_Storage);
+        other.m_pOps = nullptr;
+      }
+    }
+    return *this;
+  }
+
+  Action(const Action &) = delete;
+  Action &operator=(const Action &) = delete;
+
+  ~Action() { Reset(); }
+
+  explicit operator bool() const { return m_pOps != nullptr; }
+
+  /** @brief Run the action.
+   *
+   * @note The action mustn't be empty.
+   */
+  inline bool operator()(EEventAction action)
+  {
+    return m_pOps->invoke(m_Storage, action);
+  }
+
+  /** @brief Drop any cached component pointers. */
+  inline void Refresh()
+  {
+    if (m_pOps)
+    {
+      m_pOps->refresh(m_Storage);
+    }
+  }
+
+  /** @brief Destroy the callable, leaving the action empty. */
+  void Reset()
+  {
+    if (m_pOps)
+    {
+      m_pOps->destroy(m_Storage);
+      m_pOps = nullptr;
+    }
+  }
+
+ private:
+  struct Ops
+  {
+    bool (*invoke)(void *, EEventAction);
+    void (*refresh)(void *);
+    void (*move)(void *, void *);  // Into uninitialized storage, destroying the source
+    void (*destroy)(void *);
+  };
+
+  template <typename F>
+  static auto RefreshCallable(F &callable, int) -> decltype(callable.Refresh(), void())
+  {
+    callable.Refresh();
+  }
+  template <typename F>
+  static void RefreshCallable(F &, long)
+  {}
+
+  template <typename F, bool IsInline = (sizeof(F) <= kBufferSize &&
+                                        alignof(F) <= alignof(std::max_align_t) &&
+                                        std::is_nothrow_move_constructible<F>::value)>
+  struct OpsFor;
+
+  /** @brief Callables stored in m_Storage. */
+  template <typename F>
+  struct OpsFor<F, true>
+  {
+    template <typename G>
+    static void Construct(void *pStorage, G &&callable)
+    {
+      new (pStorage) F(std::forward<G>(callable));
+    }
+    static F &Get(void *pStorage) { return *static_cast<F *>(pStorage); }
+
+    static bool Invoke(void *pStorage, EEventAction action)
+    {
+      return Get(pStorage)(action);
+    }
+    static void Refresh(void *pStorage) { RefreshCallable(Get(pStorage), 0); }
+    static void Move(void *pDest, void *pSource)
+    {
+      new (pDest) F(std::move(Get(pSource)));
+      Get(pSource).~F();
+    }
+    static void Destroy(void *pStorage) { Get(pStorage).~F(); }
+
+    static constexpr Ops kOps = {&Invoke, &Refresh, &Move, &Destroy};
+  };
+
+  /** @brief Callables too big for m_Storage, which holds a pointer to them instead. */
+  template <typename F>
+  struct OpsFor<F, false>
+  {
+    template <typename G>
+    static void Construct(void *pStorage, G &&callable)
+    {
+      new (pStorage) F *(new F(std::forward<G>(callable)));
+    }
+    static F &Get(void *pStorage) { return **static_cast<F **>(pStorage); }
+
+    static bool Invoke(void *pStorage, EEventAction action)
+    {
+      return Get(pStorage)(action);
+    }
+    static void Refresh(void *pStorage) { RefreshCallable(Get(pStorage), 0); }
+    static void Move(void *pDest, void *pSource)
+    {
+      new (pDest) F *(*static_cast<F **>(pSource));
+    }
+    static void Destroy(void *pStorage) { delete *static_cast<F **>(pStorage); }
+
+    static constexpr Ops kOps = {&Invoke, &Refresh, &Move, &Destroy};
+  };
+
+ private:
+  alignas(std::max_align_t) unsigned char m_Storage[kBufferSize];
+  const Ops *m_pOps;
+};
+
+template <typename F>
+constexpr Action::Ops Action::OpsFor<F, true>::kOps;
+template <typename F>
+constexpr Action::Ops Action::OpsFor<F, false>::kOps;
+
+}  // namespace tetrad
@@ -1,39 +1,106 @@
 #pragma once
 
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
+#include <vector>
 
 #include "engine/event/Event.h"
 
 namespace tetrad {
 
+/** @brief What an EventQueue does with events pushed while it is full. */
+enum class EQueueOverflow : uint8_t
+{
+  DROP_NEWEST,  // Drop the event being pushed
+  DROP_OLDEST,  // Drop the oldest event in the queue to make room
+};
+
 /** @brief Queue filled by callback functions and consumed.
  * by the InputSystem.
  *
- * Implemented as a circular buffer, where behavior when the
- * buffer is full is determined by the EOverflowBehavior value
- * passed to the constructor.
+ * A bounded lock-free queue: any number of threads may push events at once,
+ * while a single thread consumes them. Implemented as a ring of slots, each
+ * with a sequence number saying whether it is ready to be written or read,
+ * so producers only contend on a single atomic counter.
+ *
+ * Behavior when the ring is full is determined by the EQueueOverflow policy.
+ * Every dropped event is counted, along with the most events the queue has
+ * held at once, so the capacity can be sized from real data.
  */
 class EventQueue
 {
  public:
-  EventQueue();
+  static constexpr size_t kDefaultCapacity = 256;
+
+  struct Stats
+  {
+    uint64_t pushedCount;   // Events that made it into the queue
+    uint64_t droppedCount;  // Events lost to overflow, either pushed or replaced
+    size_t peakSize;        // Most events held at once
+  };
+
+  EventQueue(size_t capacity = kDefaultCapacity,
+             EQueueOverflow overflow = EQueueOverflow::DROP_NEWEST);
+
+  /** @brief Remove the next event from the queue.
+   *
+   * @note Only one thread may consume at a time.
+   *
+   * @return false if the queue was empty.
+   */
+  bool Consume(Event& event);
 
-  // Removes the next Event from the queue and returns a pointer
-  // to it. Returns a "null" Event otherwise (event.event == EGE_None).
-  Event& Consume();
+  /** @brief Add an event to the queue. Safe to call from any thread.
+   *
+   * @return false if the event was dropped because the queue was full.
+   */
   bool PushEvent(const Event& event);
 
+  /** @brief Reallocate the queue, dropping any events in it.
+   *
+   * @note Not thread-safe: nothing may push or consume during the call.
+   *
+   * @param capacity - rounded up to a power of two
+   */
+  void SetCapacity(size_t capacity);
+  inline size_t GetCapacity() const { return m_Mask + 1; }
+
+  inline void SetOverflow(EQueueOverflow overflow) { m_Overflow.store(overflow); }
+  inline EQueueOverflow GetOverflow() const { return m_Overflow.load(); }
+
+  Stats GetStats() const;
+  void ResetStats();
+
  private:
   EventQueue(const EventQueue& queue);
   EventQueue& operator=(const EventQueue& queue);
 
+  /** @brief Pop the oldest event. Safe to race with consumers. */
+  bool Pop(Event& event);
+
  private:
-  // Ring size (how many spaces the buffer has)
-  static const size_t N = 10;  // @TODO - determine a suitable size here
-  Event m_Events[N + 1];
+  static constexpr size_t kCacheLineSize = 64;
+
+  struct Slot
+  {
+    // pos when the slot is free to write the event at pos, or pos + 1 when
+    // that event is ready to be read.
+    std::atomic<size_t> sequence;
+    Event event;
+  };
+
+  std::vector<Slot> m_Slots;
+  size_t m_Mask;
+
+  // Producers and the consumer each get their own cache line.
+  alignas(kCacheLineSize) std::atomic<size_t> m_WritePos;
+  alignas(kCacheLineSize) std::atomic<size_t> m_ReadPos;
 
-  size_t m_ReadIndex;
-  size_t m_WriteIndex;
+  alignas(kCacheLineSize) std::atomic<EQueueOverflow> m_Overflow;
+  std::atomic<uint64_t> m_PushedCount;
+  std::atomic<uint64_t> m_DroppedCount;
+  std::atomic<size_t> m_PeakSize;
 };
 
 }  // namespace tetrad
@@ -3,6 +3,7 @@
 #include <vector>
 
 #include "engine/ecs/System.h"
+#include "engine/event/Constants.h"
 #include "engine/event/EventQueue.h"
 
 namespace tetrad {
@@ -12,12 +13,13 @@ class ObserverComponent;
 /** @brief Takes input from SFML, "converts" it to events, and sends.
  * the events out to ObserverComponents.
  *
- * Multiple systems can be created to handle different types of events (since
- * registered Observers will get every event from an EventSystem, regardless of
- * their relevance).
+ * Multiple systems can be created to handle different types of events.
  *
  * ObserverComponents will register themselves with this system, and will
  * then be able to react to game events until unregistering themselves.
+ * The system keeps a list of subscribers per game event, made up of the
+ * registered observers that have an action for it, so an event is only ever
+ * delivered to observers that care about it.
  *
  * @note Unlike other systems, the EventSystem handles the registering of
  * the ObserverComponent itself rather than using a ComponentManager. The reason
@@ -30,6 +32,8 @@ class ObserverComponent;
 class EventSystem : public System
 {
  public:
+  EventSystem();
+
   void Tick(deltaTime_t dt) override;
 
   /** @brief Designate this EventSystem as the one to handle input.
@@ -44,9 +48,19 @@ class EventSystem : public System
    */
   void UnmakeInputSystem();
 
-  /** @brief Inform all registered observers of an event. */
+  /** @brief Inform all registered observers of an event, on the next Tick.
+   *
+   * Safe to call from any thread.
+   */
   void Inform(const Event& event);
 
+  /** @brief The queue events wait in until the next Tick.
+   *
+   * Can be used to change its capacity and overflow policy, and to see how
+   * many events it has dropped.
+   */
+  inline EventQueue& GetEventQueue() { return m_EventQueue; }
+
   static void SetMouseSensitivity(double);
   inline static double GetMouseSensitivity() { return s_MouseSensitivity; }
 
@@ -57,20 +71,29 @@ class EventSystem : public System
 
   /** @brief Registers an observer with the system. Returs true if there was no error.
    *
-   * @note Observers will be added multiple times if multiple calls to this
-   * function is made with the same observer! Debug builds will check for this
-   * and log a warning, but release builds will not perform any such checks.
+   * @note Registering an observer that is already registered logs a warning
+   * and returns false.
    */
   bool RegisterObserver(ObserverComponent& observer);
 
   /** @brief Unregisters an observer with the system.
    *
-   * @note Only removes the first instance of observer found in the system.
-   * If the observer has been registered multiple times, the observer won't be
-   * completely unregistered.
+   * Takes time proportional to the number of events the observer has actions
+   * for, not to the number of observers.
    */
   void UnregisterObserver(ObserverComponent& observer);
 
+  /** @brief Add a registered observer to the subscribers of an event. */
+  void AddSubscriber(ObserverComponent& observer, EGameEvent event);
+  /** @brief Remove the subscriber in a slot, moving the last one into it.
+   *
+   * While the event is being delivered, the slot is only cleared instead, so
+   * that no other subscriber changes places and misses it.
+   */
+  void RemoveSubscriber(EGameEvent event, uint32_t slot);
+  /** @brief Drop the slots cleared while delivering an event, keeping the order. */
+  void CompactSubscribers(EGameEvent event);
+
   // Overrides from System.
   void OnShutdown() override;
 
@@ -81,6 +104,10 @@ class EventSystem : public System
 
   EventQueue m_EventQueue;
   std::vector<ObserverComponent*> m_pObservers;
+  std::vector<ObserverComponent*> m_pSubscribers[EGE_END];
+
+  EGameEvent m_DeliveredEvent;  // Event being delivered, or EGE_END
+  bool m_HasClearedSlots;       // Subscribers of it were removed meanwhile
 
   static double s_MouseSensitivity;
 };
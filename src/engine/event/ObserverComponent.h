@@ -4,8 +4,8 @@
 
 #include "core/Reflection.h"
 #include "engine/ecs/IComponent.h"
+#include "engine/event/Action.h"
 #include "engine/event/Event.h"
-#include "engine/event/IAction.h"
 
 namespace tetrad {
 
@@ -17,12 +17,11 @@ class EventSystem;
  * Maps Events to Actions (one action per event)
  * such that entities can respond to events sent out by the EventSystem.
  *
- * @note The current implementation only allows an ObserverComponent one
- * EventSystem to observe. This could easily be changed later, but take note
- * that this is the case for now.
+ * An ObserverComponent can subscribe to any number of EventSystems, each of
+ * which only delivers the events it has an action for.
  *
- * @note The same action may be used for multiple Events in a single
- * ObserverComponent, but may not be used between multiple ObserverComponents.
+ * Actions are stored in the component itself, and are refreshed along with
+ * it, so they may cache pointers to the components of its entity.
  */
 COMPONENT()
 class ObserverComponent : public IComponent
@@ -31,38 +30,58 @@ class ObserverComponent : public IComponent
   ObserverComponent(Entity entity);
   ~ObserverComponent();
 
-  void Refresh() override {}
+  /** @brief Refresh every action. */
+  void Refresh() override;
 
   bool Subscribe(EventSystem& pSystem);
   void Unsubscribe(EventSystem& pSystem);
 
   /** @brief Map an Action to a specified Event.
+   *
+   * Subscribes the observer to the event in every EventSystem it is
+   * subscribed to.
    *
    * @note If the event already exists, the function returns false and
    * doesn't change anything.
    */
-  bool AddEvent(const EGameEvent& event, IAction* pAction);
+  bool AddEvent(const EGameEvent& event, Action action);
 
   /** @brief Map a new Action to an already-mapped Event.
    *
    * @note If the event doesn't already have something mapped to it, this
    * method will return false and not change anything.
    */
-  bool UpdateEvent(const EGameEvent& event, IAction* pAction);
+  bool UpdateEvent(const EGameEvent& event, Action action);
 
-  /** @brief Notifies the relevant Action class that the specified event occurred.
+  /** @brief Notifies the relevant Action that the specified event occurred.
    *
    * @note As it stands, the code does not inform the Action of which
-   * entity called it. If that were to change, IAction would have to
+   * entity called it. If that were to change, Action would have to
    * change, as would this method.
    */
   void Notify(const Event& event);
 
  private:
-  // Array of IAction pointers, used to map Events to Actions.
+  friend class EventSystem;
+
+  static constexpr uint32_t kNoSlot = ~0u;
+
+  /** @brief Where the observer is in an EventSystem's subscriber lists. */
+  struct Subscription
+  {
+    EventSystem* pSystem;
+    uint32_t observerSlot;    // In the system's list of every registered observer
+    uint32_t slots[EGE_END];  // kNoSlot for events without an action
+  };
+
+  /** @return The subscription to pSystem, or nullptr if there is none. */
+  Subscription* FindSubscription(const EventSystem& system);
+
+ private:
+  // Array of Actions, used to map Events to Actions.
   // @note This is only acceptable if the number of game events is quite low.
-  IAction* m_pAction[EGE_END];
-  std::vector<EventSystem*> m_pEventSystems;
+  Action m_Actions[EGE_END];
+  std::vector<Subscription> m_Subscriptions;
 };
 
 }  // namespace tetrad
@@ -1,77 +1,144 @@
 #include "engine/event/EventQueue.h"
 
+#include "core/Log.h"
 #include "engine/event/Constants.h"
 
 namespace tetrad {
 
-//
-// One of these 3 should be uncommented in order to define the EventQueue's
-// overflow behavior. By default (i.e. if none of these are defined), the
-// OVERFLOW_IGNORE behavior--which is to ignore the event trying to be pushed
-// onto the queue--will be chosen.
-//
-//#define OVERFLOW_REPLACE_OLDEST
-//#define OVERFLOW_REPLACE_YOUNGEST
-#define OVERFLOW_IGNORE
-//
-
-EventQueue::EventQueue() : m_ReadIndex(1), m_WriteIndex(1)
+EventQueue::EventQueue(size_t capacity, EQueueOverflow overflow)
+    : m_Mask(0),
+      m_WritePos(0),
+      m_ReadPos(0),
+      m_Overflow(overflow),
+      m_PushedCount(0),
+      m_DroppedCount(0),
+      m_PeakSize(0)
 {
-  m_Events[0].event = EGE_END;
+  SetCapacity(capacity);
 }
 
-Event& EventQueue::Consume()
-{
-  // If done reading, index = 0, else index = m_ReadIndex
-  bool read = (m_ReadIndex - m_WriteIndex != 0);
-  size_t index = m_ReadIndex - m_ReadIndex * (!read);
+bool EventQueue::Consume(Event& event) { return Pop(event); }
 
-  // If we read, increment m_ReadIndex
-  m_ReadIndex += read;
-  // Make sure m_ReadIndex is between 1 and N+1
-  m_ReadIndex -= (m_ReadIndex / (N + 1)) * N;
+bool EventQueue::PushEvent(const Event& event)
+{
+  size_t pos = m_WritePos.load(std::memory_order_relaxed);
+  Slot* pSlot;
+  while (true)
+  {
+    pSlot = &m_Slots[pos & m_Mask];
+    const size_t sequence = pSlot->sequence.load(std::memory_order_acquire);
+    const intptr_t diff = intptr_t(sequence) - intptr_t(pos);
+    if (diff == 0)
+    {
+      // The slot is free, so claim it (unless another producer beat us to it).
+      if (m_WritePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+      {
+        break;
+      }
+    }
+    else if (diff < 0)
+    {
+      // The slot still holds an event from a lap ago: the queue is full.
+      m_DroppedCount.fetch_add(1, std::memory_order_relaxed);
+      if (m_Overflow.load(std::memory_order_relaxed) == EQueueOverflow::DROP_NEWEST)
+      {
+        return false;
+      }
+
+      // Popping is safe to race with the consumer. If it races and loses,
+      // the queue is no longer full anyway.
+      Event dropped;
+      if (!Pop(dropped))
+      {
+        m_DroppedCount.fetch_sub(1, std::memory_order_relaxed);
+      }
+      pos = m_WritePos.load(std::memory_order_relaxed);
+    }
+    else
+    {
+      pos = m_WritePos.load(std::memory_order_relaxed);
+    }
+  }
 
-  // Because write index will be > N+1 if we push N elements
-  m_WriteIndex -= (m_WriteIndex / (N + 1)) * N;
+  pSlot->event = event;
+  pSlot->sequence.store(pos + 1, std::memory_order_release);
 
-  return m_Events[index];
+  m_PushedCount.fetch_add(1, std::memory_order_relaxed);
+  const size_t size = pos + 1 - m_ReadPos.load(std::memory_order_relaxed);
+  size_t peakSize = m_PeakSize.load(std::memory_order_relaxed);
+  while (size > peakSize && size <= GetCapacity() &&
+         !m_PeakSize.compare_exchange_weak(peakSize, size, std::memory_order_relaxed))
+  {
+  }
+  return true;
 }
 
-bool EventQueue::PushEvent(const Event& event)
+bool EventQueue::Pop(Event& event)
 {
-  // Overflow behavior
-  if (m_WriteIndex > N)
+  size_t pos = m_ReadPos.load(std::memory_order_relaxed);
+  Slot* pSlot;
+  while (true)
   {
-#if defined(OVERFLOW_REPLACE_OLDEST)
-    // "de-elevate" write index
-    m_WriteIndex -= N;
-
-    // Push read index forward (as we will over-write the oldest element)
-    ++m_ReadIndex;
-    m_ReadIndex -= (m_ReadIndex / (N + 1)) * N;
-#elif defined(OVERFLOW_REPLACE_YOUNGEST)
-    m_WriteIndex -= N + 1;
-
-    // If write index is 0, move to N
-    m_WriteIndex = (!!m_WriteIndex) * m_WriteIndex + (!m_WriteIndex) * N;
-#else  // OVERFLOW_IGNORE
-    return false;
-#endif
+    pSlot = &m_Slots[pos & m_Mask];
+    const size_t sequence = pSlot->sequence.load(std::memory_order_acquire);
+    const intptr_t diff = intptr_t(sequence) - intptr_t(pos + 1);
+    if (diff == 0)
+    {
+      if (m_ReadPos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+      {
+        break;
+      }
+    }
+    else if (diff < 0)
+    {
+      return false;  // Empty, or the next event is still being written
+    }
+    else
+    {
+      pos = m_ReadPos.load(std::memory_order_relaxed);
+    }
   }
 
-  // Calculate next write index
-  size_t nextIndex = m_WriteIndex + 1;
-  nextIndex -= (nextIndex / (N + 1)) * N;
+  event = pSlot->event;
+  // Free the slot for the write a lap from now.
+  pSlot->sequence.store(pos + m_Mask + 1, std::memory_order_release);
+  return true;
+}
 
-  // Push element here
-  m_Events[m_WriteIndex] = event;
+void EventQueue::SetCapacity(size_t capacity)
+{
+  size_t roundedCapacity = 2;
+  while (roundedCapacity < capacity)
+  {
+    roundedCapacity *= 2;
+  }
+  if (roundedCapacity != capacity)
+  {
+    LOG_DEBUG("Rounding the EventQueue capacity up to " << roundedCapacity << "\n");
+  }
 
-  bool last = (nextIndex == m_ReadIndex);
+  std::vector<Slot>(roundedCapacity).swap(m_Slots);
+  for (size_t i = 0; i < roundedCapacity; ++i)
+  {
+    m_Slots[i].sequence.store(i, std::memory_order_relaxed);
+  }
+  m_Mask = roundedCapacity - 1;
+  m_WritePos.store(0, std::memory_order_relaxed);
+  m_ReadPos.store(0, std::memory_order_relaxed);
+}
 
-  // "Elevate" the write index if we're pushing to the last element in the queue
-  m_WriteIndex = nextIndex + last * N;
+EventQueue::Stats EventQueue::GetStats() const
+{
+  return {m_PushedCount.load(std::memory_order_relaxed),
+          m_DroppedCount.load(std::memory_order_relaxed),
+          m_PeakSize.load(std::memory_order_relaxed)};
+}
 
-  return true;
+void EventQueue::ResetStats()
+{
+  m_PushedCount.store(0, std::memory_order_relaxed);
+  m_DroppedCount.store(0, std::memory_order_relaxed);
+  m_PeakSize.store(0, std::memory_order_relaxed);
 }
 
 }  // namespace tetrad
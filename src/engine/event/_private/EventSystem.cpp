@@ -10,6 +10,8 @@ namespace tetrad {
 EventSystem* EventSystem::s_pInputSystem = nullptr;
 double EventSystem::s_MouseSensitivity = 1.0;
 
+EventSystem::EventSystem() : m_DeliveredEvent(EGE_END), m_HasClearedSlots(false) {}
+
 void EventSystem::Tick(deltaTime_t dt)
 {
   (void)dt;
@@ -17,14 +19,34 @@ void EventSystem::Tick(deltaTime_t dt)
   // Get events and such
   glfwPollEvents();
 
-  Event event = m_EventQueue.Consume();
-  while (event.event != EGE_END)
+  // Events pushed by other threads while draining are handled too.
+  Event event;
+  while (m_EventQueue.Consume(event))
   {
-    for (size_t i = 0; i < m_pObservers.size(); ++i)
+    if (event.event >= EGE_END)
+    {
+      continue;
+    }
+
+    // Actions may (un)subscribe observers. Those subscribed now wait for the
+    // next event, and those unsubscribed leave a cleared slot behind, so that
+    // every other subscriber still gets this one.
+    const std::vector<ObserverComponent*>& pSubscribers = m_pSubscribers[event.event];
+    const size_t subscriberCount = pSubscribers.size();
+    m_DeliveredEvent = event.event;
+    for (size_t i = 0; i < subscriberCount; ++i)
+    {
+      if (pSubscribers[i])
+      {
+        pSubscribers[i]->Notify(event);
+      }
+    }
+    m_DeliveredEvent = EGE_END;
+
+    if (m_HasClearedSlots)
     {
-      m_pObservers[i]->Notify(event);
+      CompactSubscribers(event.event);
     }
-    event = m_EventQueue.Consume();
   }
 }
 
@@ -50,37 +72,111 @@ void EventSystem::UnmakeInputSystem()
 
 bool EventSystem::RegisterObserver(ObserverComponent& observer)
 {
-// In debug mode, check to see if we're adding an observer multiple times
-#ifdef _DEBUG
-  for (size_t i = 0; i < m_pObservers.size(); ++i)
+  if (observer.FindSubscription(*this))
   {
-    if (m_pObservers[i] == &observer)
-    {
-      LOG_SPECIAL(
-          "WARNING",
-          "The observer at memory location: "
-              << &observer
-              << " is being registered multiple times to the same EventSystem!\n");
-    }
+    LOG_SPECIAL("WARNING",
+                "The observer at memory location: "
+                    << &observer
+                    << " is being registered multiple times to the same EventSystem!\n");
+    return false;
   }
-#endif
 
+  ObserverComponent::Subscription subscription;
+  subscription.pSystem = this;
+  subscription.observerSlot = static_cast<uint32_t>(m_pObservers.size());
+  for (size_t i = 0; i < EGE_END; ++i)
+  {
+    subscription.slots[i] = ObserverComponent::kNoSlot;
+  }
+  observer.m_Subscriptions.push_back(subscription);
   m_pObservers.push_back(&observer);
 
+  for (size_t i = 0; i < EGE_END; ++i)
+  {
+    if (observer.m_Actions[i])
+    {
+      AddSubscriber(observer, EGameEvent(i));
+    }
+  }
+
   return true;
 }
 
 void EventSystem::UnregisterObserver(ObserverComponent& observer)
 {
-  for (size_t i = 0; i < m_pObservers.size(); ++i)
+  ObserverComponent::Subscription* pSubscription = observer.FindSubscription(*this);
+  if (!pSubscription)
   {
-    if (m_pObservers[i] == &observer)
+    return;
+  }
+
+  for (size_t i = 0; i < EGE_END; ++i)
+  {
+    if (pSubscription->slots[i] != ObserverComponent::kNoSlot)
     {
-      std::swap(m_pObservers[i], m_pObservers.back());
-      m_pObservers.pop_back();
-      return;
+      RemoveSubscriber(EGameEvent(i), pSubscription->slots[i]);
     }
   }
+
+  const uint32_t observerSlot = pSubscription->observerSlot;
+  if (observerSlot + 1 != m_pObservers.size())
+  {
+    m_pObservers[observerSlot] = m_pObservers.back();
+    m_pObservers[observerSlot]->FindSubscription(*this)->observerSlot = observerSlot;
+  }
+  m_pObservers.pop_back();
+
+  std::swap(*pSubscription, observer.m_Subscriptions.back());
+  observer.m_Subscriptions.pop_back();
+}
+
+void EventSystem::AddSubscriber(ObserverComponent& observer, EGameEvent event)
+{
+  ObserverComponent::Subscription* pSubscription = observer.FindSubscription(*this);
+  if (!pSubscription || pSubscription->slots[event] != ObserverComponent::kNoSlot)
+  {
+    return;
+  }
+
+  pSubscription->slots[event] = static_cast<uint32_t>(m_pSubscribers[event].size());
+  m_pSubscribers[event].push_back(&observer);
+}
+
+void EventSystem::RemoveSubscriber(EGameEvent event, uint32_t slot)
+{
+  std::vector<ObserverComponent*>& pSubscribers = m_pSubscribers[event];
+  pSubscribers[slot]->FindSubscription(*this)->slots[event] = ObserverComponent::kNoSlot;
+
+  if (event == m_DeliveredEvent)
+  {
+    pSubscribers[slot] = nullptr;
+    m_HasClearedSlots = true;
+    return;
+  }
+
+  if (slot + 1 != pSubscribers.size())
+  {
+    pSubscribers[slot] = pSubscribers.back();
+    pSubscribers[slot]->FindSubscription(*this)->slots[event] = slot;
+  }
+  pSubscribers.pop_back();
+}
+
+void EventSystem::CompactSubscribers(EGameEvent event)
+{
+  std::vector<ObserverComponent*>& pSubscribers = m_pSubscribers[event];
+  uint32_t count = 0;
+  for (size_t i = 0; i < pSubscribers.size(); ++i)
+  {
+    if (pSubscribers[i] && i != count)
+    {
+      pSubscribers[count] = pSubscribers[i];
+      pSubscribers[count]->FindSubscription(*this)->slots[event] = count;
+    }
+    count += pSubscribers[i] ? 1 : 0;
+  }
+  pSubscribers.resize(count);
+  m_HasClearedSlots = false;
 }
 
 void EventSystem::Inform(const Event& event)
@@ -94,8 +190,8 @@ void EventSystem::Inform(const Event& event)
   if (!success)
   {
     LOG_DEBUG(
-        "Failed to push event;"
-        "consider making the EventQueue size larger!\n");
+        "Failed to push event; "
+        "consider making the EventQueue capacity larger!\n");
   }
 #endif
 }
@@ -105,6 +201,15 @@ void EventSystem::SetMouseSensitivity(double sensitivity)
   s_MouseSensitivity = sensitivity;
 }
 
-void EventSystem::OnShutdown() { UnmakeInputSystem(); }
+void EventSystem::OnShutdown()
+{
+  UnmakeInputSystem();
+
+  // Observers may outlive the system, so make sure they forget about it
+  while (!m_pObservers.empty())
+  {
+    UnregisterObserver(*m_pObservers.back());
+  }
+}
 
 }  // namespace tetrad
@@ -1,37 +1,25 @@
 #include "engine/event/ObserverComponent.h"
 
-#include <unordered_set>
-
 #include "engine/event/EventSystem.h"
 
 namespace tetrad {
 
-ObserverComponent::ObserverComponent(Entity entity) : IComponent(entity)
+ObserverComponent::ObserverComponent(Entity entity) : IComponent(entity) {}
+
+ObserverComponent::~ObserverComponent()
 {
-  for (size_t i = 0; i < EGE_END; ++i)
+  // Unsubscribing removes the subscription
+  while (!m_Subscriptions.empty())
   {
-    m_pAction[i] = nullptr;
+    Unsubscribe(*m_Subscriptions.back().pSystem);
   }
 }
 
-ObserverComponent::~ObserverComponent()
+void ObserverComponent::Refresh()
 {
-  // Add action pointers to an unordered set and then delete
-  // Allows us to use the same pointer for multiple events
-  std::unordered_set<IAction*> pActions;
   for (size_t i = 0; i < EGE_END; ++i)
   {
-    pActions.insert(m_pAction[i]);
-  }
-
-  for (auto iter = pActions.begin(); iter != pActions.end(); ++iter)
-  {
-    delete *iter;
-  }
-
-  for (size_t i = 0; i < m_pEventSystems.size(); ++i)
-  {
-    Unsubscribe(*m_pEventSystems[i]);
+    m_Actions[i].Refresh();
   }
 }
 
@@ -45,37 +33,55 @@ void ObserverComponent::Unsubscribe(EventSystem& pSystem)
   pSystem.UnregisterObserver(*this);
 }
 
-bool ObserverComponent::AddEvent(const EGameEvent& event, IAction* pAction)
+bool ObserverComponent::AddEvent(const EGameEvent& event, Action action)
 {
-  if (m_pAction[event])
+  if (m_Actions[event])
   {
-    delete pAction;
     return false;
   }
 
-  m_pAction[event] = pAction;
+  m_Actions[event] = std::move(action);
+  if (m_Actions[event])
+  {
+    for (size_t i = 0; i < m_Subscriptions.size(); ++i)
+    {
+      m_Subscriptions[i].pSystem->AddSubscriber(*this, event);
+    }
+  }
   return true;
 }
 
-bool ObserverComponent::UpdateEvent(const EGameEvent& event, IAction* pAction)
+bool ObserverComponent::UpdateEvent(const EGameEvent& event, Action action)
 {
-  if (!m_pAction[event])
+  if (!m_Actions[event])
   {
-    delete pAction;
     return false;
   }
 
-  delete m_pAction[event];
-  m_pAction[event] = pAction;
+  m_Actions[event] = std::move(action);
   return true;
 }
 
 void ObserverComponent::Notify(const Event& event)
 {
-  if (m_pAction[event.event])
+  if (m_Actions[event.event])
+  {
+    m_Actions[event.event](event.action);
+  }
+}
+
+ObserverComponent::Subscription* ObserverComponent::FindSubscription(
+    const EventSystem& system)
+{
+  // Observers rarely subscribe to more than one or two systems
+  for (size_t i = 0; i < m_Subscriptions.size(); ++i)
   {
-    (*m_pAction[event.event])(event.action);
+    if (m_Subscriptions[i].pSystem == &system)
+    {
+      return &m_Subscriptions[i];
+    }
   }
+  return nullptr;
 }
 
 }  // namespace tetrad
@@ -1,18 +1,18 @@
 #pragma once
 
-#include "engine/event/IAction.h"
+#include "engine/event/Constants.h"
 
 namespace tetrad {
 
 class Screen;
 
 /** @brief Action to exit the game. */
-class Action_ExitGame : public IAction
+class Action_ExitGame
 {
  public:
   Action_ExitGame(Screen *pScreen);
 
-  bool operator()(EEventAction) override;
+  bool operator()(EEventAction);
 
  private:
   Screen *m_pScreen;
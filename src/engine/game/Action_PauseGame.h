@@ -1,18 +1,18 @@
 #pragma once
 
-#include "engine/event/IAction.h"
+#include "engine/event/Constants.h"
 
 namespace tetrad {
 
 class Game;
 
 /** @brief System observer action to pause the game. */
-class Action_PauseGame : public IAction
+class Action_PauseGame
 {
  public:
   Action_PauseGame(Game *pGame);
 
-  bool operator()(EEventAction) override;
+  bool operator()(EEventAction);
 
  private:
   Game *m_pGame;
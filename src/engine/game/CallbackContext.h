@@ -1,5 +1,7 @@
 #pragma once
 
+#include "engine/ecs/Entity.h"
+
 struct GLFWwindow;
 
 namespace tetrad {
@@ -17,22 +19,50 @@ class CallbackContext
   static void Cursor_GUI(GLFWwindow *, double currX, double currY);
   static void Cursor_3DCamera(GLFWwindow *, double currX, double currY);
 
+  /** @brief Rotate the viewport camera by the cursor movement since the last call.
+   *
+   * Cursor movement is coalesced and applied once per frame here. This should
+   * be called as late as possible before the camera is used for rendering, so
+   * that the rendered view reflects the latest cursor position.
+   */
+  static void LatchCameraInput();
+
   static void Keyboard_3DCamera(GLFWwindow *, int, int, int, int);
 
   static void MouseButton_Viewport(GLFWwindow *, int, int, int);
 
+  /** @brief Rotate the viewport camera, as moving the cursor does.
+   *
+   * @param xDiff, yDiff - cursor movement, normalized to the viewport size
+   * and scaled by the mouse sensitivity
+   */
+  static void RotateCamera(float xDiff, float yDiff);
+
   static void SetGame(Game *pGame);
 
   inline static UIComponent *GetCachedUI() { return s_pPrevValidUI; }
   inline static void ClearCachedUI() { s_pPrevUI = s_pPrevValidUI = nullptr; }
 
+  /** @brief The entity last clicked on in a viewport, or a null entity. */
+  inline static Entity GetSelectedEntity() { return s_SelectedEntity; }
+
+  /** @brief Find the entity drawn under a point of the window, if any.
+   *
+   * @param x, y - window coordinates, from the top-left corner
+   */
+  static Entity PickEntity(double x, double y);
+
  private:
   static Game *s_pCurrentGame;
   static double s_PrevX;
   static double s_PrevY;
+  static double s_CursorX;  // Latest cursor position seen by Cursor_3DCamera
+  static double s_CursorY;
 
   static UIComponent *s_pPrevUI;
   static UIComponent *s_pPrevValidUI;
+
+  static Entity s_SelectedEntity;
 };
 
 }  // namespace tetrad
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <string>
+
+#include "core/FrameLimiter.h"
 #include "core/GlTypes.h"
 #include "core/Timer.h"
 #include "engine/ecs/System.h"
@@ -23,6 +26,20 @@ struct GameAttributes
 
   ScreenAttributes m_MainWindowAttr;
   MouseMode m_MouseMode;
+
+  deltaTime_t m_FixedTimeStep;    // Time simulated by each fixed-step system tick
+  deltaTime_t m_TargetFrameTime;  // Frame time to hold the game loop to (0 for none)
+
+  // Keep the UI in a texture, only redrawing what changed (@see DrawSystem)
+  bool m_RetainUi;
+
+  // Input recording (@see InputRecorder). Set at most one of the first two.
+  std::string m_InputRecordPath;  // Record the session's input to this file
+  std::string m_InputReplayPath;  // Replay this file instead of taking live input
+  std::string m_FrameTimesPath;   // Dump replayed frame times to this CSV
+
+  // Dump per-pass timings (@see TimingRegistry) to this CSV on shutdown
+  std::string m_TimingsPath;
 };
 
 /** @brief Highest-level abstraction of a game.
@@ -89,6 +106,18 @@ class Game
 
   inline Screen &GetCurrentScreen() { return m_MainScreen; }
 
+  /** @brief How far rendering is between the last two simulation steps.
+   *
+   * Renderers should blend simulated state by this amount (see
+   * TransformHierarchy::Interpolate), since the simulation
+   * runs at a fixed rate that doesn't line up with frames.
+   */
+  inline float GetInterpolationAlpha() const { return m_InterpolationAlpha; }
+
+  inline deltaTime_t GetFixedTimeStep() const { return m_FixedTimeStep; }
+
+  inline bool IsUiRetained() const { return m_IsUiRetained; }
+
  protected:
   /** @brief Add a single system to the system list. */
   inline void AppendSystem(System *pSystem) { m_pSystems.push_back(pSystem); }
@@ -110,8 +139,13 @@ class Game
   /** @brief Called when the game is successfully resumed. */
   virtual void OnResume() = 0;
 
+ private:
+  /** @brief Run fixed-step systems for all the whole steps accumulated. */
+  void RunFixedSteps(deltaTime_t deltaTime);
+
  private:
   Timer m_Timer;
+  FrameLimiter m_FrameLimiter;
 
   EGameState m_CurrentState;
   EGameState m_PrevState;  // Used to restore state after pausing game.
@@ -119,9 +153,18 @@ class Game
   deltaTime_t m_DeltaAvg;    // EMWA of tick delta times.
   deltaTime_t m_DeltaAlpha;  // Alpha value for delta time EMWA calculation.
 
+  // EMWA of how far frame times are from the target frame time (or from the
+  // average frame time, without a frame limiter).
   deltaTime_t m_JitterAvg;
   deltaTime_t m_JitterAlpha;
 
+  deltaTime_t m_FixedTimeStep;
+  deltaTime_t m_Accumulator;  // Time not yet simulated by fixed-step systems
+  float m_InterpolationAlpha;
+
+  bool m_IsUiRetained;
+  std::string m_TimingsPath;
+
   Screen m_MainScreen;
 
   std::vector<System *> m_pSystems;
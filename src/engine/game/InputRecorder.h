@@ -0,0 +1,150 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "core/BaseTypes.h"
+#include "engine/event/Event.h"
+
+namespace tetrad {
+
+/** @brief Records a play session's input to a file, and plays it back.
+ *
+ * While recording, every frame's delta time and the input gathered during it
+ * (game events from the keyboard, and camera rotations from the cursor) are
+ * written to a compact binary file, along with the seed the global Random
+ * instance was given and the fixed time step.
+ *
+ * While replaying, live input is ignored. Each frame takes its delta time from
+ * the recording instead of the clock, and the recorded input is fed back in
+ * where live input would have been applied. With the same seed and the same
+ * sequence of fixed steps, the session plays out the same way every time, so
+ * it can be used to benchmark builds against each other. The wall-clock time
+ * of every replayed frame is kept, and summarized (and optionally dumped to a
+ * CSV) once the replay ends.
+ *
+ * @note The file is written in the byte order of the machine recording it.
+ */
+class InputRecorder
+{
+ public:
+  InputRecorder();
+  ~InputRecorder();
+
+  InputRecorder(const InputRecorder &) = delete;
+  InputRecorder &operator=(const InputRecorder &) = delete;
+
+  /** @brief Start recording to a file, reseeding the global Random instance.
+   *
+   * @return false if the file couldn't be opened.
+   */
+  bool StartRecording(const std::string &path, deltaTime_t fixedTimeStep);
+
+  /** @brief Start replaying a file, reseeding the global Random instance.
+   *
+   * @param frameTimesPath - CSV to dump frame times to once done, if not empty
+   *
+   * @return false if the file couldn't be read, or isn't a recording.
+   */
+  bool StartReplay(const std::string &path, const std::string &frameTimesPath = "");
+
+  /** @brief Finish recording or replaying. Does nothing if doing neither. */
+  void Stop();
+
+  /** @brief Mark the start of a frame.
+   *
+   * When recording, records deltaTime. When replaying, replaces it with the
+   * recorded one, and feeds the frame's recorded input back in.
+   *
+   * @return false once a replay has run out of frames.
+   */
+  bool BeginFrame(deltaTime_t &deltaTime);
+
+  /** @brief Record an event sent by an input callback. */
+  void RecordEvent(const Event &event);
+  /** @brief Record the camera rotation made by the cursor this frame. */
+  void RecordRotation(float xDiff, float yDiff);
+
+  /** @brief Take the camera rotation recorded for the current frame.
+   *
+   * Replayed rotations are applied through CallbackContext::LatchCameraInput,
+   * at the same point of the frame as live ones.
+   *
+   * @return false if there was none.
+   */
+  bool TakeRotation(float &xDiff, float &yDiff);
+
+  inline bool IsRecording() const { return m_Mode == EMode::RECORDING; }
+  inline bool IsReplaying() const { return m_Mode == EMode::REPLAYING; }
+
+  /** @brief The fixed time step of the recording being replayed. */
+  inline deltaTime_t GetFixedTimeStep() const { return m_FixedTimeStep; }
+
+  /** @brief Returns a static instance of InputRecorder. */
+  static InputRecorder &GetGlobalInstance()
+  {
+    static InputRecorder recorder;
+    return recorder;
+  }
+
+ private:
+  enum class EMode : uint8_t
+  {
+    OFF,
+    RECORDING,
+    REPLAYING
+  };
+
+  enum ERecordTag : uint8_t
+  {
+    ERT_FRAME,     // float deltaTime
+    ERT_EVENT,     // uint32_t timestamp, uint8_t event, action, state
+    ERT_ROTATION,  // uint32_t timestamp, float xDiff, yDiff
+  };
+
+  static constexpr uint32_t kMagic = 0x43524954;  // "TIRC"
+  static constexpr uint32_t kVersion = 2;
+  static constexpr size_t kFlushSize = 64 * 1024;
+
+  struct Header
+  {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t seed;
+    deltaTime_t fixedTimeStep;
+  };
+
+  template <typename T>
+  void Write(const T &value);
+  template <typename T>
+  bool Read(T &value);
+
+  /** @return Microseconds since recording started. */
+  uint32_t GetTimestamp() const;
+  void Flush();
+
+  void LogFrameTimes();
+
+ private:
+  EMode m_Mode;
+  deltaTime_t m_FixedTimeStep;
+  int64_t m_StartTime;
+
+  // Recording
+  std::ofstream m_File;
+  std::vector<uint8_t> m_Buffer;
+
+  // Replaying
+  std::vector<uint8_t> m_Recording;
+  size_t m_ReadPos;
+  std::string m_FrameTimesPath;
+  int64_t m_FrameStartTime;
+  std::vector<float> m_FrameTimes;  // In ms
+  bool m_HasRotation;
+  float m_XDiff;
+  float m_YDiff;
+};
+
+}  // namespace tetrad
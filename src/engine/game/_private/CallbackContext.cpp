@@ -5,7 +5,9 @@
 #include "engine/event/Constants.h"
 #include "engine/event/EventSystem.h"
 #include "engine/game/Game.h"
+#include "engine/game/InputRecorder.h"
 #include "engine/render/CameraComponent.h"
+#include "engine/render/SceneQuery.h"
 #include "engine/screen/Screen.h"
 #include "engine/transform/MovableComponent.h"
 #include "engine/transform/TransformComponent.h"
@@ -16,17 +18,25 @@ namespace tetrad {
 Game *CallbackContext::s_pCurrentGame = nullptr;
 double CallbackContext::s_PrevX = 0;
 double CallbackContext::s_PrevY = 0;
+double CallbackContext::s_CursorX = 0;
+double CallbackContext::s_CursorY = 0;
 UIComponent *CallbackContext::s_pPrevUI = nullptr;
 UIComponent *CallbackContext::s_pPrevValidUI = nullptr;
+Entity CallbackContext::s_SelectedEntity;
 
 void CallbackContext::Resize_Default(GLFWwindow *, int width, int height)
 {
-  glViewport(0, 0, width, height);
+  // The viewport itself is set by the render thread, from the screen size.
   s_pCurrentGame->GetCurrentScreen().SetSize(width, height);
 }
 
 void CallbackContext::Cursor_GUI(GLFWwindow *, double currX, double currY)
 {
+  if (InputRecorder::GetGlobalInstance().IsReplaying())
+  {
+    return;
+  }
+
   static double prevX = s_PrevX;
   static double prevY = s_PrevY;
   Screen &currentScreen = s_pCurrentGame->GetCurrentScreen();
@@ -73,12 +83,47 @@ void CallbackContext::Cursor_GUI(GLFWwindow *, double currX, double currY)
 
 void CallbackContext::Cursor_3DCamera(GLFWwindow *, double currX, double currY)
 {
+  // Only keep the latest position. The camera is rotated once a frame, in
+  // LatchCameraInput, however many times the cursor moved.
+  s_CursorX = currX;
+  s_CursorY = currY;
+}
+
+void CallbackContext::LatchCameraInput()
+{
+  InputRecorder &recorder = InputRecorder::GetGlobalInstance();
+  float xDiff, yDiff;
+  if (recorder.IsReplaying())
+  {
+    if (recorder.TakeRotation(xDiff, yDiff))
+    {
+      RotateCamera(xDiff, yDiff);
+    }
+    return;
+  }
+
+  // The cursor only controls the camera while it's disabled
+  GLFWwindow *pWindow = s_pCurrentGame->GetCurrentScreen().GetWindow();
+  if (glfwGetInputMode(pWindow, GLFW_CURSOR) != GLFW_CURSOR_DISABLED)
+  {
+    return;
+  }
+
+  // Sample the cursor again, to pick up any movement since events were polled
+  glfwGetCursorPos(pWindow, &s_CursorX, &s_CursorY);
+  if (s_CursorX == s_PrevX && s_CursorY == s_PrevY)
+  {
+    return;
+  }
+
   // TODO use current UIViewport & CallbackContext!!!
   // Get current viewport - NOTE, THIS ASSUMES ONE VIEWPORT!
   static ConstVector<UIViewport *> pViewports = EntityManager::GetAll<UIViewport>();
-  static screenBound_t screenBounds(0, 0, 0, 0);
-  screenBounds = pViewports[1]->GetScreenBounds();
-  CameraComponent *pCamera = pViewports[1]->GetCamera();
+  if (pViewports.size() < 2)
+  {
+    return;
+  }
+  screenBound_t screenBounds = pViewports[1]->GetScreenBounds();
   Screen *pScreen = pViewports[1]->GetScreen();
 
   DEBUG_ASSERT(pScreen);
@@ -86,21 +131,19 @@ void CallbackContext::Cursor_3DCamera(GLFWwindow *, double currX, double currY)
   double mouseSensitivity = EventSystem::GetMouseSensitivity();
 
   // Calculate normalized x & y diffs, then scale by sensitivity factor
-  double xDiff =
-      mouseSensitivity * (currX - s_PrevX) /
-      (pScreen->GetWidth() * (screenBounds.points[1].X - screenBounds.points[0].X));
-  double yDiff =
-      mouseSensitivity * (currY - s_PrevY) /
-      (pScreen->GetHeight() * (screenBounds.points[1].Y - screenBounds.points[0].Y));
+  xDiff = float(
+      mouseSensitivity * (s_CursorX - s_PrevX) /
+      (pScreen->GetWidth() * (screenBounds.points[1].X - screenBounds.points[0].X)));
+  yDiff = float(
+      mouseSensitivity * (s_CursorY - s_PrevY) /
+      (pScreen->GetHeight() * (screenBounds.points[1].Y - screenBounds.points[0].Y)));
 
-  // Apply appropriate rotations to camera
-  TransformDirs localDirs = pCamera->m_pTransformComp->GetLocalDirs();
-  pCamera->m_pMover->Rotate((float)-yDiff, localDirs.rightDir);
-  pCamera->m_pMover->Rotate((float)-xDiff, glm::vec3(0, 1, 0));
+  recorder.RecordRotation(xDiff, yDiff);
+  RotateCamera(xDiff, yDiff);
 
   // Store current cursor position
-  s_PrevX = currX;
-  s_PrevY = currY;
+  s_PrevX = s_CursorX;
+  s_PrevY = s_CursorY;
 }
 
 void CallbackContext::Keyboard_3DCamera(GLFWwindow *, int key, int scancode, int action,
@@ -110,6 +153,12 @@ void CallbackContext::Keyboard_3DCamera(GLFWwindow *, int key, int scancode, int
   (void)mods;
   Event event;
 
+  InputRecorder &recorder = InputRecorder::GetGlobalInstance();
+  if (recorder.IsReplaying())
+  {
+    return;
+  }
+
   DEBUG_ASSERT(EventSystem::GetInputSystem());
   DEBUG_ASSERT(s_pCurrentGame);
 
@@ -161,6 +210,7 @@ void CallbackContext::Keyboard_3DCamera(GLFWwindow *, int key, int scancode, int
     }
 
     event.state = currState;
+    recorder.RecordEvent(event);
     EventSystem::GetInputSystem()->Inform(event);
   }
 }
@@ -171,6 +221,11 @@ void CallbackContext::MouseButton_Viewport(GLFWwindow *pWindow, int button, int
   (void)mods;
   static uint32_t prevCursorMode = glfwGetInputMode(pWindow, GLFW_CURSOR);
 
+  if (InputRecorder::GetGlobalInstance().IsReplaying())
+  {
+    return;
+  }
+
   switch (button)
   {
     case GLFW_MOUSE_BUTTON_RIGHT:
@@ -208,7 +263,10 @@ void CallbackContext::MouseButton_Viewport(GLFWwindow *pWindow, int button, int
           s_pPrevValidUI->OnTouchLeave();
           s_pPrevValidUI = nullptr;
         }
-        // TODO Raytrace & select object
+
+        double x, y;
+        glfwGetCursorPos(pWindow, &x, &y);
+        s_SelectedEntity = PickEntity(x, y);
       }
       break;
     default:
@@ -216,6 +274,64 @@ void CallbackContext::MouseButton_Viewport(GLFWwindow *pWindow, int button, int
   }
 }
 
+void CallbackContext::RotateCamera(float xDiff, float yDiff)
+{
+  static ConstVector<UIViewport *> pViewports = EntityManager::GetAll<UIViewport>();
+  if (pViewports.size() < 2 || !pViewports[1]->GetCamera())
+  {
+    return;
+  }
+  CameraComponent *pCamera = pViewports[1]->GetCamera();
+
+  // Apply appropriate rotations to camera
+  TransformDirs localDirs = pCamera->m_pTransformComp->GetLocalDirs();
+  pCamera->m_pMover->Rotate(-yDiff, localDirs.rightDir);
+  pCamera->m_pMover->Rotate(-xDiff, glm::vec3(0, 1, 0));
+}
+
 void CallbackContext::SetGame(Game *pGame) { s_pCurrentGame = pGame; }
 
+Entity CallbackContext::PickEntity(double x, double y)
+{
+  Screen &currentScreen = s_pCurrentGame->GetCurrentScreen();
+  const float w = float(currentScreen.GetWidth());
+  const float h = float(currentScreen.GetHeight());
+  y = h - y - 1;
+
+  ConstVector<UIViewport *> pViewports = EntityManager::GetAll<UIViewport>();
+  for (size_t i = 1; i < pViewports.size(); ++i)
+  {
+    const CameraComponent *pCamera = pViewports[i]->GetCamera();
+    screenBound_t bounds = pViewports[i]->GetScreenBounds();
+    float sX = bounds.points[0].X * w;
+    float sY = bounds.points[0].Y * h;
+    float viewWidth = w * bounds.points[1].X - sX;
+    float viewHeight = h * bounds.points[1].Y - sY;
+    if (!pCamera || x < sX || x >= sX + viewWidth || y < sY || y >= sY + viewHeight)
+    {
+      continue;
+    }
+
+    // Unproject the cursor onto the near and far planes, and cast between them,
+    // with the camera where it was last drawn.
+    const glm::mat4 toWorld = glm::inverse(pCamera->GetCameraMatrix(
+        viewWidth, viewHeight, s_pCurrentGame->GetInterpolationAlpha()));
+    const float ndcX = float(2 * (x - sX) / viewWidth - 1);
+    const float ndcY = float(2 * (y - sY) / viewHeight - 1);
+    glm::vec4 nearPoint = toWorld * glm::vec4(ndcX, ndcY, -1.f, 1.f);
+    glm::vec4 farPoint = toWorld * glm::vec4(ndcX, ndcY, 1.f, 1.f);
+    nearPoint /= nearPoint.w;
+    farPoint /= farPoint.w;
+
+    RayHit hit;
+    if (SceneQuery::GetGlobalInstance().RayCast(
+            glm::vec3(nearPoint), glm::vec3(farPoint - nearPoint), 1.f, hit))
+    {
+      return hit.entity;
+    }
+    return kNullEntity;
+  }
+  return kNullEntity;
+}
+
 }  // namespace tetrad
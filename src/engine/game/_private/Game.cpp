@@ -1,6 +1,7 @@
 #include "engine/game/Game.h"
 
 #include <chrono>
+#include <cmath>
 #include <cstdint>
 #include <vector>
 
@@ -8,17 +9,24 @@
 #include "core/Log.h"
 #include "core/Paths.h"
 #include "core/Rand.h"
+#include "core/TimingRegistry.h"
 #include "engine/ecs/EntityManager.h"
 #include "engine/game/CallbackContext.h"
+#include "engine/game/InputRecorder.h"
 #include "engine/render/CameraComponent.h"
 #include "engine/resource/ResourceManager.h"
 #include "engine/transform/TransformComponent.h"
+#include "engine/transform/TransformHierarchy.h"
 #include "engine/ui/TextComponent.h"
 
 namespace tetrad {
 
 GameAttributes::GameAttributes(ScreenAttributes mainWindowAttr, MouseMode mouseMode)
-    : m_MainWindowAttr(mainWindowAttr), m_MouseMode(mouseMode)
+    : m_MainWindowAttr(mainWindowAttr),
+      m_MouseMode(mouseMode),
+      m_FixedTimeStep(1.f / 60),
+      m_TargetFrameTime(0),
+      m_RetainUi(false)
 {}
 
 Game::Game()
@@ -27,7 +35,11 @@ Game::Game()
       m_DeltaAvg(.01666667),
       m_DeltaAlpha(.125),
       m_JitterAvg(0),
-      m_JitterAlpha(.25)
+      m_JitterAlpha(.25),
+      m_FixedTimeStep(1.f / 60),
+      m_Accumulator(0),
+      m_InterpolationAlpha(1),
+      m_IsUiRetained(false)
 {}
 
 bool Game::Initialize(const GameAttributes &attributes)
@@ -35,6 +47,24 @@ bool Game::Initialize(const GameAttributes &attributes)
   // Ensures that the static Random instance gets constructed
   Random::GetGlobalInstance();
 
+  // Seeds it too, when recording or replaying
+  InputRecorder &recorder = InputRecorder::GetGlobalInstance();
+  if (!attributes.m_InputReplayPath.empty())
+  {
+    if (!recorder.StartReplay(attributes.m_InputReplayPath, attributes.m_FrameTimesPath))
+    {
+      return false;
+    }
+  }
+  else if (!attributes.m_InputRecordPath.empty())
+  {
+    if (!recorder.StartRecording(attributes.m_InputRecordPath,
+                                 attributes.m_FixedTimeStep))
+    {
+      return false;
+    }
+  }
+
   if (!glfwInit())
   {
     LOG_ERROR("Failed to initialize glfw\n");
@@ -69,6 +99,9 @@ bool Game::Initialize(const GameAttributes &attributes)
     return false;
   }
 
+  m_IsUiRetained = attributes.m_RetainUi;
+  m_TimingsPath = attributes.m_TimingsPath;
+
   // Initialize systems
   AddSystems();
   LOG_DEBUG("Finished adding game systems\n");
@@ -87,6 +120,17 @@ bool Game::Initialize(const GameAttributes &attributes)
   ExitHook::Instance()->AddHook([this](ExitReason) { this->Shutdown(); });
   OnInitialized();
   m_CurrentState = EGameState::STARTED;
+  if (recorder.IsReplaying())
+  {
+    // Replays run as fast as they can, with the steps they were recorded with
+    m_FixedTimeStep = recorder.GetFixedTimeStep();
+    m_FrameLimiter.SetTargetFrameTime(0);
+  }
+  else
+  {
+    m_FixedTimeStep = attributes.m_FixedTimeStep;
+    m_FrameLimiter.SetTargetFrameTime(attributes.m_TargetFrameTime);
+  }
   m_Timer.Start();
   return true;
 }
@@ -94,12 +138,20 @@ bool Game::Initialize(const GameAttributes &attributes)
 void Game::Shutdown()
 {
   LOG("Triggering Game shutdown\n");
+  InputRecorder::GetGlobalInstance().Stop();
+
   for (size_t i = m_pSystems.size(); i > 0;)
   {
     m_pSystems[--i]->Shutdown();
     delete m_pSystems[i];
   }
 
+  // Dumped once the systems are down, so the last frame's passes are in.
+  if (!m_TimingsPath.empty())
+  {
+    TimingRegistry::GetGlobalInstance().DumpCsv(m_TimingsPath);
+  }
+
   m_MainScreen.Shutdown();
   glfwTerminate();
 
@@ -110,6 +162,7 @@ void Game::Run()
 {
   deltaTime_t deltaTime;
   deltaTime_t deltaInvAlpha = 1 - m_DeltaAlpha;
+  InputRecorder &recorder = InputRecorder::GetGlobalInstance();
   deltaTime_t jitterInvAlpha = 1 - m_JitterAlpha;
 
 #ifdef _DEBUG
@@ -121,29 +174,78 @@ void Game::Run()
 
   char fpsStr[8];
   char jitterStr[8];
+  char timingStr[8];
+  std::string overlayStr;
 #endif
 
   while (!glfwWindowShouldClose(m_MainScreen.GetWindow()))
   {
     deltaTime = m_Timer.Tick();
+    if (!recorder.BeginFrame(deltaTime))
+    {
+      LOG("Finished replaying input\n");
+      break;
+    }
 
     // delta EMWA calculation
     m_DeltaAvg = (m_DeltaAlpha * deltaTime) + (deltaInvAlpha * m_DeltaAvg);
-    m_JitterAvg =
-        (m_JitterAlpha * abs(deltaTime - m_DeltaAvg)) + (jitterInvAlpha * m_JitterAvg);
+    deltaTime_t targetDelta =
+        m_FrameLimiter.IsEnabled() ? m_FrameLimiter.GetTargetFrameTime() : m_DeltaAvg;
+    m_JitterAvg = (m_JitterAlpha * std::abs(deltaTime - targetDelta)) +
+                  (jitterInvAlpha * m_JitterAvg);
 
 #ifdef _DEBUG
     snprintf(fpsStr, sizeof(fpsStr), "%7.2f", 1.f / m_DeltaAvg);
     snprintf(jitterStr, sizeof(jitterStr), "%7.2f", m_JitterAvg * 1000);
-    pText->SetText(std::string("FPS: ") + fpsStr + "\nJitter (ms):" + jitterStr);
+    overlayStr = std::string("FPS: ") + fpsStr + "\nJitter (ms):" + jitterStr;
+
+    // GPU timings of the render passes.
+    for (const auto &timing : TimingRegistry::GetGlobalInstance().GetTimings())
+    {
+      snprintf(timingStr, sizeof(timingStr), "%7.2f", timing.avgMs);
+      overlayStr += "\n" + timing.name + " (ms):" + timingStr;
+    }
+    pText->SetText(overlayStr);
 #endif
 
-    // Tick systems
+    // Tick systems. Fixed-step systems all run together, in place of the first
+    // of them, so that every simulation step sees the others' results.
+    bool hasRunFixedSteps = false;
+    for (size_t i = 0; i < m_pSystems.size(); ++i)
+    {
+      if (!m_pSystems[i]->IsFixedStep())
+      {
+        m_pSystems[i]->Tick(deltaTime);
+      }
+      else if (!hasRunFixedSteps)
+      {
+        RunFixedSteps(deltaTime);
+        hasRunFixedSteps = true;
+      }
+    }
+
+    m_FrameLimiter.Wait();
+  }
+}
+
+void Game::RunFixedSteps(deltaTime_t deltaTime)
+{
+  m_Accumulator += deltaTime;
+  while (m_Accumulator >= m_FixedTimeStep)
+  {
+    TransformHierarchy::GetGlobalInstance().StoreState();
+
     for (size_t i = 0; i < m_pSystems.size(); ++i)
     {
-      m_pSystems[i]->Tick(deltaTime);
+      if (m_pSystems[i]->IsFixedStep())
+      {
+        m_pSystems[i]->Tick(m_FixedTimeStep);
+      }
     }
+    m_Accumulator -= m_FixedTimeStep;
   }
+
+  m_InterpolationAlpha = m_Accumulator / m_FixedTimeStep;
 }
 
 bool Game::Pause()
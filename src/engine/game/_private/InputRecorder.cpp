@@ -0,0 +1,293 @@
+#include "engine/game/InputRecorder.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <random>
+
+#include "core/Log.h"
+#include "core/Rand.h"
+#include "core/Timer.h"
+#include "engine/event/EventSystem.h"
+
+namespace tetrad {
+
+InputRecorder::InputRecorder()
+    : m_Mode(EMode::OFF),
+      m_FixedTimeStep(0),
+      m_StartTime(0),
+      m_ReadPos(0),
+      m_FrameStartTime(0),
+      m_HasRotation(false),
+      m_XDiff(0),
+      m_YDiff(0)
+{}
+
+InputRecorder::~InputRecorder() { Stop(); }
+
+bool InputRecorder::StartRecording(const std::string &path, deltaTime_t fixedTimeStep)
+{
+  Stop();
+
+  m_File.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!m_File)
+  {
+    LOG_ERROR("Failed to open " << path << " to record input\n");
+    return false;
+  }
+
+  const uint32_t seed = std::random_device()();
+  Random::GetGlobalInstance().Reseed(seed);
+
+  m_Mode = EMode::RECORDING;
+  m_FixedTimeStep = fixedTimeStep;
+  m_StartTime = Timer::GetTimeNs();
+  Write(Header{kMagic, kVersion, seed, fixedTimeStep});
+
+  LOG("Recording input to " << path << " (seed " << seed << ")\n");
+  return true;
+}
+
+bool InputRecorder::StartReplay(const std::string &path,
+                                const std::string &frameTimesPath)
+{
+  Stop();
+
+  std::ifstream file(path, std::ios::in | std::ios::binary);
+  if (!file)
+  {
+    LOG_ERROR("Failed to open " << path << " to replay input\n");
+    return false;
+  }
+  m_Recording.assign(std::istreambuf_iterator<char>(file),
+                     std::istreambuf_iterator<char>());
+  m_ReadPos = 0;
+
+  Header header;
+  if (!Read(header) || header.magic != kMagic || header.version != kVersion)
+  {
+    LOG_ERROR(path << " is not an input recording this build can replay\n");
+    m_Recording.clear();
+    return false;
+  }
+
+  Random::GetGlobalInstance().Reseed(header.seed);
+
+  m_Mode = EMode::REPLAYING;
+  m_FixedTimeStep = header.fixedTimeStep;
+  m_FrameTimesPath = frameTimesPath;
+  m_FrameStartTime = 0;
+  m_FrameTimes.clear();
+  m_HasRotation = false;
+
+  LOG("Replaying input from " << path << " (seed " << header.seed << ")\n");
+  return true;
+}
+
+void InputRecorder::Stop()
+{
+  if (m_Mode == EMode::RECORDING)
+  {
+    Flush();
+    m_File.close();
+  }
+  else if (m_Mode == EMode::REPLAYING)
+  {
+    LogFrameTimes();
+    m_Recording.clear();
+    m_Recording.shrink_to_fit();
+  }
+  m_Mode = EMode::OFF;
+}
+
+bool InputRecorder::BeginFrame(deltaTime_t &deltaTime)
+{
+  if (m_Mode == EMode::RECORDING)
+  {
+    Write(ERT_FRAME);
+    Write(deltaTime);
+    if (m_Buffer.size() >= kFlushSize)
+    {
+      Flush();
+    }
+    return true;
+  }
+  if (m_Mode != EMode::REPLAYING)
+  {
+    return true;
+  }
+
+  // The time of the previous frame, from its start to this one's
+  const int64_t now = Timer::GetTimeNs();
+  if (m_FrameStartTime != 0)
+  {
+    m_FrameTimes.push_back(float((now - m_FrameStartTime) * 1e-6));
+  }
+  m_FrameStartTime = now;
+
+  uint8_t tag;
+  if (!Read(tag) || tag != ERT_FRAME || !Read(deltaTime))
+  {
+    return false;
+  }
+
+  // Feed in everything up to the next frame
+  m_HasRotation = false;
+  m_XDiff = m_YDiff = 0;
+  EventSystem *pInputSystem = EventSystem::GetInputSystem();
+  uint32_t timestamp;
+  while (m_ReadPos < m_Recording.size() && m_Recording[m_ReadPos] != ERT_FRAME)
+  {
+    Read(tag);
+    if (tag == ERT_EVENT)
+    {
+      uint8_t event, action, state;
+      if (!Read(timestamp) || !Read(event) || !Read(action) || !Read(state))
+      {
+        return false;
+      }
+
+      Event replayed;
+      replayed.event = EGameEvent(event);
+      replayed.action = EEventAction(action);
+      replayed.state = EGameState(state);
+      if (pInputSystem)
+      {
+        pInputSystem->Inform(replayed);
+      }
+    }
+    else if (tag == ERT_ROTATION)
+    {
+      float xDiff, yDiff;
+      if (!Read(timestamp) || !Read(xDiff) || !Read(yDiff))
+      {
+        return false;
+      }
+      m_HasRotation = true;
+      m_XDiff += xDiff;
+      m_YDiff += yDiff;
+    }
+    else
+    {
+      LOG_ERROR("Unknown record " << uint32_t(tag) << " in input recording\n");
+      return false;
+    }
+  }
+  return true;
+}
+
+void InputRecorder::RecordEvent(const Event &event)
+{
+  if (m_Mode != EMode::RECORDING)
+  {
+    return;
+  }
+
+  Write(ERT_EVENT);
+  Write(GetTimestamp());
+  Write(uint8_t(event.event));
+  Write(uint8_t(event.action));
+  Write(uint8_t(event.state));
+}
+
+void InputRecorder::RecordRotation(float xDiff, float yDiff)
+{
+  if (m_Mode != EMode::RECORDING)
+  {
+    return;
+  }
+
+  Write(ERT_ROTATION);
+  Write(GetTimestamp());
+  Write(xDiff);
+  Write(yDiff);
+}
+
+bool InputRecorder::TakeRotation(float &xDiff, float &yDiff)
+{
+  if (!m_HasRotation)
+  {
+    return false;
+  }
+
+  xDiff = m_XDiff;
+  yDiff = m_YDiff;
+  m_HasRotation = false;
+  return true;
+}
+
+template <typename T>
+void InputRecorder::Write(const T &value)
+{
+  const uint8_t *pBytes = reinterpret_cast<const uint8_t *>(&value);
+  m_Buffer.insert(m_Buffer.end(), pBytes, pBytes + sizeof(T));
+}
+
+template <typename T>
+bool InputRecorder::Read(T &value)
+{
+  if (m_Recording.size() - m_ReadPos < sizeof(T))
+  {
+    m_ReadPos = m_Recording.size();
+    return false;
+  }
+
+  std::memcpy(&value, &m_Recording[m_ReadPos], sizeof(T));
+  m_ReadPos += sizeof(T);
+  return true;
+}
+
+uint32_t InputRecorder::GetTimestamp() const
+{
+  return uint32_t((Timer::GetTimeNs() - m_StartTime) / 1000);
+}
+
+void InputRecorder::Flush()
+{
+  m_File.write(reinterpret_cast<const char *>(m_Buffer.data()), m_Buffer.size());
+  if (!m_File)
+  {
+    LOG_ERROR("Failed to write input recording\n");
+  }
+  m_Buffer.clear();
+}
+
+void InputRecorder::LogFrameTimes()
+{
+  if (m_FrameTimes.empty())
+  {
+    return;
+  }
+
+  if (!m_FrameTimesPath.empty())
+  {
+    std::ofstream csvFile(m_FrameTimesPath, std::ios::out | std::ios::trunc);
+    csvFile << "frame,ms\n";
+    for (size_t i = 0; i < m_FrameTimes.size(); ++i)
+    {
+      csvFile << i << "," << m_FrameTimes[i] << "\n";
+    }
+    if (!csvFile)
+    {
+      LOG_ERROR("Failed to dump frame times to " << m_FrameTimesPath << "\n");
+    }
+  }
+
+  std::vector<float> sorted = m_FrameTimes;
+  std::sort(sorted.begin(), sorted.end());
+  auto percentile = [&sorted](float p) {
+    return sorted[std::min(sorted.size() - 1, size_t(p * sorted.size()))];
+  };
+  double total = 0;
+  for (float ms : sorted)
+  {
+    total += ms;
+  }
+
+  LOG("Replayed " << sorted.size() << " frames (ms): mean " << total / sorted.size()
+                  << ", p50 " << percentile(.5f) << ", p95 " << percentile(.95f)
+                  << ", p99 " << percentile(.99f) << ", max " << sorted.back()
+                  << "\n");
+}
+
+}  // namespace tetrad
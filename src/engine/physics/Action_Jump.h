@@ -1,24 +1,27 @@
 #pragma once
 
-#include "engine/ecs/Entity.h"
-#include "engine/event/IAction.h"
+#include "engine/ecs/ComponentRef.h"
+#include "engine/event/Constants.h"
 
 namespace tetrad {
 
+class PhysicsComponent;
+
 /** @brief Action to cause the provided entity to jump.
  *
  * Obviously relies on the entity containing a PhysicsComponent. Lacking this,
  * the Action will not do anything (@todo perhaps log the event?)
  */
-class Action_Jump : public IAction
+class Action_Jump
 {
  public:
   Action_Jump(Entity entity);
 
-  bool operator()(EEventAction) override;
+  bool operator()(EEventAction);
+  void Refresh() { m_Physics.Refresh(); }
 
  private:
-  Entity m_Entity;
+  ComponentRef<PhysicsComponent> m_Physics;
 };
 
 }  // namespace tetrad
@@ -1,18 +1,18 @@
 #pragma once
 
-#include <glm/vec3.hpp>
-
-#include "engine/ecs/Entity.h"
-#include "engine/event/IAction.h"
+#include "engine/ecs/ComponentRef.h"
+#include "engine/event/Constants.h"
 
 namespace tetrad {
 
+class PhysicsComponent;
+
 /** @brief Action to cause the provided entity to move in a specified direction.
  *
- * @note Relies on the referenced entity having a MovableComponent. Otherwise,
+ * @note Relies on the referenced entity having a PhysicsComponent. Otherwise,
  * this Action will log an error in debug mode.
  */
-class Action_Move : public IAction
+class Action_Move
 {
  public:
   enum EMoveDirection
@@ -29,12 +29,12 @@ class Action_Move : public IAction
    *
    * @return true unless the entity could not be moved
    */
-  bool operator()(EEventAction) override;
+  bool operator()(EEventAction);
+  void Refresh() { m_Physics.Refresh(); }
 
  private:
-  Entity m_Entity;
+  ComponentRef<PhysicsComponent> m_Physics;
   EMoveDirection m_Direction;
-  glm::vec3 m_MoveVec;
 };
 
 }  // namespace tetrad
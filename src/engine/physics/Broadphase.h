@@ -0,0 +1,119 @@
+#pragma once
+
+#include <vector>
+
+#include "core/BaseTypes.h"
+
+namespace tetrad {
+
+/** @brief World bounds of every collider for one tick, as structure-of-arrays.
+ *
+ * Every collider is a box grown by a radius: boxes have a radius of 0, and
+ * spheres are a point grown by theirs. min and max bound the whole shape, so
+ * the box at the core spans from min + radius to max - radius.
+ */
+struct ColliderBounds
+{
+  std::vector<float> min[3];
+  std::vector<float> max[3];
+  std::vector<float> radius;
+
+  inline size_t GetCount() const { return radius.size(); }
+
+  void Clear()
+  {
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      min[axis].clear();
+      max[axis].clear();
+    }
+    radius.clear();
+  }
+};
+
+/** @brief Indices of two colliders in a ColliderBounds. */
+struct CollisionPair
+{
+  uint32_t a;
+  uint32_t b;
+};
+
+enum class EBroadphaseType : uint8_t
+{
+  SWEEP_AND_PRUNE,  // Best when colliders are spread out along one axis
+  UNIFORM_GRID      // Best when colliders are spread out evenly, and similar in size
+};
+
+/** @brief Finds the pairs of colliders whose boxes overlap, without testing all pairs.
+ *
+ * Sweep and prune keeps colliders sorted along the axis they are most spread
+ * out on, and only pairs up neighbors that overlap on it. The order is kept
+ * between ticks, so re-sorting is close to linear as long as colliders don't
+ * jump around.
+ *
+ * The uniform grid hashes every collider into the cells its box covers, and
+ * only pairs up colliders sharing a cell.
+ */
+class Broadphase
+{
+ public:
+  static constexpr uint32_t kNoRank = ~0u;
+
+  Broadphase();
+
+  /** @brief Choose the algorithm, which is best picked per scene.
+   *
+   * @param cellSize - grid cell size. 0 picks twice the average box size.
+   */
+  void SetType(EBroadphaseType type, float cellSize = 0.f);
+  inline EBroadphaseType GetType() const { return m_Type; }
+
+  /** @brief Find every pair of colliders whose boxes overlap.
+   *
+   * @param pRanks - each collider's position in the sweep order, as returned
+   *        last tick (or kNoRank for new colliders). Updated in place.
+   */
+  void FindPairs(const ColliderBounds &bounds, uint32_t *pRanks,
+                 std::vector<CollisionPair> &pairs);
+
+ private:
+  struct GridCell
+  {
+    int32_t coords[3];
+
+    bool operator==(const GridCell &other) const
+    {
+      return coords[0] == other.coords[0] && coords[1] == other.coords[1] &&
+             coords[2] == other.coords[2];
+    }
+  };
+
+  struct GridEntry
+  {
+    uint64_t hash;
+    GridCell cell;
+    uint32_t collider;
+  };
+
+  void SweepAndPrune(const ColliderBounds &bounds, uint32_t *pRanks,
+                     std::vector<CollisionPair> &pairs);
+  void UniformGrid(const ColliderBounds &bounds, std::vector<CollisionPair> &pairs);
+
+  /** @brief Pick the axis the colliders are most spread out along. */
+  int FindSweepAxis(const ColliderBounds &bounds) const;
+
+ private:
+  EBroadphaseType m_Type;
+  float m_CellSize;
+
+  int m_SweepAxis;
+  std::vector<uint32_t> m_SweepOrder;
+  std::vector<uint32_t> m_RankSlots;
+
+  std::vector<GridEntry> m_GridEntries;
+  std::vector<GridCell> m_FirstCells;  // Lowest cell covered by each collider
+  std::vector<uint32_t> m_Oversized;   // Colliders covering too many cells
+  std::vector<uint8_t> m_IsOversized;
+};
+
+}  // namespace tetrad
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "core/BaseTypes.h"
+#include "core/Reflection.h"
+#include "engine/ecs/IComponent.h"
+
+namespace tetrad {
+
+class PhysicsComponent;
+class TransformComponent;
+struct ColliderBounds;
+
+enum class ECollisionShape : uint8_t
+{
+  BOX,
+  SPHERE
+};
+
+/** @brief Interface for reacting to collisions.
+ *
+ * Touches are delivered in batches: once per physics tick, with every entity
+ * that was touched during that tick.
+ */
+class ITouchHandler
+{
+ public:
+  ITouchHandler() {}
+  virtual ~ITouchHandler() {}
+
+  /** @brief Called with the entities overlapping the handler's entity.
+   *
+   * @note Destroying entities from here is fine, but handlers of destroyed
+   * entities won't be called for the rest of the tick.
+   */
+  virtual void OnTouched(Entity entity, const Entity *pTouched, size_t count) = 0;
+};
+
+/** @brief Component for bounding objects, so they can touch each other.
+ *
+ * The bounds follow the entity's absolute transform. Boxes are given in model
+ * space (the default spans -1 to 1, like the built-in shapes) and rotate with
+ * the entity. Spheres are scaled by the largest axis of the entity's scale.
+ *
+ * Requires a TransformComponent. Collisions are found by the PhysicsSystem.
+ */
+COMPONENT()
+class CollisionComponent : public IComponent
+{
+ public:
+  CollisionComponent(Entity entity);
+  ~CollisionComponent();
+
+  void Refresh() override;
+
+  void SetBox(const glm::vec3 &halfExtents = glm::vec3(1.f, 1.f, 1.f));
+  void SetSphere(float radius = 1.f);
+  inline ECollisionShape GetShape() const { return m_Shape; }
+
+  /** @brief Set the handler to call when touched, taking ownership of it.
+   *
+   * Entities without a handler still block and touch others.
+   */
+  void SetTouchHandler(ITouchHandler *pHandler);
+
+ private:
+  /** @brief Append the current world bounds to a set of bounds. */
+  void AppendBounds(ColliderBounds &bounds) const;
+
+  friend class PhysicsSystem;
+
+ private:
+  TransformComponent *m_pTransformComp;
+  PhysicsComponent *m_pPhysicsComp;  // nullptr for static colliders
+  ITouchHandler *m_pTouchHandler;
+
+  ECollisionShape m_Shape;
+  glm::vec3 m_HalfExtents;  // Radius in x, for spheres
+
+  uint32_t m_SweepRank;  // Position in the broadphase's order, as of last tick
+};
+
+}  // namespace tetrad
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "engine/physics/Broadphase.h"
+
+namespace tetrad {
+
+/** @brief Exact overlap tests for the pairs found by the Broadphase.
+ *
+ * Since every collider is a box grown by a radius (see ColliderBounds), all
+ * shape combinations come down to one test: the distance between the core
+ * boxes must be at most the sum of the radii. That lets pairs of any shapes be
+ * tested together, 4 at a time with SSE.
+ */
+class Narrowphase
+{
+ public:
+  /** @brief Keep only the pairs whose shapes overlap.
+   *
+   * @return how many pairs overlap. They are moved to the front of pPairs,
+   *         keeping their order.
+   */
+  static size_t FilterPairs(const ColliderBounds &bounds, CollisionPair *pPairs,
+                            size_t count);
+
+ private:
+  static bool TestPair(const ColliderBounds &bounds, const CollisionPair &pair);
+};
+
+}  // namespace tetrad
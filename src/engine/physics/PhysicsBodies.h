@@ -0,0 +1,152 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "core/BaseTypes.h"
+
+namespace tetrad {
+
+class PhysicsComponent;
+class TransformComponent;
+struct CollisionPair;
+
+/** @brief Flat storage of the simulation state of every PhysicsComponent.
+ *
+ * Each body has a slot in a set of parallel arrays, one per float, so that
+ * integration can run over contiguous memory with SIMD. Removing a body moves
+ * another one into its slot, keeping the arrays dense.
+ *
+ * Awake bodies are kept in the first GetAwakeCount() slots, and only those are
+ * integrated. A body falls asleep once it has been at rest (no gravity, no
+ * movement, next to no velocity) for kTimeToSleep, along with every body it is
+ * touching. Setting its velocity, movement or gravity wakes it back up, as
+ * does being touched by an awake body.
+ *
+ * Integration is split in two passes. The first integrates velocities, finds
+ * each body's displacement and how long it has been at rest. The second hands
+ * every displacement and movement to TransformHierarchy::Translate at once,
+ * which writes them straight into its position channel. The hierarchy slot of
+ * each transform is cached, and only looked up again after the hierarchy has
+ * moved its slots around.
+ *
+ * Awake bodies are kept sorted by hierarchy slot, those without movement
+ * first, so that the second pass walks the hierarchy forward rather than
+ * jumping around it. They're only sorted again once a good part of them have
+ * been moved out of order (by waking, sleeping, or the hierarchy moving its
+ * slots).
+ */
+class PhysicsBodies
+{
+ public:
+  static constexpr float kTimeToSleep = 0.5f;
+  static constexpr float kSleepSpeed = 0.01f;
+
+  PhysicsBodies();
+
+  PhysicsBodies(const PhysicsBodies &) = delete;
+  PhysicsBodies &operator=(const PhysicsBodies &) = delete;
+
+  void Add(PhysicsComponent &component);
+  void Remove(PhysicsComponent &component);
+
+  /** @brief Advance every awake body by dt, moving its transform. */
+  void Integrate(deltaTime_t dt);
+
+  /** @brief Put bodies to sleep or wake them, island by island.
+   *
+   * @param pContacts - pairs of body slots that are touching this tick
+   */
+  void UpdateSleep(const CollisionPair *pContacts, size_t count);
+
+  inline glm::vec3 GetVelocity(uint32_t index) const
+  {
+    return glm::vec3(m_Velocity[0][index], m_Velocity[1][index], m_Velocity[2][index]);
+  }
+  /** @note Setters wake the body, which may move it to another slot. */
+  inline void SetVelocity(uint32_t index, const glm::vec3 &velocity)
+  {
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      m_Velocity[axis][index] = velocity[axis];
+    }
+    Wake(index);
+  }
+  /** @brief Set the movement, in the body's local space. */
+  inline void SetMovement(uint32_t index, const glm::vec3 &movement)
+  {
+    const bool hadMovement = HasMovement(index);
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      m_Movement[axis][index] = movement[axis];
+    }
+    m_UnsortedCount += HasMovement(index) != hadMovement;
+    Wake(index);
+  }
+  inline void SetGravity(uint32_t index, bool on)
+  {
+    m_Gravity[index] = on ? 1.f : 0.f;
+    Wake(index);
+  }
+  inline float &GetImpulseWait(uint32_t index) { return m_ImpulseWait[index]; }
+  void SetTransform(uint32_t index, TransformComponent *pTransform);
+
+  inline bool IsAwake(uint32_t index) const { return index < m_AwakeCount; }
+  inline uint32_t GetAwakeCount() const { return m_AwakeCount; }
+  void Wake(uint32_t index);
+
+  /** @brief Returns a static instance of PhysicsBodies. */
+  static PhysicsBodies &GetGlobalInstance()
+  {
+    static PhysicsBodies bodies;
+    return bodies;
+  }
+
+ private:
+  /** @brief Update velocities and find each body's displacement. */
+  void IntegrateVelocities(float dt);
+  /** @brief Move transforms by their displacements and movement. */
+  void WriteBack(float dt);
+  /** @brief Look up the hierarchy slots again if they've been moved. */
+  void RefreshHierarchyIndices();
+  /** @brief Sort the awake bodies by hierarchy slot. */
+  void SortAwakeBodies();
+
+  inline bool HasMovement(uint32_t index) const
+  {
+    return m_Movement[0][index] != 0.f || m_Movement[1][index] != 0.f ||
+           m_Movement[2][index] != 0.f;
+  }
+
+  void Sleep(uint32_t index);
+  /** @brief Exchange the contents of two slots. */
+  void Swap(uint32_t a, uint32_t b);
+
+  /** @brief Find the root of a body's island, in m_IslandParents. */
+  uint32_t FindIsland(uint32_t index);
+
+ private:
+  std::vector<PhysicsComponent *> m_pComponents;
+  std::vector<TransformComponent *> m_pTransforms;  // nullptr until refreshed
+  std::vector<uint32_t> m_HierarchyIndices;
+  uint32_t m_LayoutVersion;  // Of the hierarchy, as of the cached indices
+
+  std::vector<float> m_Velocity[3];
+  std::vector<float> m_Movement[3];
+  std::vector<float> m_Gravity;  // 1 if gravity is on, else 0
+  std::vector<float> m_ImpulseWait;
+  std::vector<float> m_RestTime;  // Time spent at rest, while awake
+
+  uint32_t m_AwakeCount;
+  uint32_t m_UnsortedCount;  // Bodies moved out of order since the last sort
+
+  // Scratch space
+  std::vector<float> m_Displacement[3];
+  std::vector<std::pair<uint64_t, uint32_t>> m_SortKeys;  // With their body slots
+  std::vector<uint32_t> m_IslandParents;
+  std::vector<uint8_t> m_IsIslandAwake;
+  std::vector<PhysicsComponent *> m_pToWake;
+  std::vector<PhysicsComponent *> m_pToSleep;
+};
+
+}  // namespace tetrad
@@ -6,28 +6,31 @@
 
 namespace tetrad {
 
-class MovableComponent;
 class Action_Move;
+class PhysicsBodies;
 
 /** @brief Component to give physical simulation capabilities.
  *
- * Requires the MovableComponent to function properly.
+ * Requires a TransformComponent to function properly. The simulation state
+ * itself lives in PhysicsBodies, which integrates every awake body at once.
+ * Bodies left at rest fall asleep, and wake up when their velocity, movement
+ * or gravity is changed, or when an awake body touches them.
  */
 COMPONENT()
 class PhysicsComponent : public IComponent
 {
  public:
   PhysicsComponent(Entity entity);
+  ~PhysicsComponent();
 
   void Refresh() override;
 
-  void Tick(deltaTime_t dt);
   bool Impulse();  // Returns true only if the impulse was successful
 
-  void SetVelocity(glm::vec3 velocity) { m_Velocity = velocity; }
-  void IncrementVelocity(const glm::vec3& velocity) { m_Velocity += velocity; }
+  void SetVelocity(glm::vec3 velocity);
+  void IncrementVelocity(const glm::vec3& velocity);
 
-  void SetGravity(bool on) { m_IsGravityOn = on; }
+  void SetGravity(bool on);
 
   void SetMovementSpeed(float speed) { m_MovementSpeed = speed; }
 
@@ -39,6 +42,8 @@ class PhysicsComponent : public IComponent
   void UpdateMovement(int direction, bool on);
 
   friend class Action_Move;
+  friend class PhysicsBodies;
+  friend class PhysicsSystem;
 
  private:
   static float s_Gravity;
@@ -47,16 +52,10 @@ class PhysicsComponent : public IComponent
   static float s_ImpulseSpeed;
   static float s_ImpulseWaitTime;
 
-  bool m_IsGravityOn;
   int16_t m_MovementDir;
-
   float m_MovementSpeed;
-  float m_ImpulseWait;
-
-  glm::vec3 m_Velocity;
-  glm::vec3 m_Movement;
 
-  MovableComponent* m_pMover;
+  uint32_t m_BodyIndex;  // Slot in PhysicsBodies
 };
 
 }  // namespace tetrad
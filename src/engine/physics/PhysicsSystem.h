@@ -1,11 +1,15 @@
 #pragma once
 
+#include <vector>
+
 #include "core/ConstVector.h"
+#include "engine/ecs/Entity.h"
 #include "engine/ecs/System.h"
+#include "engine/physics/Broadphase.h"
 
 namespace tetrad {
 
-class PhysicsComponent;
+class CollisionComponent;
 
 /** @brief System to perform physics simulations on relevant components.
  *
@@ -16,8 +20,12 @@ class PhysicsComponent;
  * This system will do the necessary calculations involved to make the above components
  * act as they should.
  *
- * @TODO Use some sort of space partitioning so that the work involved for this system is
- * decreased (and also more easily parallelizable).
+ * Collisions are found in two phases: a Broadphase that finds the colliders
+ * whose bounds overlap, and a Narrowphase that tests the exact shapes. Touch
+ * handlers are then called once per entity with all of its touches.
+ *
+ * Bodies at rest are put to sleep by PhysicsBodies, and touching bodies are
+ * grouped into islands that sleep and wake together.
  */
 class PhysicsSystem : public System
 {
@@ -25,9 +33,31 @@ class PhysicsSystem : public System
   PhysicsSystem();
 
   void Tick(deltaTime_t dt) override;
+  bool IsFixedStep() const override { return true; }
+
+  /** @brief Choose the broadphase algorithm to suit the scene. */
+  void SetBroadphase(EBroadphaseType type, float cellSize = 0.f);
 
  private:
-  ConstVector<PhysicsComponent *> m_pPhysicsComponents;
+  /** @brief Find touching colliders, returning the number of contacts. */
+  size_t DetectCollisions();
+  void UpdateSleep(size_t contactCount);
+  void DeliverTouches(size_t contactCount);
+
+ private:
+  ConstVector<CollisionComponent *> m_pCollisionComponents;
+
+  Broadphase m_Broadphase;
+
+  // Scratch space, kept between ticks to avoid reallocating
+  ColliderBounds m_Bounds;
+  std::vector<uint32_t> m_SweepRanks;
+  std::vector<CollisionPair> m_Pairs;
+  std::vector<CollisionPair> m_BodyContacts;  // Slots in PhysicsBodies
+  std::vector<CollisionPair> m_Touches;  // Touched collider first
+  std::vector<Entity> m_TouchedEntities;
+  std::vector<Entity> m_TouchingEntities;
+  std::vector<size_t> m_TouchStarts;
 };
 
 }  // namespace tetrad
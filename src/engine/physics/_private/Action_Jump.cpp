@@ -1,11 +1,10 @@
 #include "engine/physics/Action_Jump.h"
 
-#include "engine/ecs/EntityManager.h"
 #include "engine/physics/PhysicsComponent.h"
 
 namespace tetrad {
 
-Action_Jump::Action_Jump(Entity entity) : m_Entity(entity) {}
+Action_Jump::Action_Jump(Entity entity) : m_Physics(entity) {}
 
 bool Action_Jump::operator()(EEventAction action)
 {
@@ -14,7 +13,7 @@ bool Action_Jump::operator()(EEventAction action)
     return false;
   }
 
-  PhysicsComponent* pPhys = m_Entity.GetAs<PhysicsComponent>();
+  PhysicsComponent* pPhys = m_Physics.Get();
   if (pPhys)
   {
     pPhys->Impulse();
@@ -1,21 +1,20 @@
 #include "engine/physics/Action_Move.h"
 
 #include "core/Log.h"
-#include "engine/ecs/EntityManager.h"
 #include "engine/physics/PhysicsComponent.h"
 
 namespace tetrad {
 
 Action_Move::Action_Move(Entity entity, EMoveDirection direction)
-    : m_Entity(entity), m_Direction(direction)
+    : m_Physics(entity), m_Direction(direction)
 {}
 
 bool Action_Move::operator()(EEventAction action)
 {
-  PhysicsComponent *pPhys = m_Entity.GetAs<PhysicsComponent>();
+  PhysicsComponent *pPhys = m_Physics.Get();
   if (!pPhys)
   {
-    LOG_DEBUG("Entity " << static_cast<ObjectHandle>(m_Entity).GetID()
+    LOG_DEBUG("Entity " << static_cast<ObjectHandle>(m_Physics.GetEntity()).GetID()
                         << " has no PhysicsComponent, and thus can't be moved\n");
     return false;
   }
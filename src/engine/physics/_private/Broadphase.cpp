@@ -0,0 +1,286 @@
+#include "engine/physics/Broadphase.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace tetrad {
+
+namespace {
+// A new sweep axis must be this much more spread out to replace the current
+// one, so that the order isn't thrown away over small changes.
+constexpr float kSweepAxisHysteresis = 1.5f;
+
+// Colliders covering more grid cells than this are paired up by brute force.
+constexpr int64_t kMaxCellsPerCollider = 64;
+
+inline bool Overlaps(const ColliderBounds &bounds, uint32_t a, uint32_t b, int axis)
+{
+  return bounds.min[axis][a] <= bounds.max[axis][b] &&
+         bounds.min[axis][b] <= bounds.max[axis][a];
+}
+
+inline bool Overlaps(const ColliderBounds &bounds, uint32_t a, uint32_t b)
+{
+  return Overlaps(bounds, a, b, 0) && Overlaps(bounds, a, b, 1) &&
+         Overlaps(bounds, a, b, 2);
+}
+
+inline CollisionPair MakePair(uint32_t a, uint32_t b)
+{
+  return (a < b) ? CollisionPair{a, b} : CollisionPair{b, a};
+}
+}  // namespace
+
+Broadphase::Broadphase()
+    : m_Type(EBroadphaseType::SWEEP_AND_PRUNE), m_CellSize(0.f), m_SweepAxis(-1)
+{}
+
+void Broadphase::SetType(EBroadphaseType type, float cellSize)
+{
+  m_Type = type;
+  m_CellSize = cellSize;
+}
+
+void Broadphase::FindPairs(const ColliderBounds &bounds, uint32_t *pRanks,
+                           std::vector<CollisionPair> &pairs)
+{
+  pairs.clear();
+  if (m_Type == EBroadphaseType::SWEEP_AND_PRUNE)
+  {
+    SweepAndPrune(bounds, pRanks, pairs);
+  }
+  else
+  {
+    UniformGrid(bounds, pairs);
+    m_SweepOrder.clear();
+    m_SweepAxis = -1;
+    std::fill(pRanks, pRanks + bounds.GetCount(), kNoRank);
+  }
+}
+
+void Broadphase::SweepAndPrune(const ColliderBounds &bounds, uint32_t *pRanks,
+                               std::vector<CollisionPair> &pairs)
+{
+  const uint32_t count = uint32_t(bounds.GetCount());
+
+  // Restore last tick's order. Colliders that were there keep their place,
+  // and new ones are added to the end.
+  m_RankSlots.assign(m_SweepOrder.size(), kNoRank);
+  m_SweepOrder.clear();
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    const uint32_t rank = pRanks[i];
+    if (rank < m_RankSlots.size() && m_RankSlots[rank] == kNoRank)
+    {
+      m_RankSlots[rank] = i;
+    }
+    else
+    {
+      pRanks[i] = kNoRank;
+    }
+  }
+  for (uint32_t collider : m_RankSlots)
+  {
+    if (collider != kNoRank)
+    {
+      m_SweepOrder.push_back(collider);
+    }
+  }
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    if (pRanks[i] == kNoRank)
+    {
+      m_SweepOrder.push_back(i);
+    }
+  }
+
+  // Re-sort on the box minimums. Things only move a little between ticks, so
+  // an insertion sort is close to linear. Changing axis needs a full sort.
+  const int axis = FindSweepAxis(bounds);
+  const float *pMin = bounds.min[axis].data();
+  const float *pMax = bounds.max[axis].data();
+  if (axis != m_SweepAxis)
+  {
+    std::sort(m_SweepOrder.begin(), m_SweepOrder.end(),
+              [pMin](uint32_t a, uint32_t b) { return pMin[a] < pMin[b]; });
+    m_SweepAxis = axis;
+  }
+  else
+  {
+    for (size_t k = 1; k < count; ++k)
+    {
+      const uint32_t collider = m_SweepOrder[k];
+      const float key = pMin[collider];
+      size_t j = k;
+      for (; j > 0 && pMin[m_SweepOrder[j - 1]] > key; --j)
+      {
+        m_SweepOrder[j] = m_SweepOrder[j - 1];
+      }
+      m_SweepOrder[j] = collider;
+    }
+  }
+
+  // Sweep: each box can only overlap the boxes starting before it ends.
+  const int otherAxis0 = (axis + 1) % 3;
+  const int otherAxis1 = (axis + 2) % 3;
+  for (size_t k = 0; k < count; ++k)
+  {
+    const uint32_t a = m_SweepOrder[k];
+    pRanks[a] = uint32_t(k);
+
+    for (size_t j = k + 1; j < count && pMin[m_SweepOrder[j]] <= pMax[a]; ++j)
+    {
+      const uint32_t b = m_SweepOrder[j];
+      if (Overlaps(bounds, a, b, otherAxis0) && Overlaps(bounds, a, b, otherAxis1))
+      {
+        pairs.push_back(MakePair(a, b));
+      }
+    }
+  }
+}
+
+void Broadphase::UniformGrid(const ColliderBounds &bounds,
+                             std::vector<CollisionPair> &pairs)
+{
+  const uint32_t count = uint32_t(bounds.GetCount());
+
+  float cellSize = m_CellSize;
+  if (cellSize <= 0.f)
+  {
+    float totalSize = 0.f;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+      totalSize += std::max({bounds.max[0][i] - bounds.min[0][i],
+                             bounds.max[1][i] - bounds.min[1][i],
+                             bounds.max[2][i] - bounds.min[2][i]});
+    }
+    cellSize = (count && totalSize > 0.f) ? 2.f * totalSize / count : 1.f;
+  }
+  const float invCellSize = 1.f / cellSize;
+
+  // Hash every collider into each cell its box covers.
+  m_GridEntries.clear();
+  m_FirstCells.resize(count);
+  m_Oversized.clear();
+  m_IsOversized.assign(count, false);
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    GridCell first, last;
+    int64_t cellCount = 1;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      first.coords[axis] = int32_t(std::floor(bounds.min[axis][i] * invCellSize));
+      last.coords[axis] = int32_t(std::floor(bounds.max[axis][i] * invCellSize));
+      cellCount *= int64_t(last.coords[axis]) - first.coords[axis] + 1;
+    }
+    m_FirstCells[i] = first;
+
+    if (cellCount > kMaxCellsPerCollider)
+    {
+      m_Oversized.push_back(i);
+      m_IsOversized[i] = true;
+      continue;
+    }
+
+    GridEntry entry;
+    entry.collider = i;
+    for (int32_t x = first.coords[0]; x <= last.coords[0]; ++x)
+    {
+      for (int32_t y = first.coords[1]; y <= last.coords[1]; ++y)
+      {
+        for (int32_t z = first.coords[2]; z <= last.coords[2]; ++z)
+        {
+          entry.cell = {{x, y, z}};
+          entry.hash = (uint64_t(uint32_t(x)) * 73856093u) ^
+                       (uint64_t(uint32_t(y)) * 19349663u) ^
+                       (uint64_t(uint32_t(z)) * 83492791u);
+          m_GridEntries.push_back(entry);
+        }
+      }
+    }
+  }
+
+  // Group entries by cell.
+  std::sort(m_GridEntries.begin(), m_GridEntries.end(),
+            [](const GridEntry &a, const GridEntry &b) {
+              if (a.hash != b.hash)
+              {
+                return a.hash < b.hash;
+              }
+              return std::lexicographical_compare(a.cell.coords, a.cell.coords + 3,
+                                                  b.cell.coords, b.cell.coords + 3);
+            });
+
+  // Pair up colliders sharing a cell. Two colliders can share several cells,
+  // so a pair is only reported from the lowest cell they both cover.
+  for (size_t start = 0, end; start < m_GridEntries.size(); start = end)
+  {
+    const GridCell &cell = m_GridEntries[start].cell;
+    for (end = start + 1; end < m_GridEntries.size() && m_GridEntries[end].cell == cell;
+         ++end)
+    {}
+
+    for (size_t j = start; j < end; ++j)
+    {
+      const uint32_t a = m_GridEntries[j].collider;
+      for (size_t k = j + 1; k < end; ++k)
+      {
+        const uint32_t b = m_GridEntries[k].collider;
+        GridCell owner;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+          owner.coords[axis] =
+              std::max(m_FirstCells[a].coords[axis], m_FirstCells[b].coords[axis]);
+        }
+        if (owner == cell && Overlaps(bounds, a, b))
+        {
+          pairs.push_back(MakePair(a, b));
+        }
+      }
+    }
+  }
+
+  for (uint32_t a : m_Oversized)
+  {
+    for (uint32_t b = 0; b < count; ++b)
+    {
+      // Pairs of oversized colliders are checked from the lower index.
+      if ((!m_IsOversized[b] || b > a) && Overlaps(bounds, a, b))
+      {
+        pairs.push_back(MakePair(a, b));
+      }
+    }
+  }
+}
+
+int Broadphase::FindSweepAxis(const ColliderBounds &bounds) const
+{
+  const size_t count = bounds.GetCount();
+  if (!count)
+  {
+    return std::max(m_SweepAxis, 0);
+  }
+
+  float variances[3];
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    float sum = 0.f;
+    float sumSquares = 0.f;
+    for (size_t i = 0; i < count; ++i)
+    {
+      const float center = bounds.min[axis][i] + bounds.max[axis][i];  // Doubled
+      sum += center;
+      sumSquares += center * center;
+    }
+    variances[axis] = sumSquares / count - (sum / count) * (sum / count);
+  }
+
+  const int best = int(std::max_element(variances, variances + 3) - variances);
+  if (m_SweepAxis < 0 || variances[best] > kSweepAxisHysteresis * variances[m_SweepAxis])
+  {
+    return best;
+  }
+  return m_SweepAxis;
+}
+
+}  // namespace tetrad
@@ -0,0 +1,88 @@
+#include "engine/physics/CollisionComponent.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "engine/ecs/EntityManager.h"
+#include "engine/physics/Broadphase.h"
+#include "engine/physics/PhysicsComponent.h"
+#include "engine/transform/TransformComponent.h"
+
+namespace tetrad {
+
+CollisionComponent::CollisionComponent(Entity entity)
+    : IComponent(entity),
+      m_pTransformComp(nullptr),
+      m_pPhysicsComp(nullptr),
+      m_pTouchHandler(nullptr),
+      m_Shape(ECollisionShape::BOX),
+      m_HalfExtents(1.f, 1.f, 1.f),
+      m_SweepRank(Broadphase::kNoRank)
+{}
+
+CollisionComponent::~CollisionComponent() { delete m_pTouchHandler; }
+
+void CollisionComponent::Refresh()
+{
+  m_pTransformComp = EntityManager::GetComponent<TransformComponent>(m_Entity);
+
+  PhysicsComponent *pPhysics = EntityManager::GetComponent<PhysicsComponent>(m_Entity);
+  m_pPhysicsComp = pPhysics->GetID() != 0 ? pPhysics : nullptr;
+}
+
+void CollisionComponent::SetBox(const glm::vec3 &halfExtents)
+{
+  m_Shape = ECollisionShape::BOX;
+  m_HalfExtents = halfExtents;
+}
+
+void CollisionComponent::SetSphere(float radius)
+{
+  m_Shape = ECollisionShape::SPHERE;
+  m_HalfExtents = glm::vec3(radius, radius, radius);
+}
+
+void CollisionComponent::SetTouchHandler(ITouchHandler *pHandler)
+{
+  delete m_pTouchHandler;
+  m_pTouchHandler = pHandler;
+}
+
+void CollisionComponent::AppendBounds(ColliderBounds &bounds) const
+{
+  DEBUG_ASSERT(m_pTransformComp);
+  const glm::vec3 position = m_pTransformComp->GetAbsolutePosition();
+  const glm::vec3 scale = m_pTransformComp->GetAbsoluteScale();
+
+  glm::vec3 halfSize;
+  float radius;
+  if (m_Shape == ECollisionShape::SPHERE)
+  {
+    radius = m_HalfExtents.x * std::max({std::fabs(scale.x), std::fabs(scale.y),
+                                         std::fabs(scale.z)});
+    halfSize = glm::vec3(radius, radius, radius);
+  }
+  else
+  {
+    // Bound the rotated box by projecting its extents onto each world axis.
+    const glm::mat3 rotation =
+        glm::mat3_cast(m_pTransformComp->GetAbsoluteOrientation());
+    const glm::vec3 extents = m_HalfExtents * scale;
+    for (int row = 0; row < 3; ++row)
+    {
+      halfSize[row] = std::fabs(rotation[0][row] * extents.x) +
+                      std::fabs(rotation[1][row] * extents.y) +
+                      std::fabs(rotation[2][row] * extents.z);
+    }
+    radius = 0.f;
+  }
+
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    bounds.min[axis].push_back(position[axis] - halfSize[axis]);
+    bounds.max[axis].push_back(position[axis] + halfSize[axis]);
+  }
+  bounds.radius.push_back(radius);
+}
+
+}  // namespace tetrad
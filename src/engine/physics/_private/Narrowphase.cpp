@@ -0,0 +1,92 @@
+#include "engine/physics/Narrowphase.h"
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NARROWPHASE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace tetrad {
+
+size_t Narrowphase::FilterPairs(const ColliderBounds &bounds, CollisionPair *pPairs,
+                                size_t count)
+{
+  size_t hitCount = 0;
+  size_t i = 0;
+
+#ifdef NARROWPHASE_SSE2
+  const float *pRadius = bounds.radius.data();
+  for (; i + 4 <= count; i += 4)
+  {
+    const CollisionPair pairs[4] = {pPairs[i], pPairs[i + 1], pPairs[i + 2],
+                                    pPairs[i + 3]};
+    auto gather = [&pairs](const float *pValues, bool isA) {
+      return isA ? _mm_setr_ps(pValues[pairs[0].a], pValues[pairs[1].a],
+                               pValues[pairs[2].a], pValues[pairs[3].a])
+                 : _mm_setr_ps(pValues[pairs[0].b], pValues[pairs[1].b],
+                               pValues[pairs[2].b], pValues[pairs[3].b]);
+    };
+
+    const __m128 radiusA = gather(pRadius, true);
+    const __m128 radiusB = gather(pRadius, false);
+
+    // Squared distance between the core boxes, from the gap on each axis
+    __m128 distanceSquared = _mm_setzero_ps();
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      const __m128 minA = _mm_add_ps(gather(bounds.min[axis].data(), true), radiusA);
+      const __m128 maxA = _mm_sub_ps(gather(bounds.max[axis].data(), true), radiusA);
+      const __m128 minB = _mm_add_ps(gather(bounds.min[axis].data(), false), radiusB);
+      const __m128 maxB = _mm_sub_ps(gather(bounds.max[axis].data(), false), radiusB);
+
+      const __m128 gap = _mm_max_ps(_mm_setzero_ps(), _mm_max_ps(_mm_sub_ps(minA, maxB),
+                                                                 _mm_sub_ps(minB, maxA)));
+      distanceSquared = _mm_add_ps(distanceSquared, _mm_mul_ps(gap, gap));
+    }
+
+    const __m128 radiusSum = _mm_add_ps(radiusA, radiusB);
+    const int hits =
+        _mm_movemask_ps(_mm_cmple_ps(distanceSquared, _mm_mul_ps(radiusSum, radiusSum)));
+    for (int lane = 0; lane < 4; ++lane)
+    {
+      if (hits & (1 << lane))
+      {
+        pPairs[hitCount++] = pairs[lane];
+      }
+    }
+  }
+#endif  // NARROWPHASE_SSE2
+
+  for (; i < count; ++i)
+  {
+    if (TestPair(bounds, pPairs[i]))
+    {
+      pPairs[hitCount++] = pPairs[i];
+    }
+  }
+  return hitCount;
+}
+
+bool Narrowphase::TestPair(const ColliderBounds &bounds, const CollisionPair &pair)
+{
+  const float radiusA = bounds.radius[pair.a];
+  const float radiusB = bounds.radius[pair.b];
+
+  float distanceSquared = 0.f;
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    const float minA = bounds.min[axis][pair.a] + radiusA;
+    const float maxA = bounds.max[axis][pair.a] - radiusA;
+    const float minB = bounds.min[axis][pair.b] + radiusB;
+    const float maxB = bounds.max[axis][pair.b] - radiusB;
+
+    const float gap = std::max({0.f, minA - maxB, minB - maxA});
+    distanceSquared += gap * gap;
+  }
+
+  const float radiusSum = radiusA + radiusB;
+  return distanceSquared <= radiusSum * radiusSum;
+}
+
+}  // namespace tetrad
@@ -0,0 +1,385 @@
+#include "engine/physics/PhysicsBodies.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PHYSICS_BODIES_SSE2
+#include <emmintrin.h>
+#endif
+
+#include "core/Log.h"
+#include "engine/physics/Broadphase.h"
+#include "engine/physics/PhysicsComponent.h"
+#include "engine/transform/TransformComponent.h"
+#include "engine/transform/TransformHierarchy.h"
+
+namespace tetrad {
+
+namespace {
+
+// Fraction of awake bodies out of order past which they're sorted again.
+constexpr uint32_t kMaxUnsortedFraction = 8;
+
+/** @brief Reorder the first keys.size() values, by the slot paired with each key. */
+template <typename T>
+void PermuteFront(std::vector<T> &values,
+                  const std::vector<std::pair<uint64_t, uint32_t>> &keys)
+{
+  std::vector<T> sorted(keys.size());
+  for (size_t i = 0; i < keys.size(); ++i)
+  {
+    sorted[i] = values[keys[i].second];
+  }
+  std::copy(sorted.begin(), sorted.end(), values.begin());
+}
+
+}  // namespace
+
+PhysicsBodies::PhysicsBodies() : m_LayoutVersion(0), m_AwakeCount(0), m_UnsortedCount(0)
+{}
+
+void PhysicsBodies::Add(PhysicsComponent &component)
+{
+  const uint32_t index = uint32_t(m_pComponents.size());
+  component.m_BodyIndex = index;
+
+  m_pComponents.push_back(&component);
+  m_pTransforms.push_back(nullptr);
+  m_HierarchyIndices.push_back(TransformHierarchy::kNoParent);
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    m_Velocity[axis].push_back(0.f);
+    m_Movement[axis].push_back(0.f);
+  }
+  m_Gravity.push_back(1.f);
+  m_ImpulseWait.push_back(0.f);
+  m_RestTime.push_back(0.f);
+
+  // New bodies start awake.
+  Swap(index, m_AwakeCount);
+  ++m_AwakeCount;
+}
+
+void PhysicsBodies::Remove(PhysicsComponent &component)
+{
+  uint32_t index = component.m_BodyIndex;
+  DEBUG_ASSERT(m_pComponents[index] == &component);
+
+  // Keep the awake bodies packed at the front.
+  if (IsAwake(index))
+  {
+    --m_AwakeCount;
+    Swap(index, m_AwakeCount);
+    index = m_AwakeCount;
+  }
+  Swap(index, uint32_t(m_pComponents.size() - 1));
+
+  m_pComponents.pop_back();
+  m_pTransforms.pop_back();
+  m_HierarchyIndices.pop_back();
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    m_Velocity[axis].pop_back();
+    m_Movement[axis].pop_back();
+  }
+  m_Gravity.pop_back();
+  m_ImpulseWait.pop_back();
+  m_RestTime.pop_back();
+}
+
+void PhysicsBodies::SetTransform(uint32_t index, TransformComponent *pTransform)
+{
+  m_pTransforms[index] = pTransform;
+  m_HierarchyIndices[index] =
+      pTransform ? pTransform->GetHierarchyIndex() : TransformHierarchy::kNoParent;
+  ++m_UnsortedCount;
+}
+
+void PhysicsBodies::Integrate(deltaTime_t dt)
+{
+  RefreshHierarchyIndices();
+  if (m_UnsortedCount > m_AwakeCount / kMaxUnsortedFraction)
+  {
+    SortAwakeBodies();
+  }
+
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    m_Displacement[axis].resize(m_AwakeCount);
+  }
+
+  IntegrateVelocities(float(dt));
+  WriteBack(float(dt));
+}
+
+void PhysicsBodies::IntegrateVelocities(float dt)
+{
+  const size_t count = m_AwakeCount;
+  const float gravityStep = PhysicsComponent::s_Gravity * dt;
+  const float minVelocityY = -PhysicsComponent::s_TerminalSpeedY;
+  const float sleepSpeed2 = kSleepSpeed * kSleepSpeed;
+
+  float *pVelocityX = m_Velocity[0].data();
+  float *pVelocityY = m_Velocity[1].data();
+  float *pVelocityZ = m_Velocity[2].data();
+  const float *pMovementX = m_Movement[0].data();
+  const float *pMovementY = m_Movement[1].data();
+  const float *pMovementZ = m_Movement[2].data();
+  float *pDisplacementX = m_Displacement[0].data();
+  float *pDisplacementY = m_Displacement[1].data();
+  float *pDisplacementZ = m_Displacement[2].data();
+  const float *pGravity = m_Gravity.data();
+  float *pImpulseWait = m_ImpulseWait.data();
+  float *pRestTime = m_RestTime.data();
+
+  size_t i = 0;
+
+#ifdef PHYSICS_BODIES_SSE2
+  const __m128 zero4 = _mm_setzero_ps();
+  const __m128 dt4 = _mm_set1_ps(dt);
+  const __m128 gravityStep4 = _mm_set1_ps(gravityStep);
+  const __m128 minVelocityY4 = _mm_set1_ps(minVelocityY);
+  const __m128 sleepSpeed24 = _mm_set1_ps(sleepSpeed2);
+  for (; i + 4 <= count; i += 4)
+  {
+    const __m128 impulseWait = _mm_sub_ps(_mm_loadu_ps(pImpulseWait + i), dt4);
+    _mm_storeu_ps(pImpulseWait + i, impulseWait);
+
+    // Gravity only accelerates bodies below terminal speed.
+    const __m128 velocityX = _mm_loadu_ps(pVelocityX + i);
+    __m128 velocityY = _mm_loadu_ps(pVelocityY + i);
+    const __m128 velocityZ = _mm_loadu_ps(pVelocityZ + i);
+    const __m128 gravity = _mm_loadu_ps(pGravity + i);
+    const __m128 gravityDelta = _mm_mul_ps(gravity, gravityStep4);
+    const __m128 isBelowTerminal = _mm_cmpge_ps(velocityY, minVelocityY4);
+    velocityY = _mm_add_ps(velocityY, _mm_and_ps(isBelowTerminal, gravityDelta));
+    _mm_storeu_ps(pVelocityY + i, velocityY);
+
+    _mm_storeu_ps(pDisplacementX + i, _mm_mul_ps(velocityX, dt4));
+    _mm_storeu_ps(pDisplacementY + i, _mm_mul_ps(velocityY, dt4));
+    _mm_storeu_ps(pDisplacementZ + i, _mm_mul_ps(velocityZ, dt4));
+
+    const __m128 speed2 = _mm_add_ps(
+        _mm_add_ps(_mm_mul_ps(velocityX, velocityX), _mm_mul_ps(velocityY, velocityY)),
+        _mm_mul_ps(velocityZ, velocityZ));
+    __m128 isResting = _mm_and_ps(_mm_cmpeq_ps(gravity, zero4),
+                                  _mm_cmplt_ps(speed2, sleepSpeed24));
+    isResting = _mm_and_ps(isResting, _mm_cmple_ps(impulseWait, zero4));
+    isResting = _mm_and_ps(isResting, _mm_cmpeq_ps(_mm_loadu_ps(pMovementX + i), zero4));
+    isResting = _mm_and_ps(isResting, _mm_cmpeq_ps(_mm_loadu_ps(pMovementY + i), zero4));
+    isResting = _mm_and_ps(isResting, _mm_cmpeq_ps(_mm_loadu_ps(pMovementZ + i), zero4));
+    _mm_storeu_ps(pRestTime + i,
+                  _mm_and_ps(isResting, _mm_add_ps(_mm_loadu_ps(pRestTime + i), dt4)));
+  }
+#endif  // PHYSICS_BODIES_SSE2
+
+  for (; i < count; ++i)
+  {
+    pImpulseWait[i] -= dt;
+    if (pVelocityY[i] >= minVelocityY)
+    {
+      pVelocityY[i] += pGravity[i] * gravityStep;
+    }
+
+    pDisplacementX[i] = pVelocityX[i] * dt;
+    pDisplacementY[i] = pVelocityY[i] * dt;
+    pDisplacementZ[i] = pVelocityZ[i] * dt;
+
+    const float speed2 = pVelocityX[i] * pVelocityX[i] + pVelocityY[i] * pVelocityY[i] +
+                         pVelocityZ[i] * pVelocityZ[i];
+    const bool isResting = pGravity[i] == 0.f && speed2 < sleepSpeed2 &&
+                           pImpulseWait[i] <= 0.f && pMovementX[i] == 0.f &&
+                           pMovementY[i] == 0.f && pMovementZ[i] == 0.f;
+    pRestTime[i] = isResting ? pRestTime[i] + dt : 0.f;
+  }
+}
+
+void PhysicsBodies::WriteBack(float dt)
+{
+  const float *ppDisplacement[3] = {m_Displacement[0].data(), m_Displacement[1].data(),
+                                    m_Displacement[2].data()};
+  const float *ppMovement[3] = {m_Movement[0].data(), m_Movement[1].data(),
+                                m_Movement[2].data()};
+
+  // Resting bodies are skipped, so their subtrees aren't recomputed.
+  TransformHierarchy::GetGlobalInstance().Translate(
+      m_HierarchyIndices.data(), ppDisplacement, ppMovement, dt, m_AwakeCount);
+}
+
+void PhysicsBodies::SortAwakeBodies()
+{
+  // Bodies without movement go first. Translate branches on it, so mixing
+  // moving and still bodies costs more than the dirs it reads.
+  m_SortKeys.resize(m_AwakeCount);
+  for (uint32_t i = 0; i < m_AwakeCount; ++i)
+  {
+    m_SortKeys[i] = {uint64_t(HasMovement(i)) << 32 | m_HierarchyIndices[i], i};
+  }
+  std::sort(m_SortKeys.begin(), m_SortKeys.end());
+
+  PermuteFront(m_pComponents, m_SortKeys);
+  PermuteFront(m_pTransforms, m_SortKeys);
+  PermuteFront(m_HierarchyIndices, m_SortKeys);
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    PermuteFront(m_Velocity[axis], m_SortKeys);
+    PermuteFront(m_Movement[axis], m_SortKeys);
+  }
+  PermuteFront(m_Gravity, m_SortKeys);
+  PermuteFront(m_ImpulseWait, m_SortKeys);
+  PermuteFront(m_RestTime, m_SortKeys);
+
+  for (uint32_t i = 0; i < m_AwakeCount; ++i)
+  {
+    m_pComponents[i]->m_BodyIndex = i;
+  }
+  m_UnsortedCount = 0;
+}
+
+void PhysicsBodies::RefreshHierarchyIndices()
+{
+  const TransformHierarchy &hierarchy = TransformHierarchy::GetGlobalInstance();
+  if (m_LayoutVersion == hierarchy.GetLayoutVersion())
+  {
+    return;
+  }
+
+  for (size_t i = 0; i < m_pTransforms.size(); ++i)
+  {
+    if (m_pTransforms[i])
+    {
+      m_HierarchyIndices[i] = m_pTransforms[i]->GetHierarchyIndex();
+    }
+  }
+  m_LayoutVersion = hierarchy.GetLayoutVersion();
+  m_UnsortedCount = m_AwakeCount;
+}
+
+void PhysicsBodies::UpdateSleep(const CollisionPair *pContacts, size_t count)
+{
+  // Group touching bodies into islands. Only awake bodies and those in
+  // contact are looked at, so sleeping islands left alone cost nothing.
+  m_IslandParents.resize(m_pComponents.size());
+  m_IsIslandAwake.resize(m_pComponents.size());
+  for (uint32_t i = 0; i < m_AwakeCount; ++i)
+  {
+    m_IslandParents[i] = i;
+    m_IsIslandAwake[i] = false;
+  }
+  for (size_t i = 0; i < count; ++i)
+  {
+    for (uint32_t index : {pContacts[i].a, pContacts[i].b})
+    {
+      m_IslandParents[index] = index;
+      m_IsIslandAwake[index] = false;
+    }
+  }
+  for (size_t i = 0; i < count; ++i)
+  {
+    const uint32_t a = FindIsland(pContacts[i].a);
+    const uint32_t b = FindIsland(pContacts[i].b);
+    if (a != b)
+    {
+      m_IslandParents[std::max(a, b)] = std::min(a, b);
+    }
+  }
+
+  // An island stays awake as long as any of its bodies isn't ready to sleep.
+  for (uint32_t i = 0; i < m_AwakeCount; ++i)
+  {
+    if (m_RestTime[i] < kTimeToSleep)
+    {
+      m_IsIslandAwake[FindIsland(i)] = true;
+    }
+  }
+
+  // Sleeping and waking moves slots around, so collect the bodies first.
+  m_pToWake.clear();
+  m_pToSleep.clear();
+  for (uint32_t i = 0; i < m_AwakeCount; ++i)
+  {
+    if (!m_IsIslandAwake[FindIsland(i)])
+    {
+      m_pToSleep.push_back(m_pComponents[i]);
+    }
+  }
+  for (size_t i = 0; i < count; ++i)
+  {
+    for (uint32_t index : {pContacts[i].a, pContacts[i].b})
+    {
+      if (!IsAwake(index) && m_IsIslandAwake[FindIsland(index)])
+      {
+        m_pToWake.push_back(m_pComponents[index]);
+      }
+    }
+  }
+
+  for (PhysicsComponent *pComponent : m_pToSleep)
+  {
+    Sleep(pComponent->m_BodyIndex);
+  }
+  for (PhysicsComponent *pComponent : m_pToWake)
+  {
+    Wake(pComponent->m_BodyIndex);
+  }
+}
+
+void PhysicsBodies::Wake(uint32_t index)
+{
+  m_RestTime[index] = 0.f;
+  if (!IsAwake(index))
+  {
+    Swap(index, m_AwakeCount);
+    ++m_AwakeCount;
+  }
+}
+
+void PhysicsBodies::Sleep(uint32_t index)
+{
+  DEBUG_ASSERT(IsAwake(index));
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    m_Velocity[axis][index] = 0.f;
+  }
+
+  --m_AwakeCount;
+  Swap(index, m_AwakeCount);
+}
+
+void PhysicsBodies::Swap(uint32_t a, uint32_t b)
+{
+  if (a == b)
+  {
+    return;
+  }
+
+  std::swap(m_pComponents[a], m_pComponents[b]);
+  m_pComponents[a]->m_BodyIndex = a;
+  m_pComponents[b]->m_BodyIndex = b;
+
+  ++m_UnsortedCount;
+
+  std::swap(m_pTransforms[a], m_pTransforms[b]);
+  std::swap(m_HierarchyIndices[a], m_HierarchyIndices[b]);
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    std::swap(m_Velocity[axis][a], m_Velocity[axis][b]);
+    std::swap(m_Movement[axis][a], m_Movement[axis][b]);
+  }
+  std::swap(m_Gravity[a], m_Gravity[b]);
+  std::swap(m_ImpulseWait[a], m_ImpulseWait[b]);
+  std::swap(m_RestTime[a], m_RestTime[b]);
+}
+
+uint32_t PhysicsBodies::FindIsland(uint32_t index)
+{
+  while (m_IslandParents[index] != index)
+  {
+    m_IslandParents[index] = m_IslandParents[m_IslandParents[index]];
+    index = m_IslandParents[index];
+  }
+  return index;
+}
+
+}  // namespace tetrad
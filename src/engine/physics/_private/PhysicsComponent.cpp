@@ -1,7 +1,8 @@
 #include "engine/physics/PhysicsComponent.h"
 
 #include "engine/ecs/EntityManager.h"
-#include "engine/transform/MovableComponent.h"
+#include "engine/physics/PhysicsBodies.h"
+#include "engine/transform/TransformComponent.h"
 
 namespace tetrad {
 
@@ -15,46 +16,56 @@ float PhysicsComponent::s_TerminalSpeedY = 4.75f;
 float PhysicsComponent::s_ImpulseWaitTime = 0.0f;
 
 PhysicsComponent::PhysicsComponent(Entity entity)
-    : IComponent(entity),
-      m_IsGravityOn(true),
-      m_MovementDir(0),
-      m_MovementSpeed(DEFAULT_MOVEMENT_SPEED),
-      m_ImpulseWait(0.f),
-      m_Velocity(0, 0, 0),
-      m_Movement(0, 0, 0),
-      m_pMover(nullptr)
-{}
-
-void PhysicsComponent::Refresh()
+    : IComponent(entity), m_MovementDir(0), m_MovementSpeed(DEFAULT_MOVEMENT_SPEED)
 {
-  m_pMover = EntityManager::GetComponent<MovableComponent>(m_Entity);
+  PhysicsBodies::GetGlobalInstance().Add(*this);
 }
 
-void PhysicsComponent::Tick(deltaTime_t dt)
+PhysicsComponent::~PhysicsComponent()
 {
-  m_ImpulseWait -= dt;
-
-  if (m_Velocity[1] >= -s_TerminalSpeedY)
-  {
-    m_Velocity[1] += m_IsGravityOn * s_Gravity * dt;
-  }
+  PhysicsBodies::GetGlobalInstance().Remove(*this);
+}
 
-  m_pMover->Move(m_Velocity * dt);
-  m_pMover->Move(m_Movement * dt, EMoveType::LOCAL);
+void PhysicsComponent::Refresh()
+{
+  TransformComponent* pTransform =
+      EntityManager::GetComponent<TransformComponent>(m_Entity);
+  PhysicsBodies::GetGlobalInstance().SetTransform(
+      m_BodyIndex, pTransform->GetID() != 0 ? pTransform : nullptr);
 }
 
 bool PhysicsComponent::Impulse()
 {
-  if (m_ImpulseWait > 0.f)
+  PhysicsBodies& bodies = PhysicsBodies::GetGlobalInstance();
+  float& impulseWait = bodies.GetImpulseWait(m_BodyIndex);
+  if (impulseWait > 0.f)
   {
     return false;
   }
 
-  m_ImpulseWait = s_ImpulseWaitTime;
-  m_Velocity[1] = s_ImpulseSpeed;
+  impulseWait = s_ImpulseWaitTime;
+  glm::vec3 velocity = bodies.GetVelocity(m_BodyIndex);
+  velocity[1] = s_ImpulseSpeed;
+  bodies.SetVelocity(m_BodyIndex, velocity);
   return true;
 }
 
+void PhysicsComponent::SetVelocity(glm::vec3 velocity)
+{
+  PhysicsBodies::GetGlobalInstance().SetVelocity(m_BodyIndex, velocity);
+}
+
+void PhysicsComponent::IncrementVelocity(const glm::vec3& velocity)
+{
+  PhysicsBodies& bodies = PhysicsBodies::GetGlobalInstance();
+  bodies.SetVelocity(m_BodyIndex, bodies.GetVelocity(m_BodyIndex) + velocity);
+}
+
+void PhysicsComponent::SetGravity(bool on)
+{
+  PhysicsBodies::GetGlobalInstance().SetGravity(m_BodyIndex, on);
+}
+
 void PhysicsComponent::UpdateMovement(int direction, bool on)
 {
   // Use m_MovementDir as a 2-element int8_t array
@@ -64,18 +75,15 @@ void PhysicsComponent::UpdateMovement(int direction, bool on)
   moveDir[0] += neg * !(direction & 2);
   moveDir[1] += neg * !!(direction & 2);
 
+  glm::vec3 movement(0, 0, 0);
   if (m_MovementDir != 0)
   {
     int8_t magnitude = abs(moveDir[0]) + abs(moveDir[1]);
-    m_Movement[0] = moveDir[0];
-    m_Movement[2] = moveDir[1];
-    m_Movement *= (m_MovementSpeed / magnitude);
-  }
-  else
-  {
-    m_Movement[0] = 0;
-    m_Movement[2] = 0;
+    movement[0] = moveDir[0];
+    movement[2] = moveDir[1];
+    movement *= (m_MovementSpeed / magnitude);
   }
+  PhysicsBodies::GetGlobalInstance().SetMovement(m_BodyIndex, movement);
 }
 
 }  // namespace tetrad
@@ -1,13 +1,18 @@
 #include "engine/physics/PhysicsSystem.h"
 
+#include <algorithm>
+
 #include "engine/ecs/EntityManager.h"
 #include "engine/game/Game.h"
+#include "engine/physics/CollisionComponent.h"
+#include "engine/physics/Narrowphase.h"
+#include "engine/physics/PhysicsBodies.h"
 #include "engine/physics/PhysicsComponent.h"
 
 namespace tetrad {
 
 PhysicsSystem::PhysicsSystem()
-    : m_pPhysicsComponents(EntityManager::GetAll<PhysicsComponent>())
+    : m_pCollisionComponents(EntityManager::GetAll<CollisionComponent>())
 {}
 
 void PhysicsSystem::Tick(deltaTime_t dt)
@@ -17,9 +22,113 @@ void PhysicsSystem::Tick(deltaTime_t dt)
     return;
   }
 
-  for (size_t i = 1; i < m_pPhysicsComponents.size(); ++i)
+  PhysicsBodies::GetGlobalInstance().Integrate(dt);
+
+  // Sleep is updated before touches are delivered, since handlers may
+  // destroy bodies.
+  const size_t contactCount = DetectCollisions();
+  UpdateSleep(contactCount);
+  DeliverTouches(contactCount);
+}
+
+void PhysicsSystem::SetBroadphase(EBroadphaseType type, float cellSize)
+{
+  m_Broadphase.SetType(type, cellSize);
+}
+
+size_t PhysicsSystem::DetectCollisions()
+{
+  // Collider i of this tick is component i + 1, skipping the null component.
+  m_Bounds.Clear();
+  m_SweepRanks.clear();
+  for (size_t i = 1; i < m_pCollisionComponents.size(); ++i)
+  {
+    m_pCollisionComponents[i]->AppendBounds(m_Bounds);
+    m_SweepRanks.push_back(m_pCollisionComponents[i]->m_SweepRank);
+  }
+  if (m_Bounds.GetCount() < 2)
+  {
+    return 0;
+  }
+
+  m_Broadphase.FindPairs(m_Bounds, m_SweepRanks.data(), m_Pairs);
+  for (size_t i = 1; i < m_pCollisionComponents.size(); ++i)
   {
-    m_pPhysicsComponents[i]->Tick(dt);
+    m_pCollisionComponents[i]->m_SweepRank = m_SweepRanks[i - 1];
+  }
+
+  return Narrowphase::FilterPairs(m_Bounds, m_Pairs.data(), m_Pairs.size());
+}
+
+void PhysicsSystem::UpdateSleep(size_t contactCount)
+{
+  // Only contacts between two bodies can keep them awake.
+  m_BodyContacts.clear();
+  for (size_t i = 0; i < contactCount; ++i)
+  {
+    const PhysicsComponent *pA = m_pCollisionComponents[m_Pairs[i].a + 1]->m_pPhysicsComp;
+    const PhysicsComponent *pB = m_pCollisionComponents[m_Pairs[i].b + 1]->m_pPhysicsComp;
+    if (pA && pB)
+    {
+      m_BodyContacts.push_back({pA->m_BodyIndex, pB->m_BodyIndex});
+    }
+  }
+
+  PhysicsBodies::GetGlobalInstance().UpdateSleep(m_BodyContacts.data(),
+                                                 m_BodyContacts.size());
+}
+
+void PhysicsSystem::DeliverTouches(size_t contactCount)
+{
+  // Group every touch by the collider touched, for those with handlers.
+  m_Touches.clear();
+  for (size_t i = 0; i < contactCount; ++i)
+  {
+    const CollisionPair &pair = m_Pairs[i];
+    if (m_pCollisionComponents[pair.a + 1]->m_pTouchHandler)
+    {
+      m_Touches.push_back(pair);
+    }
+    if (m_pCollisionComponents[pair.b + 1]->m_pTouchHandler)
+    {
+      m_Touches.push_back({pair.b, pair.a});
+    }
+  }
+  std::sort(m_Touches.begin(), m_Touches.end(),
+            [](const CollisionPair &x, const CollisionPair &y) { return x.a < y.a; });
+
+  // Resolve entities up front, since handlers may destroy components.
+  m_TouchedEntities.clear();
+  for (const CollisionPair &touch : m_Touches)
+  {
+    m_TouchedEntities.push_back(m_pCollisionComponents[touch.b + 1]->GetEntity());
+  }
+
+  m_TouchingEntities.clear();
+  m_TouchStarts.clear();
+  for (size_t i = 0; i < m_Touches.size(); ++i)
+  {
+    if (i == 0 || m_Touches[i].a != m_Touches[i - 1].a)
+    {
+      m_TouchingEntities.push_back(
+          m_pCollisionComponents[m_Touches[i].a + 1]->GetEntity());
+      m_TouchStarts.push_back(i);
+    }
+  }
+  m_TouchStarts.push_back(m_Touches.size());
+
+  for (size_t i = 0; i < m_TouchingEntities.size(); ++i)
+  {
+    CollisionComponent *pCollision =
+        EntityManager::GetComponent<CollisionComponent>(m_TouchingEntities[i]);
+    if (pCollision->GetID() == 0 || !pCollision->m_pTouchHandler)
+    {
+      continue;
+    }
+
+    pCollision->m_pTouchHandler->OnTouched(m_TouchingEntities[i],
+                                           m_TouchedEntities.data() + m_TouchStarts[i],
+                                           m_TouchStarts[i + 1] - m_TouchStarts[i]);
   }
 }
 
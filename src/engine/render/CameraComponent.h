@@ -30,15 +30,23 @@ class CameraComponent : public IComponent
   void SetProjectionType(EProjectionType projectionType);
 
   float GetFOV() const { return m_FOV; }
-  void SetFOV(float FOV) { m_FOV = FOV; }
+  void SetFOV(float FOV) { m_FOV = FOV, m_TransformVersion = 0; }
 
   float GetNear() const { return m_Near; }
-  void SetNear(float nearDistance) { m_Near = nearDistance; }
+  void SetNear(float nearDistance) { m_Near = nearDistance, m_TransformVersion = 0; }
 
   float GetFar() const { return m_Far; }
-  void SetFar(float farDistance) { m_Far = farDistance; }
+  void SetFar(float farDistance) { m_Far = farDistance, m_TransformVersion = 0; }
 
-  const glm::mat4 &GetCameraMatrix(float width, float height) const;
+  /** @brief Get the projection times view matrix.
+   *
+   * @param alpha - how far between the last two simulation steps to place the
+   *                camera, which should match what the scene is drawn with
+   */
+  const glm::mat4 &GetCameraMatrix(float width, float height, float alpha) const;
+
+  /** @brief Get the camera's position in world space. */
+  glm::vec3 GetPosition() const;
 
   void Refresh() override;
 
@@ -47,11 +55,16 @@ class CameraComponent : public IComponent
   MovableComponent *m_pMover;
   EProjectionType m_ProjectionType;
   mutable glm::mat4 m_CameraMatrix;
+  // What m_CameraMatrix was built from. Version 0 forces a rebuild.
+  mutable uint32_t m_TransformVersion;
+  mutable glm::vec3 m_Position;
+  mutable float m_Width;
+  mutable float m_Height;
   float m_FOV;
   float m_Near;
   float m_Far;
 
-  friend void CallbackContext::Cursor_3DCamera(GLFWwindow *, double, double);
+  friend void CallbackContext::RotateCamera(float, float);
 };
 
 }  // namespace tetrad
@@ -4,10 +4,12 @@
 #include "core/GlTypes.h"
 #include "core/Reflection.h"
 #include "engine/ecs/IComponent.h"
+#include "engine/resource/ResourceManager.h"
 
 namespace tetrad {
 
 class DrawSystem;
+class SceneQuery;
 class TransformComponent;
 class MaterialComponent;
 
@@ -25,6 +27,7 @@ class DrawComponent : public IComponent
 {
  public:
   DrawComponent(Entity entity);
+  ~DrawComponent();
 
   void SetGeometry(ShapeType shape);
   void SetGeometry(std::string model);
@@ -49,12 +52,13 @@ class DrawComponent : public IComponent
 
   /// Things that a draw system should know about go here
   friend DrawSystem;
+  friend SceneQuery;
   TransformComponent *m_pTransformComp;
   MaterialComponent *m_pMaterialComp;
-  GLuint m_VBO;
-  GLuint m_IBO;
+  ModelResource m_Model;
   GLuint m_Tex;
-  GLsizei m_IndexCount;
+  uint8_t m_Lod;  // LOD drawn last, used for hysteresis
+  uint32_t m_QueryLeaf;  // Slot in SceneQuery
 };
 
 }  // namespace tetrad
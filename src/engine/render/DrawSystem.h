@@ -1,10 +1,21 @@
 #pragma once
 
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
 #include "core/ConstVector.h"
 #include "core/GlTypes.h"
 #include "engine/ecs/System.h"
 #include "engine/render/DrawComponent.h"
+#include "engine/render/GpuTimer.h"
+#include "engine/render/RenderSnapshot.h"
 #include "engine/render/ShaderGlobals.h"
+#include "engine/render/ShaderLibrary.h"
+#include "engine/render/StreamBuffer.h"
+#include "engine/render/TextureArray.h"
 #include "engine/resource/ResourceManager.h"
 
 namespace tetrad {
@@ -21,6 +32,24 @@ class UIViewport;
  * real coupling between OpenGL and non-rendering parts of this
  * software is the use of GLFW as a window manager.
  *
+ * UI elements and text are not drawn one at a time. Instead, they are
+ * appended in render order to a per-frame instance stream, with their
+ * textures mirrored into texture arrays, so that the whole UI layer can be
+ * drawn with a single instanced call.
+ *
+ * The UI can also be retained (@see GameAttributes::m_RetainUi). It is then
+ * drawn into a texture, which is drawn over the world every frame. Each
+ * snapshot's UI quads are compared with the previous snapshot's, and only the
+ * rectangles where they differ are redrawn, so a UI that doesn't change only
+ * costs a full-screen blit.
+ *
+ * Rendering happens on a dedicated thread, which owns the window's GL context.
+ * Each Tick only copies what is needed to draw the frame into a
+ * RenderSnapshot, and hands it over to the render thread. The next frame can
+ * then be simulated while the previous one is being rendered. The game
+ * thread keeps a second context, sharing objects with the first, so that
+ * resources can still be loaded from it.
+ *
  * @TODO Much like with the PhysicsSystem, some sort of space
  * partitioning or sorting could help split up work and/or
  * require less work from the CPU.
@@ -33,17 +62,65 @@ class DrawSystem : public System
   void Tick(deltaTime_t dt) override;
 
  private:
-  void RenderWorld(const Screen &screen, const UIViewport &viewport);
-  void RenderUi(const Screen &screen);
-  void RenderFreeText(const Screen &screen);
-
-  void RenderTextComponent(const Screen &screen, const TextComponent &textComp);
+  //
+  // Game thread
+  //
+  void SnapshotWorld(const Screen &screen, const UIViewport &viewport,
+                     RenderSnapshot &snapshot);
+
+  /** @brief Append all UI elements (and their text) to the snapshot's UI quads. */
+  void SnapshotUi(const Screen &screen, RenderSnapshot &snapshot);
+  /** @brief Append all text not owned by a UI element to the snapshot's UI quads. */
+  void SnapshotFreeText(const Screen &screen, RenderSnapshot &snapshot);
+  void SnapshotTextComponent(const Screen &screen, const TextComponent &textComp,
+                             RenderSnapshot &snapshot);
+  /** @brief Find where the snapshot's UI differs from the previous snapshot's. */
+  void FindUiDirtyRects(RenderSnapshot &snapshot);
+
+  bool StartRenderThread();
+  void StopRenderThread();
+
+  /** @brief Hand the snapshot that was just built over to the render thread.
+   *
+   * Blocks until the render thread is done with the previous snapshot.
+   *
+   * @return false if the render thread failed to start rendering.
+   */
+  bool Publish();
+
+  //
+  // Render thread
+  //
+  void RenderThreadMain();
+  void Render(const RenderSnapshot &snapshot);
+  void RenderWorld(const RenderSnapshot &snapshot, const RenderSnapshot::View &view);
+
+  /** @brief Draw all of the snapshot's UI quads with the UI batch. */
+  void RenderUiBatch(const RenderSnapshot &snapshot);
+  /** @brief Redraw the dirty parts of the UI layer, and draw it over the world. */
+  void RenderRetainedUi(const RenderSnapshot &snapshot);
+  /** @brief (Re)create the UI layer's texture. */
+  bool ResizeUiLayer(GLsizei width, GLsizei height);
+
+  void AppendUiInstance(const RenderSnapshot::UIQuad &quad);
+  /** @brief Upload m_UIBatch, and set up to draw it.
+   *
+   * @param[out] batchOffset - where the batch starts in the stream buffer
+   *
+   * @return false if the stream buffer couldn't fit it.
+   */
+  bool BeginUiBatch(GLintptr &batchOffset);
+  void EndUiBatch();
+  void BindUiPlane();
+  void DrawUiInstances(GLintptr batchOffset, size_t first, size_t count);
 
   // Overrides from System.
   bool OnInitialize() override;
   void OnShutdown() override;
 
+  /** @brief Register shader programs and start compiling their variants. */
   bool SetupShaders();
+  bool LinkShaders();
 
  private:
   ConstVector<DrawComponent *> m_pDrawComponents;
@@ -53,16 +130,76 @@ class DrawSystem : public System
 
   ModelResource m_UIPlane;
 
+  /** @brief Per-instance data for the UI shader.
+   *
+   * Glyphs use the same layout, with m_MultColor holding the text color.
+   */
+  struct UIInstance
+  {
+    glm::mat4 m_MVP;
+    glm::vec4 m_AddColor;
+    glm::vec4 m_MultColor;
+    glm::vec4 m_TopMult;
+    glm::vec4 m_TexRect;  // (x, y, width, height) of the texture in its layer
+    glm::vec4 m_TexInfo;  // (layer, is glyph, unused, unused)
+  };
+
+  std::vector<UIInstance> m_UIBatch;
+
+  // Retained UI. The quads last handed over are only used by the game thread,
+  // and the rest by the render thread.
+  std::vector<RenderSnapshot::UIQuad> m_RetainedUiQuads;
+  uint32_t m_RetainedUiWidth;
+  uint32_t m_RetainedUiHeight;
+
+  struct UIRange
+  {
+    size_t first;
+    size_t count;
+  };
+  std::vector<RenderSnapshot::Rect> m_UIQuadRects;
+  std::vector<UIRange> m_UIDirtyRanges;  // Of m_UIBatch, for each dirty rectangle
+
+  GLuint m_UILayerFramebuffer;
+  GLuint m_UILayerTexture;
+  GLsizei m_UILayerWidth;
+  GLsizei m_UILayerHeight;
+  bool m_HasUiLayerFailed;
+
+  TextureArray m_UITextures;
+  TextureArray m_GlyphTextures;
+
+  ShaderLibrary m_Shaders;
+
   GLuint m_WorldProgram;
   WorldShaderGlobals m_WorldUniforms;
 
   GLuint m_UIProgram;
   UIShaderGlobals m_UIUniforms;
 
-  GLuint m_TextProgram;
-  TextShaderGlobals m_TextUniforms;
+  GLuint m_UILayerProgram;
+  UILayerShaderGlobals m_UILayerUniforms;
 
   GLuint m_DitherTexture;
+
+  StreamBuffer m_StreamBuffer;  // Per-frame dynamic data.
+  GpuTimer m_GpuTimer;
+  std::vector<std::string> m_ViewportPassNames;
+
+  RenderSnapshot m_Snapshots[2];
+  size_t m_WriteIndex;   // Snapshot being built by the game thread
+  size_t m_RenderIndex;  // Snapshot last handed to the render thread
+
+  GLFWwindow *m_pWindow;
+  GLFWwindow *m_pLoaderWindow;  // Hidden window owning the game thread's context
+  GLuint m_LoaderVertexArray;
+
+  std::thread m_RenderThread;
+  std::mutex m_RenderMutex;
+  std::condition_variable m_RenderCondition;
+  bool m_IsRenderPending;  // Guarded by m_RenderMutex, as are the flags below
+  bool m_ShouldStopRendering;
+  bool m_HasRenderFailed;
 };
 
 }  // namespace tetrad
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "core/GlTypes.h"
+#include "core/TimingRegistry.h"
+
+namespace tetrad {
+
+/** @brief Times render passes on the GPU with GL_TIME_ELAPSED queries.
+ *
+ * Queries are double-buffered: the results for a frame are read back two
+ * frames later, right before its queries are reused. Results that still
+ * aren't available by then are dropped rather than waited on, so timing
+ * never stalls the pipeline.
+ *
+ * Results are recorded (in milliseconds) into a TimingRegistry, under the
+ * name of their pass.
+ */
+class GpuTimer
+{
+ public:
+  GpuTimer(TimingRegistry &registry = TimingRegistry::GetGlobalInstance());
+
+  GpuTimer(const GpuTimer &) = delete;
+  GpuTimer &operator=(const GpuTimer &) = delete;
+
+  void Shutdown();
+
+  /** @brief Collect available results. Must be called before any BeginPass. */
+  void BeginFrame();
+  void EndFrame();
+
+  /** @brief Start timing a pass. Passes can't be nested. */
+  void BeginPass(const std::string &name);
+  void EndPass();
+
+ private:
+  static constexpr size_t kBufferCount = 2;
+
+  struct Pass
+  {
+    std::string name;
+    GLuint queries[kBufferCount];
+    bool isPending[kBufferCount];
+  };
+
+ private:
+  TimingRegistry &m_Registry;
+
+  std::vector<Pass> m_Passes;
+  std::unordered_map<std::string, size_t> m_PassIndices;
+
+  size_t m_BufferIndex;
+  bool m_IsInPass;
+};
+
+}  // namespace tetrad
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <vector>
+
+#include "core/BaseTypes.h"
+#include "core/GlTypes.h"
+#include "engine/resource/MeshCooker.h"
+
+namespace tetrad {
+
+/** @brief Everything needed to render one frame, copied out of the game state.
+ *
+ * Built by the DrawSystem on the game thread and then handed to the render
+ * thread, which only reads it. Nothing in here points back into components,
+ * so the game is free to keep changing while a snapshot is being rendered.
+ */
+struct RenderSnapshot
+{
+  struct WorldDraw
+  {
+    GLuint vbo;
+    GLuint ibo;
+    GLenum indexType;
+    MeshCooker::Lod lod;
+    GLuint texture;
+
+    glm::mat4 mvp;
+    glm::vec4 addColor;
+    glm::vec4 multColor;
+    float time;
+  };
+
+  /** @brief A viewport, along with the range of world draws seen through it. */
+  struct View
+  {
+    GLint x;
+    GLint y;
+    GLsizei width;
+    GLsizei height;
+
+    size_t firstDraw;
+    size_t drawCount;
+  };
+
+  /** @brief A UI element or glyph, to be drawn as one quad of the UI batch. */
+  struct UIQuad
+  {
+    glm::mat4 mvp;
+    glm::vec4 addColor;
+    glm::vec4 multColor;
+    glm::vec4 topMult;
+    GLuint texture;
+    bool isGlyph;
+  };
+
+  /** @brief A rectangle of the screen, in pixels from its bottom-left corner. */
+  struct Rect
+  {
+    GLint x;
+    GLint y;
+    GLsizei width;
+    GLsizei height;
+  };
+
+  uint32_t screenWidth;
+  uint32_t screenHeight;
+
+  std::vector<View> views;
+  std::vector<WorldDraw> draws;
+
+  // UI quads in render order. Those from freeTextStart on are free text.
+  std::vector<UIQuad> uiQuads;
+  size_t freeTextStart;
+
+  // With a retained UI layer, the parts of it that changed since the previous
+  // snapshot, and need to be redrawn from uiQuads.
+  bool isUiRetained;
+  std::vector<Rect> uiDirtyRects;
+
+  // Textures deleted by the game thread since the previous snapshot. Their
+  // copies must be dropped before anything is drawn, as the names may be reused.
+  std::vector<GLuint> deletedTextures;
+
+  // Signaled once resources the snapshot uses, uploaded by the game thread,
+  // are visible to the render thread.
+  GLsync uploadFence;
+
+  void Clear()
+  {
+    views.clear();
+    draws.clear();
+    uiQuads.clear();
+    freeTextStart = 0;
+    isUiRetained = false;
+    uiDirtyRects.clear();
+    deletedTextures.clear();
+  }
+};
+
+}  // namespace tetrad
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <vector>
+
+#include "core/BaseTypes.h"
+#include "engine/ecs/Entity.h"
+
+namespace tetrad {
+
+class DrawComponent;
+struct ModelGeometry;
+
+/** @brief Closest intersection found by SceneQuery::RayCast. */
+struct RayHit
+{
+  Entity entity;
+  float distance;  // Along the ray, in units of its direction
+  glm::vec3 position;
+};
+
+/** @brief Ray casts and overlap tests against everything drawn in the world.
+ *
+ * Keeps a bounding volume hierarchy over the world space bounds of every
+ * DrawComponent's mesh. Update brings it up to date once per frame: moved
+ * meshes are refit in place, and the tree is only rebuilt (with a binned SAH)
+ * once refitting has made it much worse, or enough meshes have come and gone.
+ * Until then, new meshes are tested one by one and removed ones are skipped.
+ *
+ * Queries only read the tree, so they can run any number of times a frame
+ * (like on every mouse move). Hits against bounds can optionally be refined
+ * against the actual triangles of the mesh.
+ */
+class SceneQuery
+{
+ public:
+  SceneQuery();
+
+  SceneQuery(const SceneQuery &) = delete;
+  SceneQuery &operator=(const SceneQuery &) = delete;
+
+  void Add(DrawComponent &component);
+  void Remove(DrawComponent &component);
+
+  /** @brief Catch up with meshes that moved, appeared or disappeared. */
+  void Update();
+
+  /** @brief Find the closest mesh hit by a ray.
+   *
+   * @param direction - needn't be normalized. Distances are in its units.
+   * @param maxDistance - ignore hits past this distance
+   * @param refineTriangles - test the mesh triangles, not just their bounds
+   *
+   * @return true if anything was hit, in which case hit is filled in.
+   */
+  bool RayCast(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance,
+               RayHit &hit, bool refineTriangles = true) const;
+
+  /** @brief Find every mesh whose bounds a ray passes through, in no order. */
+  void RayCastAll(const glm::vec3 &origin, const glm::vec3 &direction,
+                  float maxDistance, std::vector<Entity> &entities) const;
+
+  /** @brief Find every mesh whose bounds overlap a world space box. */
+  void Overlap(const glm::vec3 &boxMin, const glm::vec3 &boxMax,
+               std::vector<Entity> &entities) const;
+
+  /** @brief Returns a static instance of SceneQuery. */
+  static SceneQuery &GetGlobalInstance()
+  {
+    static SceneQuery query;
+    return query;
+  }
+
+ private:
+  static constexpr uint32_t kMaxLeafSize = 4;
+  static constexpr uint32_t kBinCount = 12;
+  static constexpr uint32_t kNoVersion = ~0u;
+  // Rebuild once this many leaves (or this fraction of them) aren't in the tree.
+  static constexpr uint32_t kMaxPendingLeaves = 64;
+  static constexpr float kMaxPendingFraction = .125f;
+  static constexpr float kMaxRemovedFraction = .25f;
+  // Rebuild once refitting has made the tree this much more costly to traverse.
+  static constexpr float kMaxRefitCost = 1.5f;
+
+  struct Bounds
+  {
+    glm::vec3 min;
+    glm::vec3 max;
+
+    void Grow(const Bounds &other);
+    float GetArea() const;
+  };
+
+  /** @brief A node of the tree. Leaves have a count, inner nodes don't. */
+  struct Node
+  {
+    Bounds bounds;
+    uint32_t first;  // First leaf for leaves, else the left child
+    uint32_t count;
+  };
+
+  /** @brief A mesh, as of the last Update. */
+  struct Leaf
+  {
+    DrawComponent *pComponent;  // nullptr for removed meshes
+    Entity entity;
+    const ModelGeometry *pGeometry;
+    glm::mat4 worldMatrix;
+    uint32_t worldVersion;
+    Bounds bounds;
+  };
+
+  struct BuildLeaf
+  {
+    Bounds bounds;
+    glm::vec3 center;
+    uint32_t leaf;
+  };
+
+  /** @brief A ray with everything the box tests need precomputed. */
+  struct Ray
+  {
+    glm::vec3 origin;
+    glm::vec3 direction;
+    glm::vec3 inverseDirection;
+    float maxDistance;
+  };
+
+  static Ray MakeRay(const glm::vec3 &origin, const glm::vec3 &direction,
+                     float maxDistance);
+  /** @return The entry distance of the ray into bounds, or a negative number. */
+  static float IntersectBounds(const Ray &ray, const Bounds &bounds);
+  /** @return The distance to the closest triangle of a leaf, or a negative number. */
+  static float IntersectTriangles(const Ray &ray, const Leaf &leaf);
+
+  /** @brief Recompute a leaf's world bounds. */
+  static void UpdateLeaf(Leaf &leaf);
+
+  /** @brief Find the closest hit among some leaves, shortening the ray to it. */
+  const Leaf *RayCastLeaves(const uint32_t *pLeaves, size_t count, Ray &ray,
+                            bool refineTriangles) const;
+
+  /** @brief Drop removed leaves and build a new tree over all the others. */
+  void Rebuild();
+  void BuildNode(uint32_t nodeIndex, uint32_t first, uint32_t count, uint32_t depth);
+  /** @brief Recompute the bounds of every node, returning the tree's SAH cost. */
+  float Refit();
+
+ private:
+  std::vector<Leaf> m_Leaves;
+  std::vector<uint32_t> m_LeafOrder;  // Leaves in tree order, then pending leaves
+  std::vector<Node> m_Nodes;          // Root first, children after their parent
+
+  uint32_t m_TreeLeafCount;  // Leaves from here on were added since the last rebuild
+  uint32_t m_RemovedCount;
+  float m_BuildCost;  // SAH cost right after the last rebuild
+
+  // Scratch space for Rebuild
+  std::vector<BuildLeaf> m_BuildLeaves;
+};
+
+}  // namespace tetrad
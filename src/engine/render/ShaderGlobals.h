@@ -25,12 +25,11 @@ namespace tetrad {
   f(Time)
 
 #define SHADER_UI(f) \
-  f(TopMult)         \
-  f(AddColor)        \
-  f(MultColor)       \
+  f(Texture)         \
+  f(GlyphTexture)    \
   f(DitherTexture)
 
-#define SHADER_TEXT(f) f(TextColor)
+#define SHADER_UI_LAYER(f) f(Texture)
 
 /** @brief Struct containing the globals for all shaders.
  *
@@ -51,20 +50,24 @@ struct WorldShaderGlobals : public BaseShaderGlobals
   SHADER_WORLD(ELEM_TO_SHADER_MEMBER)
 };
 
-/** @brief Struct containing the globals for the UI shader. */
-struct UIShaderGlobals : public BaseShaderGlobals
+/** @brief Struct containing the globals for the UI shader.
+ *
+ * @note Doesn't extend BaseShaderGlobals, since the UI shader is instanced and
+ * gets its transform and material values as vertex attributes instead.
+ */
+struct UIShaderGlobals
 {
   bool GetLocations(GLuint program);
 
   SHADER_UI(ELEM_TO_SHADER_MEMBER)
 };
 
-/** @brief Struct containing the globals for the text shader. */
-struct TextShaderGlobals : public BaseShaderGlobals
+/** @brief Struct containing the globals for the retained UI layer's shader. */
+struct UILayerShaderGlobals
 {
   bool GetLocations(GLuint program);
 
-  SHADER_TEXT(ELEM_TO_SHADER_MEMBER)
+  SHADER_UI_LAYER(ELEM_TO_SHADER_MEMBER)
 };
 
 }  // namespace tetrad
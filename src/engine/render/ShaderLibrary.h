@@ -0,0 +1,79 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "core/GlTypes.h"
+
+namespace tetrad {
+
+class ShaderProgram;
+
+/** @brief Collection of shader programs and their #define variants.
+ *
+ * Programs are registered by name, and each combination of feature defines
+ * used with a program is a separate variant. The variants listed in a
+ * manifest file are compiled up front (in the background where the driver
+ * supports it), while each variant is only linked the first time it's used.
+ *
+ * The manifest is a text file with one variant per line, in the form:
+ *   <program name> [DEFINE...]
+ * Empty lines and lines starting with '#' are ignored.
+ */
+class ShaderLibrary
+{
+ public:
+  typedef std::vector<std::pair<GLenum, std::string>> shaderList_t;
+
+  ShaderLibrary();
+  ~ShaderLibrary();
+
+  ShaderLibrary(const ShaderLibrary &) = delete;
+  ShaderLibrary &operator=(const ShaderLibrary &) = delete;
+
+  /** @brief Register the shader files that make up a program. */
+  void AddProgram(const std::string &name, shaderList_t shaders);
+
+  /** @brief Start compiling every variant listed in the manifest.
+   *
+   * @return false if the manifest can't be read or names unknown programs.
+   */
+  bool LoadManifest(const std::string &manifestPath);
+
+  /** @brief Start compiling a variant, unless it has already been requested.
+   *
+   * @return false if the program is unknown.
+   */
+  bool Request(const std::string &name, std::vector<std::string> defines = {});
+
+  /** @brief Get the program object of a variant, linking it on first use.
+   *
+   * Variants that weren't requested beforehand are compiled on the spot (with
+   * a warning, as they should be added to the manifest).
+   *
+   * @return The program object, or GL_NONE if the variant failed to build.
+   */
+  GLuint Get(const std::string &name, std::vector<std::string> defines = {});
+
+  /** @brief Delete all programs. */
+  void Shutdown();
+
+ private:
+  struct Variant
+  {
+    std::unique_ptr<ShaderProgram> pCompiler;  // Null once linked
+    GLuint program;
+  };
+
+  static std::string GetVariantKey(const std::string &name,
+                                   std::vector<std::string> &defines);
+  Variant *StartVariant(const std::string &name, std::vector<std::string> &defines);
+
+ private:
+  std::unordered_map<std::string, shaderList_t> m_Programs;
+  std::unordered_map<std::string, Variant> m_Variants;
+};
+
+}  // namespace tetrad
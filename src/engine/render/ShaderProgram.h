@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -11,11 +12,18 @@ namespace tetrad {
  *
  * Provides simple interface to add shaders to a program
  * and to compile the final program for use in the DrawSystem.
+ *
+ * When the driver supports program binaries, linked programs are cached on
+ * disk (in SHADER_CACHE_PATH, under the user cache directory), keyed by a hash
+ * of the shader sources and the GL vendor, renderer and version. Cache entries
+ * that are missing, corrupt or rejected by the driver are ignored, and the
+ * program is compiled from source.
  */
 class ShaderProgram
 {
  public:
   ShaderProgram(size_t expectedShaders = 2);
+  ~ShaderProgram();
 
   ShaderProgram(const ShaderProgram&) = delete;
   ShaderProgram(ShaderProgram&&) = delete;
@@ -30,6 +38,29 @@ class ShaderProgram
   /** @brief - Remove the most recently added shader program. */
   void PopShader();
 
+  /** @brief Add a preprocessor definition to every shader in the program.
+   *
+   * @param define - either "NAME" or "NAME VALUE"
+   */
+  void AddDefine(std::string define);
+
+  /** @brief Start compiling the shaders, without waiting for the results.
+   *
+   * With GL_KHR_parallel_shader_compile (or the ARB equivalent) the driver can
+   * compile on background threads until Link is called.
+   *
+   * @return false if the program object couldn't be created
+   */
+  bool StartCompile();
+
+  /** @brief Wait for compilation to finish, then link and return the program.
+   *
+   * Must be preceded by a call to StartCompile.
+   *
+   * @return The program object if no error, else GL_NONE
+   */
+  GLuint Link();
+
   /** @brief Compile and link shaders, then return the program object.
    *
    * @return The program object if no error, else GL_FALSE
@@ -37,11 +68,39 @@ class ShaderProgram
   GLuint Compile();
 
  private:
+  bool StartCompileFromSource();
+  GLuint Finish();
+  GLuint Fail(bool logProgramError);
+
   std::string GetSource(std::string shaderPath);
+  void InsertDefines(std::string& source) const;
   GLuint CompileShader(GLenum shaderType, std::string shaderSource);
+  void DeleteShaders();
+
+  static void EnableParallelCompile();
+
+  static bool IsBinaryCacheSupported();
+  static std::string GetCachePath(uint64_t key);
+  uint64_t GetCacheKey(const std::vector<std::string>& sources) const;
+
+  /** @brief Try to create the program from a cached binary.
+   *
+   * @return The program object if a cached binary exists, else GL_NONE
+   */
+  GLuint LoadCachedProgram(uint64_t key);
+  void SaveCachedProgram(GLuint program, uint64_t key);
 
  private:
   std::vector<std::pair<GLenum, std::string>> m_Shaders;
+  std::vector<std::string> m_Defines;
+
+  // State of the compilation in progress.
+  GLuint m_Program;
+  std::vector<std::string> m_Sources;
+  std::vector<GLuint> m_CompiledShaders;
+  uint64_t m_CacheKey;
+  bool m_UseCache;
+  bool m_IsFromCache;
 };
 
 }  // namespace tetrad
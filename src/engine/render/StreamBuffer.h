@@ -0,0 +1,83 @@
+#pragma once
+
+#include <vector>
+
+#include "core/GlTypes.h"
+
+namespace tetrad {
+
+/** @brief Buffer for streaming per-frame data (instances, quads, etc) to the GPU.
+ *
+ * Each frame, space is handed out linearly from the start of the frame's
+ * region. When ARB_buffer_storage is available, the buffer is persistently
+ * mapped and split into kFrameCount regions, each guarded by a fence, so that
+ * writes go straight to GPU-visible memory and a region is only reused once
+ * the GPU is done reading it. Otherwise (e.g. plain GL 3.3), allocations are
+ * staged in CPU memory and uploaded with glBufferSubData into a buffer that
+ * is orphaned every frame.
+ *
+ * Usage per frame: BeginFrame, then any number of Allocate calls (writing to
+ * the returned pointers), Flush before drawing with the data, and EndFrame.
+ */
+class StreamBuffer
+{
+ public:
+  static constexpr size_t kFrameCount = 3;
+
+  struct Allocation
+  {
+    void *pData;        // Where to write the data, or null if out of space
+    GLintptr offset;    // Offset of the data within the buffer
+  };
+
+  StreamBuffer();
+
+  StreamBuffer(const StreamBuffer &) = delete;
+  StreamBuffer &operator=(const StreamBuffer &) = delete;
+
+  /** @brief Create the buffer.
+   *
+   * @param target - binding point used to upload data (e.g. GL_ARRAY_BUFFER)
+   * @param frameSize - number of bytes available to each frame
+   */
+  bool Initialize(GLenum target, GLsizeiptr frameSize);
+  void Shutdown();
+
+  /** @brief Recreate the buffer with more space per frame.
+   *
+   * @note This invalidates all allocations made during the current frame, so
+   * should be done before allocating anything.
+   */
+  bool Resize(GLsizeiptr frameSize);
+
+  void BeginFrame();
+  void EndFrame();
+
+  /** @brief Get space for size bytes, aligned to alignment (a power of 2). */
+  Allocation Allocate(GLsizeiptr size, GLsizeiptr alignment = 16);
+
+  /** @brief Make all allocations so far visible to the GPU. */
+  void Flush();
+
+  inline GLuint GetID() const { return m_Buffer; }
+  inline GLsizeiptr GetFrameSize() const { return m_FrameSize; }
+  inline bool IsPersistent() const { return m_pMapped != nullptr; }
+
+ private:
+  GLuint m_Buffer;
+  GLenum m_Target;
+  GLsizeiptr m_FrameSize;
+
+  size_t m_FrameIndex;
+  GLsizeiptr m_Offset;       // Offset of the next allocation, within the frame
+  GLsizeiptr m_FlushedSize;  // Bytes already uploaded this frame (fallback only)
+
+  // Persistent mapping.
+  char *m_pMapped;
+  GLsync m_Fences[kFrameCount];
+
+  // Orphaning fallback.
+  std::vector<char> m_Staging;
+};
+
+}  // namespace tetrad
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "core/BaseTypes.h"
+#include "core/GlTypes.h"
+
+namespace tetrad {
+
+/** @brief Texture array that packs regular 2D textures into its layers.
+ *
+ * Used by the DrawSystem so that a whole set of differently-textured quads can
+ * be drawn with a single call. Textures are copied the first time they are
+ * requested (through a framebuffer blit, so no pixel data has to be re-read from
+ * disk) into a free region of a layer, at their own resolution.
+ *
+ * Regions are allocated on shelves: rows of a layer as tall as the first texture
+ * put on them, filled from left to right. A shelf is reused once all of its
+ * regions are released. Layers are added, and made larger to fit big textures,
+ * as needed.
+ *
+ * The null texture (texture name 0) is a single texel at the origin of layer 0,
+ * cleared to opaque black to match what sampling an unbound texture would
+ * produce.
+ */
+class TextureArray
+{
+ public:
+  struct Region
+  {
+    GLint layer;
+    GLint x, y;             // Bottom-left texel of the copy in its layer
+    GLsizei width, height;  // Size of the source texture
+  };
+
+  TextureArray();
+
+  TextureArray(const TextureArray &) = delete;
+  TextureArray &operator=(const TextureArray &) = delete;
+
+  /** @brief Create the underlying GL texture array, with square layers.
+   *
+   * @return true unless the framebuffers used for copying can't be created.
+   */
+  bool Initialize(GLenum internalFormat, GLsizei size, GLsizei layerCapacity = 1);
+  void Shutdown();
+
+  /** @brief Get the region containing a copy of texture, copying it in if needed. */
+  const Region &GetRegion(GLuint texture);
+
+  /** @brief Free the region of a texture, if it has one.
+   *
+   * Must be called once texture is deleted, before its name can be reused.
+   */
+  void Release(GLuint texture);
+
+  inline GLuint GetID() const { return m_Texture; }
+
+ private:
+  struct Shelf
+  {
+    GLint y;
+    GLsizei height;
+    GLsizei usedWidth;
+    uint32_t regionCount;
+  };
+
+  bool Allocate(GLsizei width, GLsizei height, Region &region);
+  bool Reallocate(GLsizei size, GLsizei layerCapacity);
+  GLuint CreateStorage(GLsizei size, GLsizei layerCapacity) const;
+  void Blit(GLint srcLayer, GLuint srcTexture, GLint dstLayer, GLint dstX, GLint dstY,
+            GLsizei width, GLsizei height);
+
+ private:
+  GLuint m_Texture;
+  GLenum m_InternalFormat;
+  GLsizei m_Size;
+  GLsizei m_LayerCapacity;
+
+  GLuint m_ReadFramebuffer;
+  GLuint m_DrawFramebuffer;
+
+  // Shelves of each layer in use, from the bottom up
+  std::vector<std::vector<Shelf>> m_Shelves;
+  std::unordered_map<GLuint, Region> m_Regions;
+};
+
+}  // namespace tetrad
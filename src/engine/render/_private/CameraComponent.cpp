@@ -21,6 +21,10 @@ CameraComponent::CameraComponent(Entity entity)
       m_pTransformComp(nullptr),
       m_pMover(nullptr),
       m_ProjectionType(EPT_PERSPECTIVE),
+      m_TransformVersion(0),
+      m_Position(0, 0, 0),
+      m_Width(0),
+      m_Height(0),
       m_FOV(DEFAULT_FOV),
       m_Near(DEFAULT_NEAR),
       m_Far(DEFAULT_FAR)
@@ -29,33 +33,48 @@ CameraComponent::CameraComponent(Entity entity)
 void CameraComponent::SetProjectionType(EProjectionType projectionType)
 {
   m_ProjectionType = projectionType;
+  m_TransformVersion = 0;
 }
 
 void CameraComponent::Refresh()
 {
   m_pTransformComp = EntityManager::GetComponent<TransformComponent>(m_Entity);
   m_pMover = EntityManager::GetComponent<MovableComponent>(m_Entity);
+  m_TransformVersion = 0;
 }
 
-const glm::mat4& CameraComponent::GetCameraMatrix(float width, float height) const
+glm::vec3 CameraComponent::GetPosition() const
 {
-  // NOTE: This is contingent on the DrawSystem getting the camera
-  // matrix before getting the entity's world matrix. This shouldn't
-  // be an issue, because it makes sense for the DrawSystem to get the
-  // matrices in that order. But it is something to keep in mind when
-  // an entity has both DrawComponent and CameraComponent.
-  if (m_pTransformComp->IsDirty())
+  return m_pTransformComp->GetAbsolutePosition();
+}
+
+const glm::mat4& CameraComponent::GetCameraMatrix(float width, float height,
+                                                 float alpha) const
+{
+  // The position is interpolated like the world is, or the view would move in
+  // fixed step jumps while what it looks at moves smoothly. The orientation
+  // comes straight from the cursor every frame, so it isn't.
+  vec3 cameraPos = m_pTransformComp->GetInterpolatedPosition(alpha);
+
+  // logic for when camera is attached to another entity
+  if (m_pTransformComp->m_pParentTransform)
   {
-    // Generate view matrix
-    const TransformDirs& localDirs = m_pTransformComp->GetLocalDirs();
+    cameraPos += m_pTransformComp->m_pParentTransform->GetInterpolatedPosition(alpha);
+  }
 
-    vec3 cameraPos = m_pTransformComp->GetPosition();
+  // Only rebuild the matrix when the transform (or one of its parents) moved,
+  // or the view changed.
+  const uint32_t version = m_pTransformComp->GetWorldVersion();
+  if (version != m_TransformVersion || cameraPos != m_Position || width != m_Width ||
+      height != m_Height)
+  {
+    m_TransformVersion = version;
+    m_Position = cameraPos;
+    m_Width = width;
+    m_Height = height;
 
-    // logic for when camera is attached to another entity
-    if (m_pTransformComp->m_pParentTransform)
-    {
-      cameraPos += m_pTransformComp->m_pParentTransform->GetPosition();
-    }
+    // Generate view matrix
+    const TransformDirs& localDirs = m_pTransformComp->GetLocalDirs();
 
     m_CameraMatrix = lookAt(cameraPos, cameraPos + localDirs.facingDir, localDirs.upDir);
 
@@ -2,6 +2,7 @@
 
 #include "engine/ecs/EntityManager.h"
 #include "engine/render/MaterialComponent.h"
+#include "engine/render/SceneQuery.h"
 #include "engine/resource/ResourceManager.h"
 #include "engine/transform/TransformComponent.h"
 
@@ -14,26 +15,35 @@ using glm::vec4;
 DrawComponent::DrawComponent(Entity entity)
     : IComponent(entity),
       m_pTransformComp(nullptr),
-      m_VBO(0),
-      m_IBO(0),
+      m_Model{},
       m_Tex(0),
-      m_IndexCount(0)
-{}
+      m_Lod(0)
+{
+  // The null component is never drawn, so it can't be hit either.
+  if (!m_Entity.IsNull())
+  {
+    SceneQuery::GetGlobalInstance().Add(*this);
+  }
+}
+
+DrawComponent::~DrawComponent()
+{
+  if (!m_Entity.IsNull())
+  {
+    SceneQuery::GetGlobalInstance().Remove(*this);
+  }
+}
 
 void DrawComponent::SetGeometry(ShapeType shape)
 {
-  auto model = ResourceManager::LoadShape(shape);
-  m_VBO = model.m_VBO;
-  m_IBO = model.m_IBO;
-  m_IndexCount = model.m_IndexCount;
+  m_Model = ResourceManager::LoadShape(shape);
+  m_Lod = 0;
 }
 
 void DrawComponent::SetGeometry(std::string path)
 {
-  auto model = ResourceManager::LoadModel(path);
-  m_VBO = model.m_VBO;
-  m_IBO = model.m_IBO;
-  m_IndexCount = model.m_IndexCount;
+  m_Model = ResourceManager::LoadModel(path);
+  m_Lod = 0;
 }
 
 void DrawComponent::SetTexture(std::string texture, TextureType type)
@@ -1,21 +1,29 @@
 #include "engine/render/DrawSystem.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtx/transform.hpp>
 
+#include "core/ExitHook.h"
 #include "core/Log.h"
 #include "core/Paths.h"
 #include "core/StlUtils.h"
 #include "engine/ecs/EntityManager.h"
+#include "engine/game/CallbackContext.h"
 #include "engine/game/Game.h"
 #include "engine/render/CameraComponent.h"
 #include "engine/render/MaterialComponent.h"
-#include "engine/render/ShaderProgram.h"
+#include "engine/render/SceneQuery.h"
+#include "engine/render/ShaderLibrary.h"
 #include "engine/resource/Font.h"
 #include "engine/resource/ResourceManager.h"
 #include "engine/screen/Screen.h"
 #include "engine/transform/MovableComponent.h"
 #include "engine/transform/TransformComponent.h"
+#include "engine/transform/TransformHierarchy.h"
 #include "engine/ui/TextComponent.h"
 #include "engine/ui/UI.h"
 
@@ -34,6 +42,134 @@ constexpr auto kDitherPattern = make_array<char>(
     15, 47,  7, 39, 13, 45,  5, 37,
     63, 31, 55, 23, 61, 29, 53, 21);
 // clang-format on
+
+// UIInstance is passed as consecutive vec4 attributes, starting after the
+// regular vertex attributes (the MVP matrix takes up the first four).
+constexpr GLuint kUIInstanceAttribStart = 3;
+constexpr GLuint kUIInstanceAttribCount = 9;
+
+// Per-frame space in the stream buffer. Grown as needed.
+constexpr GLsizeiptr kInitialStreamSize = 64 * 1024;
+
+// LODs are switched to keep their error under this many pixels on screen. To
+// avoid popping back and forth, a coarser LOD is only picked once its error
+// is well under the limit.
+constexpr float kMaxLodPixelError = 1.f;
+constexpr float kLodHysteresis = .25f;
+
+// Dirty rectangles of the retained UI layer redrawn per frame. Past this, they
+// get merged together.
+constexpr size_t kMaxUiDirtyRects = 8;
+
+uint8_t SelectLod(const ModelResource &model, uint8_t currentLod, float pixelsPerError)
+{
+  uint8_t lod = std::min<uint8_t>(currentLod, model.m_LodCount - 1);
+  while (lod + 1 < model.m_LodCount &&
+         model.m_Lods[lod + 1].error * pixelsPerError <
+             kMaxLodPixelError * (1 - kLodHysteresis))
+  {
+    ++lod;
+  }
+  while (lod > 0 && model.m_Lods[lod].error * pixelsPerError > kMaxLodPixelError)
+  {
+    --lod;
+  }
+  return lod;
+}
+
+bool IsSameQuad(const RenderSnapshot::UIQuad &lhs, const RenderSnapshot::UIQuad &rhs)
+{
+  return lhs.mvp == rhs.mvp && lhs.addColor == rhs.addColor &&
+         lhs.multColor == rhs.multColor && lhs.topMult == rhs.topMult &&
+         lhs.texture == rhs.texture && lhs.isGlyph == rhs.isGlyph;
+}
+
+/** @brief Pixels covered by a UI quad, padded by a pixel and clipped to the screen. */
+RenderSnapshot::Rect GetQuadRect(const RenderSnapshot::UIQuad &quad, uint32_t width,
+                                 uint32_t height)
+{
+  // The UI plane spans [0, 1], and is drawn without perspective.
+  glm::vec2 minPos(std::numeric_limits<float>::max());
+  glm::vec2 maxPos(-std::numeric_limits<float>::max());
+  for (int i = 0; i < 4; ++i)
+  {
+    const glm::vec4 corner(float(i & 1), float(i >> 1), 0.f, 1.f);
+    const glm::vec4 pos = quad.mvp * corner;
+    minPos.x = std::min(minPos.x, pos.x);
+    minPos.y = std::min(minPos.y, pos.y);
+    maxPos.x = std::max(maxPos.x, pos.x);
+    maxPos.y = std::max(maxPos.y, pos.y);
+  }
+
+  // From normalized device coordinates to pixels
+  const float sX = std::max(0.f, std::floor((minPos.x + 1) / 2 * width) - 1);
+  const float sY = std::max(0.f, std::floor((minPos.y + 1) / 2 * height) - 1);
+  const float eX = std::min(float(width), std::ceil((maxPos.x + 1) / 2 * width) + 1);
+  const float eY = std::min(float(height), std::ceil((maxPos.y + 1) / 2 * height) + 1);
+  if (sX >= eX || sY >= eY)
+  {
+    return {0, 0, 0, 0};
+  }
+  return {GLint(sX), GLint(sY), GLsizei(eX - sX), GLsizei(eY - sY)};
+}
+
+bool Intersects(const RenderSnapshot::Rect &lhs, const RenderSnapshot::Rect &rhs)
+{
+  return lhs.x < rhs.x + rhs.width && rhs.x < lhs.x + lhs.width &&
+         lhs.y < rhs.y + rhs.height && rhs.y < lhs.y + lhs.height;
+}
+
+RenderSnapshot::Rect Union(const RenderSnapshot::Rect &lhs,
+                           const RenderSnapshot::Rect &rhs)
+{
+  const GLint sX = std::min(lhs.x, rhs.x);
+  const GLint sY = std::min(lhs.y, rhs.y);
+  const GLint eX = std::max(lhs.x + lhs.width, rhs.x + rhs.width);
+  const GLint eY = std::max(lhs.y + lhs.height, rhs.y + rhs.height);
+  return {sX, sY, eX - sX, eY - sY};
+}
+
+int64_t GetArea(const RenderSnapshot::Rect &rect)
+{
+  return int64_t(rect.width) * rect.height;
+}
+
+void AddDirtyRect(std::vector<RenderSnapshot::Rect> &rects,
+                  const RenderSnapshot::Rect &rect)
+{
+  if (rect.width <= 0 || rect.height <= 0)
+  {
+    return;
+  }
+
+  for (RenderSnapshot::Rect &other : rects)
+  {
+    if (Intersects(other, rect))
+    {
+      other = Union(other, rect);
+      return;
+    }
+  }
+  if (rects.size() < kMaxUiDirtyRects)
+  {
+    rects.push_back(rect);
+    return;
+  }
+
+  // Merge with the rectangle that grows the least
+  RenderSnapshot::Rect *pBest = &rects[0];
+  int64_t bestGrowth = std::numeric_limits<int64_t>::max();
+  for (RenderSnapshot::Rect &other : rects)
+  {
+    const int64_t growth = GetArea(Union(other, rect)) - GetArea(other);
+    if (growth < bestGrowth)
+    {
+      pBest = &other;
+      bestGrowth = growth;
+    }
+  }
+  *pBest = Union(*pBest, rect);
+}
 }  // namespace
 
 GLuint vertexArrayID;
@@ -43,8 +179,29 @@ DrawSystem::DrawSystem()
       m_pMaterialComponents(EntityManager::GetAll<MaterialComponent>()),
       m_pTextComponents(EntityManager::GetAll<TextComponent>()),
       m_pViewports(EntityManager::GetAll<UIViewport>()),
-      m_UIPlane(ResourceManager::LoadModel(MODEL_PATH + "UIplane.obj"))
-{}
+      m_UIPlane(ResourceManager::LoadModel(MODEL_PATH + "UIplane.obj")),
+      m_RetainedUiWidth(0),
+      m_RetainedUiHeight(0),
+      m_UILayerFramebuffer(0),
+      m_UILayerTexture(0),
+      m_UILayerWidth(0),
+      m_UILayerHeight(0),
+      m_HasUiLayerFailed(false),
+      m_WorldProgram(GL_NONE),
+      m_UIProgram(GL_NONE),
+      m_UILayerProgram(GL_NONE),
+      m_WriteIndex(0),
+      m_RenderIndex(0),
+      m_pWindow(nullptr),
+      m_pLoaderWindow(nullptr),
+      m_LoaderVertexArray(0),
+      m_IsRenderPending(false),
+      m_ShouldStopRendering(false),
+      m_HasRenderFailed(false)
+{
+  static_assert(sizeof(UIInstance) == kUIInstanceAttribCount * sizeof(glm::vec4),
+                "UIInstance must be tightly packed vec4 attributes");
+}
 
 void DrawSystem::Tick(deltaTime_t dt)
 {
@@ -54,44 +211,57 @@ void DrawSystem::Tick(deltaTime_t dt)
     m_pMaterialComponents[i]->Tick(dt);
   }
 
-  // Clear screen.
-  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-  glUseProgram(m_WorldProgram);
-
-  glEnableVertexAttribArray(0);
-  glEnableVertexAttribArray(1);
-  glEnableVertexAttribArray(2);
+  // Picking and other queries made before the next frame see this one's world.
+  SceneQuery::GetGlobalInstance().Update();
 
-  // TODO - will multiple viewports mess with this?
-  glEnable(GL_DEPTH_TEST);
-  glEnable(GL_CULL_FACE);
+  // The render thread is started on first use, so that everything loaded
+  // during initialization happens on the main context.
+  if (!m_RenderThread.joinable() && !StartRenderThread())
+  {
+    LOG_FATAL("Failed to start the render thread\n");
+    return;
+  }
 
   Screen &currentScreen = m_pGame->GetCurrentScreen();
-  // Render world for each viewport.
-  size_t max = m_pViewports.size();
-  for (size_t view = 1; view < max; ++view)
+  RenderSnapshot &snapshot = m_Snapshots[m_WriteIndex];
+  snapshot.Clear();
+  snapshot.screenWidth = currentScreen.GetWidth();
+  snapshot.screenHeight = currentScreen.GetHeight();
+  ResourceManager::TakeDeletedTextures(snapshot.deletedTextures);
+
+  // Apply this frame's cursor movement right before the camera matrices are
+  // built, so that they're as fresh as possible.
+  CallbackContext::LatchCameraInput();
+
+  // Blend every transform that moved since the last step in one pass, rather
+  // than draw by draw.
+  TransformHierarchy::GetGlobalInstance().Interpolate(m_pGame->GetInterpolationAlpha());
+
+  // Snapshot world for each viewport.
+  for (size_t view = 1; view < m_pViewports.size(); ++view)
   {
     DEBUG_ASSERT(m_pViewports[view]);
-    RenderWorld(currentScreen, *m_pViewports[view]);
+    SnapshotWorld(currentScreen, *m_pViewports[view], snapshot);
   }
-  // Now we've finished rendering on a per-viewport basis. Set the glViewport to
-  // be the entire screen.
-  glViewport(0, 0, currentScreen.GetWidth(), currentScreen.GetHeight());
-
-  RenderUi(currentScreen);
-  RenderFreeText(currentScreen);
 
-  glUseProgram(0);
-  glDisableVertexAttribArray(2);
-  glDisableVertexAttribArray(1);
-  glDisableVertexAttribArray(0);
+  // UI changed by input is laid out once per frame, right before it's drawn.
+  currentScreen.UpdateLayout();
+  SnapshotUi(currentScreen, snapshot);
+  snapshot.freeTextStart = snapshot.uiQuads.size();
+  SnapshotFreeText(currentScreen, snapshot);
+  if (m_pGame->IsUiRetained())
+  {
+    FindUiDirtyRects(snapshot);
+  }
 
-  // Display screen.
-  glfwSwapBuffers(currentScreen.GetWindow());
+  if (!Publish())
+  {
+    LOG_FATAL("Failed to link shaders\n");
+  }
 }
 
-void DrawSystem::RenderWorld(const Screen &screen, const UIViewport &viewport)
+void DrawSystem::SnapshotWorld(const Screen &screen, const UIViewport &viewport,
+                               RenderSnapshot &snapshot)
 {
   screenBound_t bounds = viewport.GetScreenBounds();
   uint32_t w = screen.GetWidth();
@@ -101,67 +271,58 @@ void DrawSystem::RenderWorld(const Screen &screen, const UIViewport &viewport)
   float viewWidth = w * bounds.points[1].X - sX;
   float viewHeight = h * bounds.points[1].Y - sY;
 
-  const glm::mat4 &cameraMat =
-      viewport.GetCamera()->GetCameraMatrix(viewWidth, viewHeight);
+  const CameraComponent *pCamera = viewport.GetCamera();
+  const float alpha = m_pGame->GetInterpolationAlpha();
+  const glm::mat4 &cameraMat = pCamera->GetCameraMatrix(viewWidth, viewHeight, alpha);
 
-  glViewport(sX, sY, viewWidth, viewHeight);
+  // Pixels covered by one unit at a distance of one unit from the camera.
+  const glm::vec3 cameraPos = pCamera->GetPosition();
+  const bool isPerspective =
+      pCamera->GetProjectionType() == CameraComponent::EPT_PERSPECTIVE;
+  const float pixelsPerUnit =
+      isPerspective ? viewHeight / std::abs(2 * std::tan(pCamera->GetFOV() / 2)) : 1.f;
+
+  snapshot.views.push_back({GLint(sX), GLint(sY), GLsizei(viewWidth),
+                            GLsizei(viewHeight), snapshot.draws.size(), 0});
 
   for (size_t i = 1; i < m_pDrawComponents.size(); ++i)
   {
     DEBUG_ASSERT(m_pDrawComponents[i]->m_pTransformComp);
-
-    // Update material globals in shaders.
-    glUniform4fv(m_WorldUniforms.m_AddColorLoc, 1,
-                 &m_pDrawComponents[i]->GetAddColor()[0]);
-    glUniform4fv(m_WorldUniforms.m_MultColorLoc, 1,
-                 &m_pDrawComponents[i]->GetMultColor()[0]);
-    glUniform1f(m_WorldUniforms.m_TimeLoc, m_pDrawComponents[i]->GetTime());
+    DrawComponent &draw = *m_pDrawComponents[i];
+    const ModelResource &model = draw.m_Model;
 
     // Create final MVP matrix.
     //
     // This could be done in the vertex shader, but would result in duplicating
     // this computation for every vertex in a model.
-    static glm::mat4 MVP;
-    MVP = cameraMat * m_pDrawComponents[i]->m_pTransformComp->GetWorldMatrix();
-    glUniformMatrix4fv(m_WorldUniforms.m_WorldLoc, 1, GL_FALSE, &MVP[0][0]);
+    const glm::mat4 &world = draw.m_pTransformComp->GetInterpolatedWorldMatrix();
 
-    glBindBuffer(GL_ARRAY_BUFFER, m_pDrawComponents[i]->m_VBO);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_pDrawComponents[i]->m_IBO);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(DrawComponent::Vertex), 0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(DrawComponent::Vertex),
-                          (const GLvoid *)sizeof(glm::vec3));
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(DrawComponent::Vertex),
-                          (const GLvoid *)(2 * sizeof(glm::vec3)));
-
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, m_pDrawComponents[i]->m_Tex);
-    glUniform1i(m_WorldUniforms.m_TextureLoc, 0);
+    // Pick the level of detail from how large the mesh's error is on screen.
+    if (model.m_LodCount > 1)
+    {
+      float scale = std::max({glm::length(glm::vec3(world[0])),
+                              glm::length(glm::vec3(world[1])),
+                              glm::length(glm::vec3(world[2]))});
+      float pixelsPerError = pixelsPerUnit * scale;
+      if (isPerspective)
+      {
+        float distance = glm::length(glm::vec3(world[3]) - cameraPos);
+        pixelsPerError /= std::max(distance, pCamera->GetNear());
+      }
+      draw.m_Lod = SelectLod(model, draw.m_Lod, pixelsPerError);
+    }
 
-    glDrawElements(GL_TRIANGLES, m_pDrawComponents[i]->m_IndexCount, GL_UNSIGNED_INT, 0);
+    snapshot.draws.push_back({model.m_VBO, model.m_IBO, model.m_IndexType,
+                              model.m_Lods[draw.m_Lod], draw.m_Tex, cameraMat * world,
+                              draw.GetAddColor(), draw.GetMultColor(), draw.GetTime()});
   }
+  snapshot.views.back().drawCount =
+      snapshot.draws.size() - snapshot.views.back().firstDraw;
 }
 
-void DrawSystem::RenderUi(const Screen &screen)
+void DrawSystem::SnapshotUi(const Screen &screen, RenderSnapshot &snapshot)
 {
-  glUseProgram(m_UIProgram);
-  glDisable(GL_DEPTH_TEST);
-  glDisable(GL_CULL_FACE);
-
-  glActiveTexture(GL_TEXTURE1);
-  glBindTexture(GL_TEXTURE_2D, m_DitherTexture);
-  glUniform1i(m_UIUniforms.m_DitherTextureLoc, 1);
-
-  glBindBuffer(GL_ARRAY_BUFFER, m_UIPlane.m_VBO);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_UIPlane.m_IBO);
-
-  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(DrawComponent::Vertex), 0);
-  glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(DrawComponent::Vertex),
-                        (const GLvoid *)sizeof(glm::vec3));
-  glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(DrawComponent::Vertex),
-                        (const GLvoid *)(2 * sizeof(glm::vec3)));
-
-  static glm::mat4 MVP;
-  static glm::mat4 UICameraMat = glm::ortho(0.f, 1.f, 0.f, 1.f, 1.f, 100.f);
+  static const glm::mat4 UICameraMat = glm::ortho(0.f, 1.f, 0.f, 1.f, 1.f, 100.f);
 
   const LinkedList<UIComponent> &uiList = screen.GetRenderList();
   LinkedNode<UIComponent> *pUINode = uiList.First();
@@ -170,32 +331,23 @@ void DrawSystem::RenderUi(const Screen &screen)
     UIComponent *pUI = linked_node_owner(pUINode, UIComponent, m_RenderNode);
     DEBUG_ASSERT(pUI->m_pTransformComp);
 
-    glUniform4fv(m_UIUniforms.m_AddColorLoc, 1, &pUI->m_pMaterialComp->m_AddColor[0]);
-    glUniform4fv(m_UIUniforms.m_MultColorLoc, 1, &pUI->m_pMaterialComp->m_MultColor[0]);
-    glUniform4fv(m_UIUniforms.m_TopMultLoc, 1, &pUI->m_pMaterialComp->m_TopMultiplier[0]);
-
-    MVP = UICameraMat * pUI->m_pTransformComp->GetWorldMatrix();
-    glUniformMatrix4fv(m_UIUniforms.m_WorldLoc, 1, GL_FALSE, &MVP[0][0]);
-
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, pUI->m_CurrTex);
-    glUniform1i(m_UIUniforms.m_TextureLoc, 0);
-
-    glDrawElements(GL_TRIANGLES, m_UIPlane.m_IndexCount, GL_UNSIGNED_INT, 0);
+    const MaterialComponent &material = *pUI->m_pMaterialComp;
+    snapshot.uiQuads.push_back({UICameraMat * pUI->m_pTransformComp->GetWorldMatrix(),
+                                material.m_AddColor, material.m_MultColor,
+                                material.m_TopMultiplier, pUI->m_CurrTex, false});
 
     TextComponent *pText = pUI->m_pTextComp;
     DEBUG_ASSERT(pText);
     if (pText->GetID() != 0)
     {
-      RenderTextComponent(screen, *pText);
-      glUseProgram(m_UIProgram);
+      SnapshotTextComponent(screen, *pText, snapshot);
     }
 
     pUINode = uiList.Next(*pUINode);
   }
 }
 
-void DrawSystem::RenderFreeText(const Screen &screen)
+void DrawSystem::SnapshotFreeText(const Screen &screen, RenderSnapshot &snapshot)
 {
   const LinkedList<TextComponent> &textList = TextComponent::s_FreeTextComps;
   LinkedNode<TextComponent> *pTextNode = textList.First();
@@ -203,32 +355,18 @@ void DrawSystem::RenderFreeText(const Screen &screen)
   {
     TextComponent *pText = linked_node_owner(pTextNode, TextComponent, m_FreeTextNode);
     DEBUG_ASSERT(pText);
-    RenderTextComponent(screen, *pText);
+    SnapshotTextComponent(screen, *pText, snapshot);
 
     pTextNode = textList.Next(*pTextNode);
   }
 }
 
-void DrawSystem::RenderTextComponent(const Screen &screen, const TextComponent &textComp)
+void DrawSystem::SnapshotTextComponent(const Screen &screen, const TextComponent &textComp,
+                                       RenderSnapshot &snapshot)
 {
-  glUseProgram(m_TextProgram);
-  glDisable(GL_DEPTH_TEST);
-  // glUseProgram(m_WorldProgram);
-
-  glBindBuffer(GL_ARRAY_BUFFER, m_UIPlane.m_VBO);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_UIPlane.m_IBO);
-
-  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(DrawComponent::Vertex), 0);
-  glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(DrawComponent::Vertex),
-                        (const GLvoid *)sizeof(glm::vec3));
-  glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(DrawComponent::Vertex),
-                        (const GLvoid *)(2 * sizeof(glm::vec3)));
-  glActiveTexture(GL_TEXTURE0);
-  glUniform1i(m_TextUniforms.m_TextureLoc, 0);
-
   const char *str = textComp.GetText().c_str();
 
-  glUniform4fv(m_TextUniforms.m_TextColorLoc, 1, &textComp.GetColor()[0]);
+  const glm::vec4 &textColor = textComp.GetColor();
 
   const Font &font = textComp.GetFont();
 
@@ -240,7 +378,7 @@ void DrawSystem::RenderTextComponent(const Screen &screen, const TextComponent &
   float scaling = textComp.GetTextScale() * 2.f;
   glm::vec3 scale(scaling / (screen.GetWidth()), scaling / (screen.GetHeight()), 1);
 
-  static glm::mat4 MVP;
+  glm::mat4 MVP;
   char c;
   while ((c = *str))
   {
@@ -253,26 +391,547 @@ void DrawSystem::RenderTextComponent(const Screen &screen, const TextComponent &
       continue;
     }
 
-    // Render current character.
-    MVP[0][0] = charInfo.Size.x * scale.x;                        // width
-    MVP[1][1] = charInfo.Size.y * scale.y;                        // height
-    MVP[3][0] = pos.x + charInfo.Bearing.x * scale.x;             // xpos
-    MVP[3][1] = pos.y - (charInfo.Size.y - charInfo.Bearing.y) *  // ypos
-                            scale.y;
-
-    glUniformMatrix4fv(m_TextUniforms.m_WorldLoc, 1, GL_FALSE, &MVP[0][0]);
-
-    glBindTexture(GL_TEXTURE_2D, charInfo.TextureID);
-    glDrawElements(GL_TRIANGLES, m_UIPlane.m_IndexCount, GL_UNSIGNED_INT, 0);
+    // Batch current character (empty glyphs, like spaces, only advance).
+    if (charInfo.Size.x > 0 && charInfo.Size.y > 0)
+    {
+      MVP[0][0] = charInfo.Size.x * scale.x;                        // width
+      MVP[1][1] = charInfo.Size.y * scale.y;                        // height
+      MVP[3][0] = pos.x + charInfo.Bearing.x * scale.x;             // xpos
+      MVP[3][1] = pos.y - (charInfo.Size.y - charInfo.Bearing.y) *  // ypos
+                              scale.y;
+
+      snapshot.uiQuads.push_back({MVP, glm::vec4(0.f), textColor, glm::vec4(1.f),
+                                  charInfo.TextureID, true});
+    }
 
     // Move forward by however much we need to.
     pos.x += (charInfo.Advance / 64.f) * scale.x;
 
-    // Render next character.
+    // Batch next character.
     ++str;
   }
 }
 
+void DrawSystem::FindUiDirtyRects(RenderSnapshot &snapshot)
+{
+  snapshot.isUiRetained = true;
+  const std::vector<RenderSnapshot::UIQuad> &quads = snapshot.uiQuads;
+  const uint32_t width = snapshot.screenWidth;
+  const uint32_t height = snapshot.screenHeight;
+  std::vector<RenderSnapshot::Rect> &dirtyRects = snapshot.uiDirtyRects;
+
+  // A deleted texture's name may now belong to a different texture, so quads
+  // using it can't be compared.
+  if (width != m_RetainedUiWidth || height != m_RetainedUiHeight ||
+      !snapshot.deletedTextures.empty())
+  {
+    dirtyRects.push_back({0, 0, GLsizei(width), GLsizei(height)});
+  }
+  else
+  {
+    // Where a quad isn't the one drawn in its place last time, whatever is
+    // under either of them may look different.
+    const size_t commonCount = std::min(quads.size(), m_RetainedUiQuads.size());
+    for (size_t i = 0; i < commonCount; ++i)
+    {
+      if (!IsSameQuad(quads[i], m_RetainedUiQuads[i]))
+      {
+        AddDirtyRect(dirtyRects, GetQuadRect(m_RetainedUiQuads[i], width, height));
+        AddDirtyRect(dirtyRects, GetQuadRect(quads[i], width, height));
+      }
+    }
+    for (size_t i = commonCount; i < quads.size(); ++i)
+    {
+      AddDirtyRect(dirtyRects, GetQuadRect(quads[i], width, height));
+    }
+    for (size_t i = commonCount; i < m_RetainedUiQuads.size(); ++i)
+    {
+      AddDirtyRect(dirtyRects, GetQuadRect(m_RetainedUiQuads[i], width, height));
+    }
+  }
+
+  // Every snapshot gets rendered, so this is what the layer will hold next.
+  m_RetainedUiQuads = quads;
+  m_RetainedUiWidth = width;
+  m_RetainedUiHeight = height;
+}
+
+bool DrawSystem::StartRenderThread()
+{
+  m_pWindow = m_pGame->GetCurrentScreen().GetWindow();
+
+  // The game thread keeps a hidden context sharing objects with the main one,
+  // so that resources can still be loaded from it.
+  glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+  m_pLoaderWindow = glfwCreateWindow(1, 1, "", nullptr, m_pWindow);
+  glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+  if (!m_pLoaderWindow)
+  {
+    LOG_ERROR("Failed to create the resource loading context\n");
+    return false;
+  }
+  glfwMakeContextCurrent(m_pLoaderWindow);
+
+  // Vertex arrays aren't shared, and uploading index buffers needs one bound.
+  glGenVertexArrays(1, &m_LoaderVertexArray);
+  glBindVertexArray(m_LoaderVertexArray);
+
+  m_RenderThread = std::thread(&DrawSystem::RenderThreadMain, this);
+  return true;
+}
+
+void DrawSystem::StopRenderThread()
+{
+  if (!m_RenderThread.joinable())
+  {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_RenderMutex);
+    m_ShouldStopRendering = true;
+  }
+  m_RenderCondition.notify_all();
+  m_RenderThread.join();
+
+  // Take the main context back, so that the GL objects can be cleaned up.
+  glDeleteVertexArrays(1, &m_LoaderVertexArray);
+  glfwMakeContextCurrent(m_pWindow);
+  glfwDestroyWindow(m_pLoaderWindow);
+  m_pLoaderWindow = nullptr;
+}
+
+bool DrawSystem::Publish()
+{
+  // Resources uploaded from the game thread may still be in flight, so have
+  // the render thread wait for them before using the snapshot.
+  RenderSnapshot &snapshot = m_Snapshots[m_WriteIndex];
+  snapshot.uploadFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  glFlush();
+
+  // Wait for the previous snapshot to finish rendering, so that its storage
+  // can be reused for the next frame.
+  std::unique_lock<std::mutex> lock(m_RenderMutex);
+  m_RenderCondition.wait(lock, [this] { return !m_IsRenderPending || m_HasRenderFailed; });
+  if (m_HasRenderFailed)
+  {
+    glDeleteSync(snapshot.uploadFence);
+    return false;
+  }
+
+  m_RenderIndex = m_WriteIndex;
+  m_WriteIndex = 1 - m_WriteIndex;
+  m_IsRenderPending = true;
+  lock.unlock();
+  m_RenderCondition.notify_all();
+
+  return true;
+}
+
+void DrawSystem::RenderThreadMain()
+{
+  glfwMakeContextCurrent(m_pWindow);
+
+  // Programs are linked on first use, giving the driver until now to compile.
+  bool isLinked = LinkShaders();
+
+  std::unique_lock<std::mutex> lock(m_RenderMutex);
+  m_HasRenderFailed = !isLinked;
+  while (isLinked)
+  {
+    m_RenderCondition.wait(lock,
+                           [this] { return m_IsRenderPending || m_ShouldStopRendering; });
+    if (!m_IsRenderPending)
+    {
+      break;
+    }
+
+    lock.unlock();
+    Render(m_Snapshots[m_RenderIndex]);
+    lock.lock();
+
+    m_IsRenderPending = false;
+    m_RenderCondition.notify_all();
+  }
+  m_RenderCondition.notify_all();
+  lock.unlock();
+
+  glfwMakeContextCurrent(nullptr);
+}
+
+void DrawSystem::Render(const RenderSnapshot &snapshot)
+{
+  glWaitSync(snapshot.uploadFence, 0, GL_TIMEOUT_IGNORED);
+  glDeleteSync(snapshot.uploadFence);
+
+  // Free the copies of deleted textures, before their names can be reused.
+  for (GLuint texture : snapshot.deletedTextures)
+  {
+    m_UITextures.Release(texture);
+    m_GlyphTextures.Release(texture);
+  }
+
+  m_GpuTimer.BeginFrame();
+  m_StreamBuffer.BeginFrame();
+
+  // Clear screen.
+  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+  glUseProgram(m_WorldProgram);
+
+  glEnableVertexAttribArray(0);
+  glEnableVertexAttribArray(1);
+  glEnableVertexAttribArray(2);
+
+  // TODO - will multiple viewports mess with this?
+  glEnable(GL_DEPTH_TEST);
+  glEnable(GL_CULL_FACE);
+
+  // Render world for each viewport.
+  while (m_ViewportPassNames.size() < snapshot.views.size())
+  {
+    m_ViewportPassNames.push_back("world (viewport " +
+                                  std::to_string(m_ViewportPassNames.size() + 1) + ")");
+  }
+  for (size_t view = 0; view < snapshot.views.size(); ++view)
+  {
+    m_GpuTimer.BeginPass(m_ViewportPassNames[view]);
+    RenderWorld(snapshot, snapshot.views[view]);
+    m_GpuTimer.EndPass();
+  }
+  // Now we've finished rendering on a per-viewport basis. Set the glViewport to
+  // be the entire screen.
+  glViewport(0, 0, snapshot.screenWidth, snapshot.screenHeight);
+
+  if (snapshot.isUiRetained)
+  {
+    RenderRetainedUi(snapshot);
+  }
+  else
+  {
+    RenderUiBatch(snapshot);
+  }
+
+  glUseProgram(0);
+  glDisableVertexAttribArray(2);
+  glDisableVertexAttribArray(1);
+  glDisableVertexAttribArray(0);
+
+  m_StreamBuffer.EndFrame();
+  m_GpuTimer.EndFrame();
+
+  // Display screen.
+  glfwSwapBuffers(m_pWindow);
+}
+
+void DrawSystem::RenderWorld(const RenderSnapshot &snapshot,
+                             const RenderSnapshot::View &view)
+{
+  glViewport(view.x, view.y, view.width, view.height);
+
+  for (size_t i = view.firstDraw; i < view.firstDraw + view.drawCount; ++i)
+  {
+    const RenderSnapshot::WorldDraw &draw = snapshot.draws[i];
+
+    // Update material globals in shaders.
+    glUniform4fv(m_WorldUniforms.m_AddColorLoc, 1, &draw.addColor[0]);
+    glUniform4fv(m_WorldUniforms.m_MultColorLoc, 1, &draw.multColor[0]);
+    glUniform1f(m_WorldUniforms.m_TimeLoc, draw.time);
+    glUniformMatrix4fv(m_WorldUniforms.m_WorldLoc, 1, GL_FALSE, &draw.mvp[0][0]);
+
+    glBindBuffer(GL_ARRAY_BUFFER, draw.vbo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, draw.ibo);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(DrawComponent::Vertex), 0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(DrawComponent::Vertex),
+                          (const GLvoid *)sizeof(glm::vec3));
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(DrawComponent::Vertex),
+                          (const GLvoid *)(2 * sizeof(glm::vec3)));
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, draw.texture);
+    glUniform1i(m_WorldUniforms.m_TextureLoc, 0);
+
+    const size_t indexSize =
+        (draw.indexType == GL_UNSIGNED_SHORT) ? sizeof(uint16_t) : sizeof(uint32_t);
+    glDrawElements(GL_TRIANGLES, draw.lod.indexCount, draw.indexType,
+                   (const GLvoid *)(draw.lod.firstIndex * indexSize));
+  }
+}
+
+void DrawSystem::RenderUiBatch(const RenderSnapshot &snapshot)
+{
+  if (snapshot.uiQuads.empty())
+  {
+    return;
+  }
+
+  m_UIBatch.clear();
+  m_UIBatch.reserve(snapshot.uiQuads.size());
+  for (const RenderSnapshot::UIQuad &quad : snapshot.uiQuads)
+  {
+    AppendUiInstance(quad);
+  }
+
+  GLintptr batchOffset;
+  if (!BeginUiBatch(batchOffset))
+  {
+    return;
+  }
+
+  // UI elements and free text are drawn separately so they can be timed
+  // separately.
+  const size_t freeTextStart = snapshot.freeTextStart;
+  if (freeTextStart > 0)
+  {
+    m_GpuTimer.BeginPass("ui");
+    DrawUiInstances(batchOffset, 0, freeTextStart);
+    m_GpuTimer.EndPass();
+  }
+  if (freeTextStart < m_UIBatch.size())
+  {
+    m_GpuTimer.BeginPass("free text");
+    DrawUiInstances(batchOffset, freeTextStart, m_UIBatch.size() - freeTextStart);
+    m_GpuTimer.EndPass();
+  }
+
+  EndUiBatch();
+}
+
+void DrawSystem::RenderRetainedUi(const RenderSnapshot &snapshot)
+{
+  const GLsizei width = GLsizei(snapshot.screenWidth);
+  const GLsizei height = GLsizei(snapshot.screenHeight);
+  if (width == 0 || height == 0)
+  {
+    return;
+  }
+
+  const RenderSnapshot::Rect screenRect = {0, 0, width, height};
+  const RenderSnapshot::Rect *pDirtyRects = snapshot.uiDirtyRects.data();
+  size_t dirtyRectCount = snapshot.uiDirtyRects.size();
+  if (width != m_UILayerWidth || height != m_UILayerHeight)
+  {
+    if (!ResizeUiLayer(width, height))
+    {
+      RenderUiBatch(snapshot);
+      return;
+    }
+    pDirtyRects = &screenRect;
+    dirtyRectCount = 1;
+  }
+
+  if (dirtyRectCount > 0)
+  {
+    // Batch the quads touching each dirty rectangle, in render order.
+    m_UIQuadRects.clear();
+    for (const RenderSnapshot::UIQuad &quad : snapshot.uiQuads)
+    {
+      m_UIQuadRects.push_back(GetQuadRect(quad, width, height));
+    }
+    m_UIBatch.clear();
+    m_UIDirtyRanges.clear();
+    for (size_t rect = 0; rect < dirtyRectCount; ++rect)
+    {
+      const size_t first = m_UIBatch.size();
+      for (size_t i = 0; i < snapshot.uiQuads.size(); ++i)
+      {
+        if (Intersects(m_UIQuadRects[i], pDirtyRects[rect]))
+        {
+          AppendUiInstance(snapshot.uiQuads[i]);
+        }
+      }
+      m_UIDirtyRanges.push_back({first, m_UIBatch.size() - first});
+    }
+
+    GLintptr batchOffset = 0;
+    const bool hasBatch = !m_UIBatch.empty() && BeginUiBatch(batchOffset);
+    if (!m_UIBatch.empty() && !hasBatch)
+    {
+      // Whatever is dirty now stays blank, so redraw everything next time.
+      m_UILayerWidth = 0;
+    }
+
+    // Blend into the layer with premultiplied alpha, so that drawing it over
+    // the world gives the same result as drawing the UI there directly.
+    glBindFramebuffer(GL_FRAMEBUFFER, m_UILayerFramebuffer);
+    glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE,
+                        GL_ONE_MINUS_SRC_ALPHA);
+    glEnable(GL_SCISSOR_TEST);
+    glClearColor(0.f, 0.f, 0.f, 0.f);
+
+    m_GpuTimer.BeginPass("ui (dirty rects)");
+    for (size_t rect = 0; rect < dirtyRectCount; ++rect)
+    {
+      const RenderSnapshot::Rect &dirtyRect = pDirtyRects[rect];
+      glScissor(dirtyRect.x, dirtyRect.y, dirtyRect.width, dirtyRect.height);
+      glClear(GL_COLOR_BUFFER_BIT);
+
+      const UIRange &range = m_UIDirtyRanges[rect];
+      if (hasBatch && range.count > 0)
+      {
+        DrawUiInstances(batchOffset, range.first, range.count);
+      }
+    }
+    m_GpuTimer.EndPass();
+
+    if (hasBatch)
+    {
+      EndUiBatch();
+    }
+    glClearColor(0.f, 0.f, 0.f, 1.f);
+    glDisable(GL_SCISSOR_TEST);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  }
+
+  // Draw the layer over the world.
+  m_GpuTimer.BeginPass("ui composite");
+  glUseProgram(m_UILayerProgram);
+  glDisable(GL_DEPTH_TEST);
+  glDisable(GL_CULL_FACE);
+
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D, m_UILayerTexture);
+  glUniform1i(m_UILayerUniforms.m_TextureLoc, 0);
+
+  BindUiPlane();
+  glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+  glDrawElements(GL_TRIANGLES, m_UIPlane.m_IndexCount, m_UIPlane.m_IndexType, 0);
+  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  m_GpuTimer.EndPass();
+}
+
+bool DrawSystem::ResizeUiLayer(GLsizei width, GLsizei height)
+{
+  if (m_HasUiLayerFailed)
+  {
+    return false;
+  }
+
+  if (!m_UILayerFramebuffer)
+  {
+    glGenFramebuffers(1, &m_UILayerFramebuffer);
+    glGenTextures(1, &m_UILayerTexture);
+  }
+
+  glBindTexture(GL_TEXTURE_2D, m_UILayerTexture);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+               nullptr);
+
+  glBindFramebuffer(GL_FRAMEBUFFER, m_UILayerFramebuffer);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                         m_UILayerTexture, 0);
+  const bool isComplete =
+      glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+  if (!isComplete)
+  {
+    // Keep drawing the UI straight to the screen instead.
+    LOG_ERROR("Failed to create the retained UI layer\n");
+    m_HasUiLayerFailed = true;
+    return false;
+  }
+
+  m_UILayerWidth = width;
+  m_UILayerHeight = height;
+  return true;
+}
+
+void DrawSystem::AppendUiInstance(const RenderSnapshot::UIQuad &quad)
+{
+  // Resolve textures to texture array regions, copying in new ones.
+  const TextureArray::Region &region = quad.isGlyph
+                                           ? m_GlyphTextures.GetRegion(quad.texture)
+                                           : m_UITextures.GetRegion(quad.texture);
+  const float isGlyph = quad.isGlyph ? 1.f : 0.f;
+  m_UIBatch.push_back({quad.mvp, quad.addColor, quad.multColor, quad.topMult,
+                       glm::vec4(region.x, region.y, region.width, region.height),
+                       glm::vec4(region.layer, isGlyph, 0.f, 0.f)});
+}
+
+bool DrawSystem::BeginUiBatch(GLintptr &batchOffset)
+{
+  glUseProgram(m_UIProgram);
+  glDisable(GL_DEPTH_TEST);
+  glDisable(GL_CULL_FACE);
+
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D_ARRAY, m_UITextures.GetID());
+  glUniform1i(m_UIUniforms.m_TextureLoc, 0);
+
+  glActiveTexture(GL_TEXTURE1);
+  glBindTexture(GL_TEXTURE_2D, m_DitherTexture);
+  glUniform1i(m_UIUniforms.m_DitherTextureLoc, 1);
+
+  glActiveTexture(GL_TEXTURE2);
+  glBindTexture(GL_TEXTURE_2D_ARRAY, m_GlyphTextures.GetID());
+  glUniform1i(m_UIUniforms.m_GlyphTextureLoc, 2);
+
+  BindUiPlane();
+
+  const GLsizeiptr batchSize = m_UIBatch.size() * sizeof(UIInstance);
+  if (batchSize > m_StreamBuffer.GetFrameSize() &&
+      !m_StreamBuffer.Resize(2 * batchSize))
+  {
+    LOG_ERROR("Failed to grow stream buffer for " << m_UIBatch.size()
+                                                  << " UI instances\n");
+    return false;
+  }
+  StreamBuffer::Allocation instances =
+      m_StreamBuffer.Allocate(batchSize, sizeof(glm::vec4));
+  DEBUG_ASSERT(instances.pData);
+  memcpy(instances.pData, &m_UIBatch[0], batchSize);
+  m_StreamBuffer.Flush();
+  glBindBuffer(GL_ARRAY_BUFFER, m_StreamBuffer.GetID());
+  batchOffset = instances.offset;
+
+  for (GLuint i = 0; i < kUIInstanceAttribCount; ++i)
+  {
+    glEnableVertexAttribArray(kUIInstanceAttribStart + i);
+  }
+  return true;
+}
+
+void DrawSystem::EndUiBatch()
+{
+  for (GLuint i = 0; i < kUIInstanceAttribCount; ++i)
+  {
+    glDisableVertexAttribArray(kUIInstanceAttribStart + i);
+  }
+}
+
+void DrawSystem::BindUiPlane()
+{
+  glBindBuffer(GL_ARRAY_BUFFER, m_UIPlane.m_VBO);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_UIPlane.m_IBO);
+
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(DrawComponent::Vertex), 0);
+  glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(DrawComponent::Vertex),
+                        (const GLvoid *)sizeof(glm::vec3));
+  glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(DrawComponent::Vertex),
+                        (const GLvoid *)(2 * sizeof(glm::vec3)));
+}
+
+void DrawSystem::DrawUiInstances(GLintptr batchOffset, size_t first, size_t count)
+{
+  // Without GL 4.2's base instance, the start of the range is selected by
+  // offsetting the instance attributes instead.
+  const size_t offset = batchOffset + first * sizeof(UIInstance);
+  for (GLuint i = 0; i < kUIInstanceAttribCount; ++i)
+  {
+    glVertexAttribPointer(kUIInstanceAttribStart + i, 4, GL_FLOAT, GL_FALSE,
+                          sizeof(UIInstance),
+                          (const GLvoid *)(offset + i * sizeof(glm::vec4)));
+  }
+
+  glDrawElementsInstanced(GL_TRIANGLES, m_UIPlane.m_IndexCount, m_UIPlane.m_IndexType,
+                          0, count);
+}
+
 bool DrawSystem::OnInitialize()
 {
   if (!SetupShaders())
@@ -310,6 +969,25 @@ bool DrawSystem::OnInitialize()
   glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, 8, 8, 0, GL_RED, GL_UNSIGNED_BYTE,
                &kDitherPattern[0]);
 
+  // Setup UI batching. Instance attributes only advance once per UI quad.
+  for (GLuint i = 0; i < kUIInstanceAttribCount; ++i)
+  {
+    glVertexAttribDivisor(kUIInstanceAttribStart + i, 1);
+  }
+
+  if (!m_StreamBuffer.Initialize(GL_ARRAY_BUFFER, kInitialStreamSize))
+  {
+    LOG_ERROR("Failed to create stream buffer\n");
+    return false;
+  }
+
+  if (!m_UITextures.Initialize(GL_SRGB8_ALPHA8, 512) ||
+      !m_GlyphTextures.Initialize(GL_R8, 256))
+  {
+    LOG_ERROR("Failed to create UI texture arrays\n");
+    return false;
+  }
+
   // TODO Enable for wireframe drawing.
   // glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 
@@ -318,20 +996,38 @@ bool DrawSystem::OnInitialize()
 
 void DrawSystem::OnShutdown()
 {
-  glDeleteTextures(1, &m_DitherTexture);
+  StopRenderThread();
 
-  glDeleteProgram(m_WorldProgram);
-  glDeleteProgram(m_UIProgram);
-  glDeleteProgram(m_TextProgram);
+  glDeleteTextures(1, &m_DitherTexture);
+  glDeleteFramebuffers(1, &m_UILayerFramebuffer);
+  glDeleteTextures(1, &m_UILayerTexture);
+  m_StreamBuffer.Shutdown();
+  m_UITextures.Shutdown();
+  m_GlyphTextures.Shutdown();
+  m_GpuTimer.Shutdown();
+
+  m_Shaders.Shutdown();
 }
 
 bool DrawSystem::SetupShaders()
+{
+  m_Shaders.AddProgram("world", {{GL_VERTEX_SHADER, SHADER_PATH + "world-vert.glsl"},
+                                 {GL_FRAGMENT_SHADER, SHADER_PATH + "world-frag.glsl"}});
+  m_Shaders.AddProgram("ui", {{GL_VERTEX_SHADER, SHADER_PATH + "ui-vert.glsl"},
+                              {GL_FRAGMENT_SHADER, SHADER_PATH + "ui-frag.glsl"}});
+  m_Shaders.AddProgram("ui-layer",
+                       {{GL_VERTEX_SHADER, SHADER_PATH + "ui-layer-vert.glsl"},
+                        {GL_FRAGMENT_SHADER, SHADER_PATH + "ui-layer-frag.glsl"}});
+
+  // Start compiling everything we'll need, so that it can happen while the
+  // rest of the game is loading.
+  return m_Shaders.LoadManifest(SHADER_PATH + "variants.txt");
+}
+
+bool DrawSystem::LinkShaders()
 {
   // Setup default shader.
-  ShaderProgram program(2);
-  program.PushShader(GL_VERTEX_SHADER, SHADER_PATH + "world-vert.glsl");
-  program.PushShader(GL_FRAGMENT_SHADER, SHADER_PATH + "world-frag.glsl");
-  m_WorldProgram = program.Compile();
+  m_WorldProgram = m_Shaders.Get("world");
   if (m_WorldProgram == GL_NONE)
   {
     return false;
@@ -343,9 +1039,7 @@ bool DrawSystem::SetupShaders()
   }
 
   // Setup UI shader.
-  program.PopShader();
-  program.PushShader(GL_FRAGMENT_SHADER, SHADER_PATH + "ui-frag.glsl");
-  m_UIProgram = program.Compile();
+  m_UIProgram = m_Shaders.Get("ui");
   if (m_UIProgram == GL_NONE)
   {
     return false;
@@ -356,16 +1050,13 @@ bool DrawSystem::SetupShaders()
     return false;
   }
 
-  // Setup text shader.
-  program.PopShader();
-  program.PushShader(GL_FRAGMENT_SHADER, SHADER_PATH + "text-frag.glsl");
-  m_TextProgram = program.Compile();
-  if (m_TextProgram == GL_NONE)
+  // Setup the shader drawing the retained UI layer.
+  m_UILayerProgram = m_Shaders.Get("ui-layer");
+  if (m_UILayerProgram == GL_NONE)
   {
     return false;
   }
-  // Get text shader uniforms.
-  if (!m_TextUniforms.GetLocations(m_TextProgram))
+  if (!m_UILayerUniforms.GetLocations(m_UILayerProgram))
   {
     return false;
   }
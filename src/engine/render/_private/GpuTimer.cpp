@@ -0,0 +1,80 @@
+#include "engine/render/GpuTimer.h"
+
+#include "core/Log.h"
+
+namespace tetrad {
+
+GpuTimer::GpuTimer(TimingRegistry &registry)
+    : m_Registry(registry), m_BufferIndex(0), m_IsInPass(false)
+{}
+
+void GpuTimer::Shutdown()
+{
+  for (Pass &pass : m_Passes)
+  {
+    glDeleteQueries(kBufferCount, pass.queries);
+  }
+  m_Passes.clear();
+  m_PassIndices.clear();
+}
+
+void GpuTimer::BeginFrame()
+{
+  for (Pass &pass : m_Passes)
+  {
+    if (!pass.isPending[m_BufferIndex])
+    {
+      continue;
+    }
+    pass.isPending[m_BufferIndex] = false;
+
+    GLuint query = pass.queries[m_BufferIndex];
+    GLint isAvailable = GL_FALSE;
+    glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &isAvailable);
+    if (isAvailable)
+    {
+      GLuint64 elapsedNs;
+      glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsedNs);
+      m_Registry.Record(pass.name, elapsedNs / 1e6f);
+    }
+  }
+}
+
+void GpuTimer::EndFrame()
+{
+  DEBUG_ASSERT(!m_IsInPass);
+  m_BufferIndex = (m_BufferIndex + 1) % kBufferCount;
+}
+
+void GpuTimer::BeginPass(const std::string &name)
+{
+  DEBUG_ASSERT(!m_IsInPass);
+
+  auto it = m_PassIndices.find(name);
+  size_t index;
+  if (it != m_PassIndices.end())
+  {
+    index = it->second;
+  }
+  else
+  {
+    index = m_Passes.size();
+    m_PassIndices[name] = index;
+    m_Passes.push_back({name, {}, {}});
+    glGenQueries(kBufferCount, m_Passes.back().queries);
+  }
+
+  Pass &pass = m_Passes[index];
+  glBeginQuery(GL_TIME_ELAPSED, pass.queries[m_BufferIndex]);
+  pass.isPending[m_BufferIndex] = true;
+  m_IsInPass = true;
+}
+
+void GpuTimer::EndPass()
+{
+  DEBUG_ASSERT(m_IsInPass);
+  glEndQuery(GL_TIME_ELAPSED);
+  m_IsInPass = false;
+}
+
+}  // namespace tetrad
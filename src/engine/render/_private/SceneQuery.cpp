@@ -0,0 +1,534 @@
+#include "engine/render/SceneQuery.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "engine/ecs/EntityManager.h"
+#include "engine/render/DrawComponent.h"
+#include "engine/resource/ResourceManager.h"
+#include "engine/transform/TransformComponent.h"
+
+namespace tetrad {
+
+namespace {
+// Traversing a node at depth d needs at most d + 2 stack entries.
+constexpr size_t kMaxStackDepth = 64;
+
+// Below this depth, nodes are split at the median, which halves the leaf count
+// each level. With fewer than 2^32 leaves, that keeps the tree shallow enough
+// for the traversal stacks, however uneven the scene is.
+constexpr uint32_t kMaxSahDepth = kMaxStackDepth - 2 - 32;
+}  // namespace
+
+void SceneQuery::Bounds::Grow(const Bounds &other)
+{
+  min = glm::min(min, other.min);
+  max = glm::max(max, other.max);
+}
+
+float SceneQuery::Bounds::GetArea() const
+{
+  const glm::vec3 size = max - min;
+  return size.x * size.y + size.y * size.z + size.z * size.x;
+}
+
+SceneQuery::SceneQuery() : m_TreeLeafCount(0), m_RemovedCount(0), m_BuildCost(0.f) {}
+
+void SceneQuery::Add(DrawComponent &component)
+{
+  // The transform isn't known yet, so the leaf is filled in by the next Update.
+  component.m_QueryLeaf = uint32_t(m_Leaves.size());
+  m_LeafOrder.push_back(component.m_QueryLeaf);
+  m_Leaves.push_back({&component, component.GetEntity(), nullptr, glm::mat4(1.f),
+                      kNoVersion, {}});
+}
+
+void SceneQuery::Remove(DrawComponent &component)
+{
+  Leaf &leaf = m_Leaves[component.m_QueryLeaf];
+  DEBUG_ASSERT(leaf.pComponent == &component);
+  leaf.pComponent = nullptr;
+  leaf.entity = kNullEntity;
+  ++m_RemovedCount;
+}
+
+void SceneQuery::Update()
+{
+  bool hasMoved = false;
+  for (uint32_t i = 0; i < m_Leaves.size(); ++i)
+  {
+    Leaf &leaf = m_Leaves[i];
+    if (!leaf.pComponent)
+    {
+      continue;
+    }
+
+    if (leaf.worldVersion != leaf.pComponent->m_pTransformComp->GetWorldVersion() ||
+        leaf.pGeometry != leaf.pComponent->m_Model.m_pGeometry)
+    {
+      UpdateLeaf(leaf);
+      hasMoved |= (i < m_TreeLeafCount);
+    }
+  }
+
+  const size_t count = m_Leaves.size();
+  const size_t pendingCount = count - m_TreeLeafCount;
+  if (pendingCount > std::max<size_t>(kMaxPendingLeaves, count * kMaxPendingFraction) ||
+      m_RemovedCount > count * kMaxRemovedFraction)
+  {
+    Rebuild();
+  }
+  else if (hasMoved && Refit() > m_BuildCost * kMaxRefitCost)
+  {
+    Rebuild();
+  }
+}
+
+bool SceneQuery::RayCast(const glm::vec3 &origin, const glm::vec3 &direction,
+                         float maxDistance, RayHit &hit, bool refineTriangles) const
+{
+  Ray ray = MakeRay(origin, direction, maxDistance);
+
+  // Leaves not in the tree yet are tested first, so they can cull the tree.
+  const Leaf *pClosest =
+      RayCastLeaves(m_LeafOrder.data() + m_TreeLeafCount,
+                    m_LeafOrder.size() - m_TreeLeafCount, ray, refineTriangles);
+
+  // Visit nearer children first, so that farther ones can be culled by the
+  // closest hit found so far.
+  uint32_t stack[kMaxStackDepth];
+  size_t stackSize = 0;
+  if (!m_Nodes.empty() && IntersectBounds(ray, m_Nodes[0].bounds) >= 0.f)
+  {
+    stack[stackSize++] = 0;
+  }
+  while (stackSize > 0)
+  {
+    const Node &node = m_Nodes[stack[--stackSize]];
+    if (node.count > 0)
+    {
+      const Leaf *pLeaf =
+          RayCastLeaves(&m_LeafOrder[node.first], node.count, ray, refineTriangles);
+      pClosest = pLeaf ? pLeaf : pClosest;
+      continue;
+    }
+
+    const float leftDistance = IntersectBounds(ray, m_Nodes[node.first].bounds);
+    const float rightDistance = IntersectBounds(ray, m_Nodes[node.first + 1].bounds);
+    const bool isRightFirst = rightDistance >= 0.f &&
+                              (leftDistance < 0.f || rightDistance < leftDistance);
+    const uint32_t nearChild = isRightFirst ? node.first + 1 : node.first;
+    const uint32_t farChild = isRightFirst ? node.first : node.first + 1;
+    const float farDistance = isRightFirst ? leftDistance : rightDistance;
+
+    DEBUG_ASSERT(stackSize + 2 <= kMaxStackDepth);
+    if (farDistance >= 0.f)
+    {
+      stack[stackSize++] = farChild;
+    }
+    if (std::max(leftDistance, rightDistance) >= 0.f)
+    {
+      stack[stackSize++] = nearChild;
+    }
+  }
+
+  if (!pClosest)
+  {
+    return false;
+  }
+  hit.entity = pClosest->entity;
+  hit.distance = ray.maxDistance;
+  hit.position = origin + direction * ray.maxDistance;
+  return true;
+}
+
+void SceneQuery::RayCastAll(const glm::vec3 &origin, const glm::vec3 &direction,
+                            float maxDistance, std::vector<Entity> &entities) const
+{
+  const Ray ray = MakeRay(origin, direction, maxDistance);
+  const auto appendHits = [&](uint32_t first, uint32_t count) {
+    for (uint32_t i = first; i < first + count; ++i)
+    {
+      const Leaf &leaf = m_Leaves[m_LeafOrder[i]];
+      if (leaf.pComponent && IntersectBounds(ray, leaf.bounds) >= 0.f)
+      {
+        entities.push_back(leaf.entity);
+      }
+    }
+  };
+
+  entities.clear();
+  appendHits(m_TreeLeafCount, uint32_t(m_LeafOrder.size()) - m_TreeLeafCount);
+
+  uint32_t stack[kMaxStackDepth];
+  size_t stackSize = 0;
+  if (!m_Nodes.empty())
+  {
+    stack[stackSize++] = 0;
+  }
+  while (stackSize > 0)
+  {
+    const Node &node = m_Nodes[stack[--stackSize]];
+    if (IntersectBounds(ray, node.bounds) < 0.f)
+    {
+      continue;
+    }
+
+    if (node.count > 0)
+    {
+      appendHits(node.first, node.count);
+      continue;
+    }
+
+    DEBUG_ASSERT(stackSize + 2 <= kMaxStackDepth);
+    stack[stackSize++] = node.first;
+    stack[stackSize++] = node.first + 1;
+  }
+}
+
+void SceneQuery::Overlap(const glm::vec3 &boxMin, const glm::vec3 &boxMax,
+                         std::vector<Entity> &entities) const
+{
+  const auto overlaps = [&](const Bounds &bounds) {
+    return glm::all(glm::lessThanEqual(bounds.min, boxMax)) &&
+           glm::all(glm::lessThanEqual(boxMin, bounds.max));
+  };
+  const auto appendOverlaps = [&](uint32_t first, uint32_t count) {
+    for (uint32_t i = first; i < first + count; ++i)
+    {
+      const Leaf &leaf = m_Leaves[m_LeafOrder[i]];
+      if (leaf.pComponent && overlaps(leaf.bounds))
+      {
+        entities.push_back(leaf.entity);
+      }
+    }
+  };
+
+  entities.clear();
+  appendOverlaps(m_TreeLeafCount, uint32_t(m_LeafOrder.size()) - m_TreeLeafCount);
+
+  uint32_t stack[kMaxStackDepth];
+  size_t stackSize = 0;
+  if (!m_Nodes.empty())
+  {
+    stack[stackSize++] = 0;
+  }
+  while (stackSize > 0)
+  {
+    const Node &node = m_Nodes[stack[--stackSize]];
+    if (!overlaps(node.bounds))
+    {
+      continue;
+    }
+
+    if (node.count > 0)
+    {
+      appendOverlaps(node.first, node.count);
+      continue;
+    }
+
+    DEBUG_ASSERT(stackSize + 2 <= kMaxStackDepth);
+    stack[stackSize++] = node.first;
+    stack[stackSize++] = node.first + 1;
+  }
+}
+
+const SceneQuery::Leaf *SceneQuery::RayCastLeaves(const uint32_t *pLeaves, size_t count,
+                                                  Ray &ray, bool refineTriangles) const
+{
+  const Leaf *pClosest = nullptr;
+  for (size_t i = 0; i < count; ++i)
+  {
+    const Leaf &leaf = m_Leaves[pLeaves[i]];
+    if (!leaf.pComponent)
+    {
+      continue;
+    }
+
+    float distance = IntersectBounds(ray, leaf.bounds);
+    if (distance >= 0.f && refineTriangles && leaf.pGeometry)
+    {
+      distance = IntersectTriangles(ray, leaf);
+    }
+    if (distance >= 0.f)
+    {
+      ray.maxDistance = distance;
+      pClosest = &leaf;
+    }
+  }
+  return pClosest;
+}
+
+SceneQuery::Ray SceneQuery::MakeRay(const glm::vec3 &origin, const glm::vec3 &direction,
+                                    float maxDistance)
+{
+  // Axes the ray doesn't move along get an infinite inverse, which the slab
+  // test handles as long as the origin isn't exactly on a slab plane.
+  return {origin, direction, 1.f / direction, maxDistance};
+}
+
+float SceneQuery::IntersectBounds(const Ray &ray, const Bounds &bounds)
+{
+  const glm::vec3 t0 = (bounds.min - ray.origin) * ray.inverseDirection;
+  const glm::vec3 t1 = (bounds.max - ray.origin) * ray.inverseDirection;
+  const glm::vec3 tNear = glm::min(t0, t1);
+  const glm::vec3 tFar = glm::max(t0, t1);
+
+  const float enter = std::max({tNear.x, tNear.y, tNear.z, 0.f});
+  const float exit = std::min({tFar.x, tFar.y, tFar.z, ray.maxDistance});
+  return enter <= exit ? enter : -1.f;
+}
+
+float SceneQuery::IntersectTriangles(const Ray &ray, const Leaf &leaf)
+{
+  // Distances along a ray are unchanged by moving it to model space, as long
+  // as its direction isn't renormalized.
+  const glm::mat4 toModel = glm::inverse(leaf.worldMatrix);
+  const glm::vec3 origin = glm::vec3(toModel * glm::vec4(ray.origin, 1.f));
+  const glm::vec3 direction = glm::vec3(toModel * glm::vec4(ray.direction, 0.f));
+
+  // Möller-Trumbore, keeping the closest hit.
+  const std::vector<glm::vec3> &positions = leaf.pGeometry->positions;
+  const std::vector<uint32_t> &indices = leaf.pGeometry->indices;
+  float closest = -1.f;
+  float maxDistance = ray.maxDistance;
+  for (size_t i = 0; i + 2 < indices.size(); i += 3)
+  {
+    const glm::vec3 &p0 = positions[indices[i]];
+    const glm::vec3 edge1 = positions[indices[i + 1]] - p0;
+    const glm::vec3 edge2 = positions[indices[i + 2]] - p0;
+
+    const glm::vec3 p = glm::cross(direction, edge2);
+    const float determinant = glm::dot(edge1, p);
+    if (std::fabs(determinant) < std::numeric_limits<float>::epsilon())
+    {
+      continue;
+    }
+    const float inverseDeterminant = 1.f / determinant;
+
+    const glm::vec3 s = origin - p0;
+    const float u = glm::dot(s, p) * inverseDeterminant;
+    if (u < 0.f || u > 1.f)
+    {
+      continue;
+    }
+    const glm::vec3 q = glm::cross(s, edge1);
+    const float v = glm::dot(direction, q) * inverseDeterminant;
+    if (v < 0.f || u + v > 1.f)
+    {
+      continue;
+    }
+
+    const float distance = glm::dot(edge2, q) * inverseDeterminant;
+    if (distance >= 0.f && distance <= maxDistance)
+    {
+      closest = maxDistance = distance;
+    }
+  }
+  return closest;
+}
+
+void SceneQuery::UpdateLeaf(Leaf &leaf)
+{
+  const TransformComponent *pTransform = leaf.pComponent->m_pTransformComp;
+  const ModelResource &model = leaf.pComponent->m_Model;
+  leaf.pGeometry = model.m_pGeometry;
+  leaf.worldMatrix = pTransform->GetWorldMatrix();
+  leaf.worldVersion = pTransform->GetWorldVersion();
+
+  // Bound the transformed model bounds by their transformed center and the
+  // absolute values of the transform.
+  const glm::vec3 center = (model.m_BoundsMin + model.m_BoundsMax) * .5f;
+  const glm::vec3 extent = (model.m_BoundsMax - model.m_BoundsMin) * .5f;
+  const glm::vec3 worldCenter = glm::vec3(leaf.worldMatrix * glm::vec4(center, 1.f));
+  glm::vec3 worldExtent(0.f, 0.f, 0.f);
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    worldExtent += glm::abs(glm::vec3(leaf.worldMatrix[axis])) * extent[axis];
+  }
+  leaf.bounds = {worldCenter - worldExtent, worldCenter + worldExtent};
+}
+
+void SceneQuery::Rebuild()
+{
+  // Compact away removed leaves.
+  uint32_t count = 0;
+  for (uint32_t i = 0; i < m_Leaves.size(); ++i)
+  {
+    if (m_Leaves[i].pComponent)
+    {
+      m_Leaves[count] = m_Leaves[i];
+      m_Leaves[count].pComponent->m_QueryLeaf = count;
+      ++count;
+    }
+  }
+  m_Leaves.resize(count);
+  m_RemovedCount = 0;
+  m_TreeLeafCount = count;
+
+  m_Nodes.clear();
+  m_LeafOrder.resize(count);
+  if (count == 0)
+  {
+    return;
+  }
+
+  // Sort compact copies of the leaves, rather than indices into the larger
+  // leaves, so the build walks memory in order.
+  m_BuildLeaves.resize(count);
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    const Bounds &bounds = m_Leaves[i].bounds;
+    m_BuildLeaves[i] = {bounds, (bounds.min + bounds.max) * .5f, i};
+  }
+
+  // Children are allocated in pairs, so there are at most 2n - 1 nodes.
+  m_Nodes.reserve(2 * count - 1);
+  m_Nodes.push_back({});
+  BuildNode(0, 0, count, 0);
+
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    m_LeafOrder[i] = m_BuildLeaves[i].leaf;
+  }
+
+  m_BuildCost = Refit();
+}
+
+void SceneQuery::BuildNode(uint32_t nodeIndex, uint32_t first, uint32_t count,
+                           uint32_t depth)
+{
+  m_Nodes[nodeIndex].first = first;
+  m_Nodes[nodeIndex].count = count;
+  if (count <= kMaxLeafSize)
+  {
+    return;
+  }
+
+  // Split along the axis the centers are most spread out on.
+  BuildLeaf *pLeaves = &m_BuildLeaves[first];
+  Bounds centerBounds = {pLeaves[0].center, pLeaves[0].center};
+  for (uint32_t i = 1; i < count; ++i)
+  {
+    centerBounds.Grow({pLeaves[i].center, pLeaves[i].center});
+  }
+  const glm::vec3 spread = centerBounds.max - centerBounds.min;
+  const int axis = (spread.x >= spread.y && spread.x >= spread.z)
+                       ? 0
+                       : (spread.y >= spread.z ? 1 : 2);
+
+  uint32_t splitCount = 0;
+  if (spread[axis] > 0.f && depth < kMaxSahDepth)
+  {
+    // Bin the centers, then pick the split with the lowest surface area cost.
+    struct Bin
+    {
+      Bounds bounds;
+      uint32_t count;
+    } bins[kBinCount] = {};
+    const float binScale = kBinCount / spread[axis] * (1.f - 1e-5f);
+    const auto getBin = [&](const BuildLeaf &leaf) {
+      return uint32_t((leaf.center[axis] - centerBounds.min[axis]) * binScale);
+    };
+    for (uint32_t i = 0; i < count; ++i)
+    {
+      Bin &bin = bins[getBin(pLeaves[i])];
+      bin.bounds = bin.count ? bin.bounds : pLeaves[i].bounds;
+      bin.bounds.Grow(pLeaves[i].bounds);
+      ++bin.count;
+    }
+
+    float rightAreas[kBinCount];
+    Bounds right = bins[kBinCount - 1].bounds;
+    uint32_t rightCount = 0;
+    for (uint32_t i = kBinCount - 1; i > 0; --i)
+    {
+      if (bins[i].count)
+      {
+        right = rightCount ? right : bins[i].bounds;
+        right.Grow(bins[i].bounds);
+        rightCount += bins[i].count;
+      }
+      rightAreas[i] = rightCount ? right.GetArea() * rightCount : 0.f;
+    }
+
+    float bestCost = std::numeric_limits<float>::max();
+    uint32_t bestBin = 0;
+    Bounds left = bins[0].bounds;
+    uint32_t leftCount = 0;
+    for (uint32_t i = 0; i + 1 < kBinCount; ++i)
+    {
+      if (bins[i].count)
+      {
+        left = leftCount ? left : bins[i].bounds;
+        left.Grow(bins[i].bounds);
+        leftCount += bins[i].count;
+      }
+      const float leftArea = leftCount ? left.GetArea() * leftCount : 0.f;
+      const float cost = leftArea + rightAreas[i + 1];
+      if (leftCount > 0 && leftCount < count && cost < bestCost)
+      {
+        bestCost = cost;
+        bestBin = i;
+      }
+    }
+
+    BuildLeaf *pMiddle =
+        std::partition(pLeaves, pLeaves + count,
+                       [&](const BuildLeaf &leaf) { return getBin(leaf) <= bestBin; });
+    splitCount = uint32_t(pMiddle - pLeaves);
+  }
+
+  // Fall back to a median split when the centers can't be told apart, or the
+  // tree is getting too deep.
+  if (splitCount == 0 || splitCount == count)
+  {
+    splitCount = count / 2;
+    std::nth_element(pLeaves, pLeaves + splitCount, pLeaves + count,
+                     [&](const BuildLeaf &a, const BuildLeaf &b) {
+                       return a.center[axis] < b.center[axis];
+                     });
+  }
+
+  const uint32_t left = uint32_t(m_Nodes.size());
+  m_Nodes.push_back({});
+  m_Nodes.push_back({});
+  m_Nodes[nodeIndex].first = left;
+  m_Nodes[nodeIndex].count = 0;
+
+  BuildNode(left, first, splitCount, depth + 1);
+  BuildNode(left + 1, first + splitCount, count - splitCount, depth + 1);
+}
+
+float SceneQuery::Refit()
+{
+  // Children always come after their parents, so a reverse walk refits
+  // children first.
+  float cost = 0.f;
+  for (size_t i = m_Nodes.size(); i > 0;)
+  {
+    Node &node = m_Nodes[--i];
+    if (node.count > 0)
+    {
+      node.bounds = m_Leaves[m_LeafOrder[node.first]].bounds;
+      for (uint32_t leaf = node.first + 1; leaf < node.first + node.count; ++leaf)
+      {
+        node.bounds.Grow(m_Leaves[m_LeafOrder[leaf]].bounds);
+      }
+      cost += node.bounds.GetArea() * node.count;
+    }
+    else
+    {
+      node.bounds = m_Nodes[node.first].bounds;
+      node.bounds.Grow(m_Nodes[node.first + 1].bounds);
+      cost += node.bounds.GetArea();
+    }
+  }
+
+  // Relative to the root, so that moving everything doesn't count.
+  const float rootArea = m_Nodes.empty() ? 0.f : m_Nodes[0].bounds.GetArea();
+  return rootArea > 0.f ? cost / rootArea : 0.f;
+}
+
+}  // namespace tetrad
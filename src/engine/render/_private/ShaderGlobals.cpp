@@ -35,24 +35,14 @@ bool WorldShaderGlobals::GetLocations(GLuint program)
 
 bool UIShaderGlobals::GetLocations(GLuint program)
 {
-  if (!BaseShaderGlobals::GetLocations(program))
-  {
-    return false;
-  }
-
   SHADER_UI(ELEM_TO_GET_LOC)
 
   return true;
 }
 
-bool TextShaderGlobals::GetLocations(GLuint program)
+bool UILayerShaderGlobals::GetLocations(GLuint program)
 {
-  if (!BaseShaderGlobals::GetLocations(program))
-  {
-    return false;
-  }
-
-  SHADER_TEXT(ELEM_TO_GET_LOC)
+  SHADER_UI_LAYER(ELEM_TO_GET_LOC)
 
   return true;
 }
@@ -0,0 +1,144 @@
+#include "engine/render/ShaderLibrary.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#include "core/Log.h"
+#include "engine/render/ShaderProgram.h"
+
+using namespace std;
+
+namespace tetrad {
+
+ShaderLibrary::ShaderLibrary() {}
+
+ShaderLibrary::~ShaderLibrary() {}
+
+void ShaderLibrary::AddProgram(const string &name, shaderList_t shaders)
+{
+  m_Programs[name] = move(shaders);
+}
+
+bool ShaderLibrary::LoadManifest(const string &manifestPath)
+{
+  ifstream manifest(manifestPath);
+  if (!manifest)
+  {
+    LOG_ERROR("Failed to open shader manifest " << manifestPath << "\n");
+    return false;
+  }
+
+  bool success = true;
+  string line;
+  while (getline(manifest, line))
+  {
+    istringstream lineStream(line);
+    string name;
+    if (!(lineStream >> name) || name[0] == '#')
+    {
+      continue;
+    }
+
+    vector<string> defines;
+    string define;
+    while (lineStream >> define)
+    {
+      defines.push_back(define);
+    }
+
+    success &= Request(name, move(defines));
+  }
+
+  return success;
+}
+
+bool ShaderLibrary::Request(const string &name, vector<string> defines)
+{
+  if (m_Variants.find(GetVariantKey(name, defines)) != m_Variants.end())
+  {
+    return true;
+  }
+
+  return StartVariant(name, defines) != nullptr;
+}
+
+GLuint ShaderLibrary::Get(const string &name, vector<string> defines)
+{
+  auto it = m_Variants.find(GetVariantKey(name, defines));
+  Variant *pVariant = (it != m_Variants.end()) ? &it->second : nullptr;
+  if (!pVariant)
+  {
+    LOG_WARNING("Shader variant '" << GetVariantKey(name, defines)
+                                   << "' is missing from the manifest\n");
+    pVariant = StartVariant(name, defines);
+    if (!pVariant)
+    {
+      return GL_NONE;
+    }
+  }
+
+  // Link exactly once, even if linking fails.
+  if (pVariant->pCompiler)
+  {
+    pVariant->program = pVariant->pCompiler->Link();
+    pVariant->pCompiler.reset();
+  }
+
+  return pVariant->program;
+}
+
+void ShaderLibrary::Shutdown()
+{
+  for (auto &variant : m_Variants)
+  {
+    glDeleteProgram(variant.second.program);
+  }
+  m_Variants.clear();
+}
+
+string ShaderLibrary::GetVariantKey(const string &name, vector<string> &defines)
+{
+  // Sort so that the order defines are listed in doesn't matter.
+  sort(defines.begin(), defines.end());
+
+  string key = name;
+  for (const string &define : defines)
+  {
+    key += ' ' + define;
+  }
+  return key;
+}
+
+ShaderLibrary::Variant *ShaderLibrary::StartVariant(const string &name,
+                                                    vector<string> &defines)
+{
+  auto programIt = m_Programs.find(name);
+  if (programIt == m_Programs.end())
+  {
+    LOG_ERROR("Unknown shader program '" << name << "'\n");
+    return nullptr;
+  }
+
+  const shaderList_t &shaders = programIt->second;
+  unique_ptr<ShaderProgram> pCompiler(new ShaderProgram(shaders.size()));
+  for (const auto &shader : shaders)
+  {
+    pCompiler->PushShader(shader.first, shader.second);
+  }
+  for (const string &define : defines)
+  {
+    pCompiler->AddDefine(define);
+  }
+
+  Variant &variant = m_Variants[GetVariantKey(name, defines)];
+  variant.program = GL_NONE;
+  if (pCompiler->StartCompile())
+  {
+    variant.pCompiler = move(pCompiler);
+  }
+
+  return &variant;
+}
+
+}  // namespace tetrad
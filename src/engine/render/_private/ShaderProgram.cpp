@@ -1,20 +1,67 @@
 #include "engine/render/ShaderProgram.h"
 
+#include <cstring>
+#include <filesystem>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <sstream>
 
 #include "core/GlTypes.h"
 #include "core/Log.h"
+#include "core/Paths.h"
 
 using namespace std;
 
 namespace tetrad {
 
+namespace {
+constexpr uint32_t kCacheMagic = 0x43505354;  // "TSPC"
+constexpr uint32_t kCacheVersion = 1;
+
+struct ProgramCacheHeader
+{
+  uint32_t magic;
+  uint32_t version;
+  uint64_t key;
+  uint32_t binaryFormat;
+  uint32_t binaryLength;
+};
+
+// 64-bit FNV-1a.
+uint64_t HashBytes(uint64_t hash, const void* pData, size_t size)
+{
+  const uint8_t* pBytes = static_cast<const uint8_t*>(pData);
+  for (size_t i = 0; i < size; ++i)
+  {
+    hash = (hash ^ pBytes[i]) * 0x100000001b3ull;
+  }
+  return hash;
+}
+
+uint64_t HashString(uint64_t hash, const char* str)
+{
+  // Hash the terminator too, so that consecutive strings can't alias.
+  return HashBytes(hash, str, str ? strlen(str) + 1 : 0);
+}
+}  // namespace
+
 ShaderProgram::ShaderProgram(size_t expectedShaders)
+    : m_Program(0), m_CacheKey(0), m_UseCache(false), m_IsFromCache(false)
 {
   m_Shaders.reserve(expectedShaders);
 }
 
+ShaderProgram::~ShaderProgram()
+{
+  // Clean up after a StartCompile that was never linked.
+  if (m_Program)
+  {
+    DeleteShaders();
+    glDeleteProgram(m_Program);
+  }
+}
+
 void ShaderProgram::PushShader(GLenum shaderType, string shaderPath)
 {
   m_Shaders.push_back(make_pair(shaderType, shaderPath));
@@ -22,52 +69,165 @@ void ShaderProgram::PushShader(GLenum shaderType, string shaderPath)
 
 void ShaderProgram::PopShader() { m_Shaders.pop_back(); }
 
-GLuint ShaderProgram::Compile()
+void ShaderProgram::AddDefine(string define) { m_Defines.push_back(move(define)); }
+
+bool ShaderProgram::StartCompile()
 {
-  GLuint program = glCreateProgram();
-  if (!program)
+  DEBUG_ASSERT(m_Program == 0);
+
+  m_Sources.clear();
+  m_Sources.reserve(m_Shaders.size());
+  for (const auto& shader : m_Shaders)
+  {
+    m_Sources.push_back(GetSource(shader.second));
+  }
+
+  m_UseCache = IsBinaryCacheSupported();
+  m_CacheKey = m_UseCache ? GetCacheKey(m_Sources) : 0;
+  if (m_UseCache)
+  {
+    m_Program = LoadCachedProgram(m_CacheKey);
+    m_IsFromCache = (m_Program != GL_NONE);
+    if (m_IsFromCache)
+    {
+      return true;
+    }
+  }
+
+  return StartCompileFromSource();
+}
+
+bool ShaderProgram::StartCompileFromSource()
+{
+  EnableParallelCompile();
+
+  m_Program = glCreateProgram();
+  if (!m_Program)
   {
     LOG_ERROR("Failed to create the openGL shader program\n");
-    glDeleteProgram(program);
+    return false;
+  }
+
+  // Compile status isn't checked until Link, so that the driver is free to
+  // compile in the background.
+  m_CompiledShaders.resize(m_Shaders.size());
+  for (size_t i = 0; i < m_CompiledShaders.size(); ++i)
+  {
+    m_CompiledShaders[i] = CompileShader(m_Shaders[i].first, m_Sources[i]);
+    glAttachShader(m_Program, m_CompiledShaders[i]);
+  }
+
+  if (m_UseCache)
+  {
+    glProgramParameteri(m_Program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+  }
+
+  return true;
+}
+
+GLuint ShaderProgram::Link()
+{
+  if (!m_Program)
+  {
+    LOG_ERROR("Attempted to link a shader program that wasn't compiled\n");
     return GL_NONE;
   }
 
-  vector<GLuint> shaders;
-  shaders.resize(m_Shaders.size());
-  for (size_t i = 0; i < shaders.size(); ++i)
+  GLint success;
+  if (m_IsFromCache)
+  {
+    // Drivers may reject binaries at any time (e.g. after an update), in which
+    // case the entry is stale and we fall back to the source.
+    m_IsFromCache = false;
+    glGetProgramiv(m_Program, GL_LINK_STATUS, &success);
+    if (success)
+    {
+      return Finish();
+    }
+
+    LOG_DEBUG("Shader cache entry " << GetCachePath(m_CacheKey) << " is stale\n");
+    glDeleteProgram(m_Program);
+    if (!StartCompileFromSource())
+    {
+      m_Program = 0;
+      return GL_NONE;
+    }
+  }
+
+  for (GLuint shader : m_CompiledShaders)
   {
-    shaders[i] = CompileShader(m_Shaders[i].first, GetSource(m_Shaders[i].second));
-    glAttachShader(program, shaders[i]);
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success)
+    {
+      GLchar errorLog[1024];
+      glGetShaderInfoLog(shader, 1024, NULL, errorLog);
+      LOG_ERROR("Failed to compile the shader object:\n" << errorLog << "\n");
+      return Fail(false);
+    }
   }
 
   // Link Program
-  GLint success;
-  glLinkProgram(program);
-  glGetProgramiv(program, GL_LINK_STATUS, &success);
-  if (!success) goto error;
+  glLinkProgram(m_Program);
+  glGetProgramiv(m_Program, GL_LINK_STATUS, &success);
+  if (!success) return Fail(true);
 
   // Validate Program
-  glValidateProgram(program);
-  glGetProgramiv(program, GL_VALIDATE_STATUS, &success);
-  if (!success) goto error;
+  glValidateProgram(m_Program);
+  glGetProgramiv(m_Program, GL_VALIDATE_STATUS, &success);
+  if (!success) return Fail(true);
 
-  // Cleanup
-  for (size_t i = 0; i < shaders.size(); ++i)
+  if (m_UseCache)
   {
-    glDetachShader(program, shaders[i]);
-    glDeleteShader(shaders[i]);
+    SaveCachedProgram(m_Program, m_CacheKey);
   }
 
+  return Finish();
+}
+
+GLuint ShaderProgram::Compile()
+{
+  if (!StartCompile())
+  {
+    return GL_NONE;
+  }
+
+  return Link();
+}
+
+GLuint ShaderProgram::Finish()
+{
+  // Cleanup
+  DeleteShaders();
+  m_Sources.clear();
+
+  GLuint program = m_Program;
+  m_Program = 0;
   return program;
+}
+
+GLuint ShaderProgram::Fail(bool logProgramError)
+{
+  if (logProgramError)
+  {
+    GLchar errorLog[1024];
+    glGetProgramInfoLog(m_Program, 1024, NULL, errorLog);
+    LOG_ERROR(errorLog << "\n");
+  }
 
-error:
-  GLchar errorLog[1024];
-  glGetProgramInfoLog(program, 1024, NULL, errorLog);
-  LOG_ERROR(errorLog << "\n");
-  glDeleteProgram(program);
+  glDeleteProgram(Finish());
   return GL_NONE;
 }
 
+void ShaderProgram::DeleteShaders()
+{
+  for (GLuint shader : m_CompiledShaders)
+  {
+    glDetachShader(m_Program, shader);
+    glDeleteShader(shader);
+  }
+  m_CompiledShaders.clear();
+}
+
 string ShaderProgram::GetSource(string shaderPath)
 {
   ifstream shaderFile(shaderPath, ios::in | ios::binary);
@@ -82,6 +242,7 @@ string ShaderProgram::GetSource(string shaderPath)
     shaderFile.read(&shaderString[0], shaderString.size());
     shaderFile.close();
 
+    InsertDefines(shaderString);
     return shaderString;
   }
 
@@ -89,6 +250,34 @@ string ShaderProgram::GetSource(string shaderPath)
   return "";
 }
 
+void ShaderProgram::InsertDefines(string& source) const
+{
+  if (m_Defines.empty())
+  {
+    return;
+  }
+
+  // Defines have to come after the #version directive, if there is one.
+  size_t insertPos = 0;
+  int nextLine = 1;
+  if (source.compare(0, 8, "#version") == 0)
+  {
+    insertPos = source.find('\n');
+    insertPos = (insertPos == string::npos) ? source.size() : insertPos + 1;
+    nextLine = 2;
+  }
+
+  string defines;
+  for (const string& define : m_Defines)
+  {
+    defines += "#define " + define + "\n";
+  }
+  // Keep line numbers in compile errors matching the source file.
+  defines += "#line " + to_string(nextLine) + "\n";
+
+  source.insert(insertPos, defines);
+}
+
 GLuint ShaderProgram::CompileShader(GLenum shaderType, string shaderSource)
 {
   GLuint shaderObj = glCreateShader(shaderType);
@@ -103,20 +292,138 @@ GLuint ShaderProgram::CompileShader(GLenum shaderType, string shaderSource)
   GLint length = (GLint)shaderSource.size();
 
   glShaderSource(shaderObj, 1, &shader, &length);
-
-  GLint success;
   glCompileShader(shaderObj);
-  glGetShaderiv(shaderObj, GL_COMPILE_STATUS, &success);
-  if (!success)
+
+  return shaderObj;
+}
+
+void ShaderProgram::EnableParallelCompile()
+{
+  static bool isEnabled = false;
+  if (isEnabled)
+  {
+    return;
+  }
+  isEnabled = true;
+
+  // Let the driver pick the number of compiler threads. GLEW only knows about
+  // the ARB version of the extension, so the KHR one is loaded through GLFW.
+  const GLuint kDriverChoosesThreads = 0xFFFFFFFF;
+  if (GLEW_ARB_parallel_shader_compile)
+  {
+    glMaxShaderCompilerThreadsARB(kDriverChoosesThreads);
+  }
+  else if (glfwExtensionSupported("GL_KHR_parallel_shader_compile"))
+  {
+    auto pMaxThreads = reinterpret_cast<PFNGLMAXSHADERCOMPILERTHREADSARBPROC>(
+        glfwGetProcAddress("glMaxShaderCompilerThreadsKHR"));
+    if (pMaxThreads)
+    {
+      pMaxThreads(kDriverChoosesThreads);
+    }
+  }
+}
+
+bool ShaderProgram::IsBinaryCacheSupported()
+{
+  static const bool isSupported = []() {
+    if (!GLEW_ARB_get_program_binary)
+    {
+      return false;
+    }
+
+    // Some drivers expose the extension without supporting any formats.
+    GLint formatCount = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+    return formatCount > 0;
+  }();
+
+  return isSupported;
+}
+
+string ShaderProgram::GetCachePath(uint64_t key)
+{
+  ostringstream path;
+  path << SHADER_CACHE_PATH << hex << setw(16) << setfill('0') << key << ".bin";
+  return path.str();
+}
+
+uint64_t ShaderProgram::GetCacheKey(const vector<string>& sources) const
+{
+  uint64_t hash = 0xcbf29ce484222325ull;
+
+  // Binaries are only valid for the driver that produced them.
+  hash = HashString(hash, reinterpret_cast<const char*>(glGetString(GL_VENDOR)));
+  hash = HashString(hash, reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+  hash = HashString(hash, reinterpret_cast<const char*>(glGetString(GL_VERSION)));
+
+  for (size_t i = 0; i < m_Shaders.size(); ++i)
+  {
+    hash = HashBytes(hash, &m_Shaders[i].first, sizeof(m_Shaders[i].first));
+    hash = HashString(hash, sources[i].c_str());
+  }
+
+  return hash;
+}
+
+GLuint ShaderProgram::LoadCachedProgram(uint64_t key)
+{
+  const string path = GetCachePath(key);
+  ifstream cacheFile(path, ios::in | ios::binary);
+  if (!cacheFile)
   {
-    GLchar errorLog[1024];
-    glGetShaderInfoLog(shaderObj, 1024, NULL, errorLog);
-    LOG_ERROR("Failed to compile the shader object:\n" << errorLog << "\n");
-    glDeleteShader(shaderObj);
     return GL_NONE;
   }
 
-  return shaderObj;
+  ProgramCacheHeader header;
+  vector<char> binary;
+  if (cacheFile.read(reinterpret_cast<char*>(&header), sizeof(header)) &&
+      header.magic == kCacheMagic && header.version == kCacheVersion &&
+      header.key == key)
+  {
+    binary.resize(header.binaryLength);
+    cacheFile.read(binary.data(), binary.size());
+  }
+  if (!cacheFile || binary.empty())
+  {
+    LOG_WARNING("Ignoring corrupt shader cache entry " << path << "\n");
+    return GL_NONE;
+  }
+
+  // The link status is checked in Link, so that drivers which support
+  // parallel compilation can load the binary in the background.
+  GLuint program = glCreateProgram();
+  glProgramBinary(program, header.binaryFormat, binary.data(), binary.size());
+  return program;
+}
+
+void ShaderProgram::SaveCachedProgram(GLuint program, uint64_t key)
+{
+  GLint length = 0;
+  glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+  if (length <= 0)
+  {
+    return;
+  }
+
+  ProgramCacheHeader header = {kCacheMagic, kCacheVersion, key, 0, 0};
+  vector<char> binary(length);
+  GLenum binaryFormat;
+  glGetProgramBinary(program, length, &length, &binaryFormat, binary.data());
+  header.binaryFormat = binaryFormat;
+  header.binaryLength = length;
+
+  error_code error;
+  filesystem::create_directories(SHADER_CACHE_PATH, error);
+
+  const string path = GetCachePath(key);
+  ofstream cacheFile(path, ios::out | ios::binary | ios::trunc);
+  cacheFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  cacheFile.write(binary.data(), length);
+  if (!cacheFile)
+  {
+    LOG_WARNING("Failed to write shader cache entry " << path << "\n");
+  }
 }
 
 }  // namespace tetrad
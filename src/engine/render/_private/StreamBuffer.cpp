@@ -0,0 +1,160 @@
+#include "engine/render/StreamBuffer.h"
+
+#include "core/Log.h"
+
+namespace tetrad {
+
+StreamBuffer::StreamBuffer()
+    : m_Buffer(0),
+      m_Target(GL_ARRAY_BUFFER),
+      m_FrameSize(0),
+      m_FrameIndex(0),
+      m_Offset(0),
+      m_FlushedSize(0),
+      m_pMapped(nullptr),
+      m_Fences{}
+{}
+
+bool StreamBuffer::Initialize(GLenum target, GLsizeiptr frameSize)
+{
+  // Keep every frame's region aligned for any reasonable allocation alignment.
+  const GLsizeiptr kRegionAlignment = 256;
+  m_Target = target;
+  m_FrameSize = (frameSize + kRegionAlignment - 1) & ~(kRegionAlignment - 1);
+  m_FrameIndex = 0;
+  m_Offset = m_FlushedSize = 0;
+
+  glGenBuffers(1, &m_Buffer);
+  glBindBuffer(m_Target, m_Buffer);
+
+  if (GLEW_ARB_buffer_storage)
+  {
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glBufferStorage(m_Target, kFrameCount * m_FrameSize, nullptr, flags);
+    m_pMapped = static_cast<char *>(
+        glMapBufferRange(m_Target, 0, kFrameCount * m_FrameSize, flags));
+    if (m_pMapped)
+    {
+      return true;
+    }
+
+    // The buffer's storage is immutable now, so start over with a new one.
+    LOG_WARNING("Failed to persistently map stream buffer, falling back to orphaning\n");
+    glDeleteBuffers(1, &m_Buffer);
+    glGenBuffers(1, &m_Buffer);
+    glBindBuffer(m_Target, m_Buffer);
+  }
+
+  glBufferData(m_Target, m_FrameSize, nullptr, GL_STREAM_DRAW);
+  m_Staging.resize(m_FrameSize);
+
+  return m_Buffer != 0;
+}
+
+void StreamBuffer::Shutdown()
+{
+  for (GLsync &fence : m_Fences)
+  {
+    glDeleteSync(fence);
+    fence = nullptr;
+  }
+
+  if (m_pMapped)
+  {
+    glBindBuffer(m_Target, m_Buffer);
+    glUnmapBuffer(m_Target);
+    m_pMapped = nullptr;
+  }
+
+  glDeleteBuffers(1, &m_Buffer);
+  m_Buffer = 0;
+  m_Staging = std::vector<char>();
+}
+
+bool StreamBuffer::Resize(GLsizeiptr frameSize)
+{
+  // Deleting the buffer is safe even if the GPU is still using it, as the
+  // driver keeps it alive until then.
+  Shutdown();
+  if (!Initialize(m_Target, frameSize))
+  {
+    return false;
+  }
+
+  BeginFrame();
+  return true;
+}
+
+void StreamBuffer::BeginFrame()
+{
+  m_Offset = m_FlushedSize = 0;
+
+  if (!m_pMapped)
+  {
+    // Orphan the previous frame's storage instead of waiting on it.
+    glBindBuffer(m_Target, m_Buffer);
+    glBufferData(m_Target, m_FrameSize, nullptr, GL_STREAM_DRAW);
+    return;
+  }
+
+  // With kFrameCount regions this should almost never have to wait, unless the
+  // GPU falls more than kFrameCount - 1 frames behind.
+  GLsync &fence = m_Fences[m_FrameIndex];
+  if (fence)
+  {
+    GLenum result = glClientWaitSync(fence, 0, 0);
+    if (result == GL_TIMEOUT_EXPIRED)
+    {
+      LOG_DEBUG("Waiting on GPU to reuse stream buffer region\n");
+      const GLuint64 kSecondNs = 1000000000;
+      glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, kSecondNs);
+    }
+    glDeleteSync(fence);
+    fence = nullptr;
+  }
+}
+
+void StreamBuffer::EndFrame()
+{
+  if (m_pMapped)
+  {
+    m_Fences[m_FrameIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    m_FrameIndex = (m_FrameIndex + 1) % kFrameCount;
+  }
+}
+
+StreamBuffer::Allocation StreamBuffer::Allocate(GLsizeiptr size, GLsizeiptr alignment)
+{
+  DEBUG_ASSERT(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+  GLsizeiptr start = (m_Offset + alignment - 1) & ~(alignment - 1);
+  if (start + size > m_FrameSize)
+  {
+    return {nullptr, 0};
+  }
+  m_Offset = start + size;
+
+  if (m_pMapped)
+  {
+    GLintptr offset = m_FrameIndex * m_FrameSize + start;
+    return {m_pMapped + offset, offset};
+  }
+
+  return {&m_Staging[start], start};
+}
+
+void StreamBuffer::Flush()
+{
+  // Coherent persistent mappings don't need any flushing.
+  if (m_pMapped || m_FlushedSize == m_Offset)
+  {
+    return;
+  }
+
+  glBindBuffer(m_Target, m_Buffer);
+  glBufferSubData(m_Target, m_FlushedSize, m_Offset - m_FlushedSize,
+                  &m_Staging[m_FlushedSize]);
+  m_FlushedSize = m_Offset;
+}
+
+}  // namespace tetrad
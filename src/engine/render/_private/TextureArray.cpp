@@ -0,0 +1,252 @@
+#include "engine/render/TextureArray.h"
+
+#include <algorithm>
+
+#include "core/Log.h"
+
+namespace tetrad {
+
+TextureArray::TextureArray()
+    : m_Texture(0),
+      m_InternalFormat(GL_RGBA8),
+      m_Size(0),
+      m_LayerCapacity(0),
+      m_ReadFramebuffer(0),
+      m_DrawFramebuffer(0)
+{}
+
+bool TextureArray::Initialize(GLenum internalFormat, GLsizei size, GLsizei layerCapacity)
+{
+  m_InternalFormat = internalFormat;
+  m_Size = std::max(size, 1);
+  m_LayerCapacity = std::max(layerCapacity, 1);
+
+  glGenFramebuffers(1, &m_ReadFramebuffer);
+  glGenFramebuffers(1, &m_DrawFramebuffer);
+  if (!m_ReadFramebuffer || !m_DrawFramebuffer)
+  {
+    LOG_ERROR("Failed to create framebuffers for texture array\n");
+    return false;
+  }
+
+  m_Texture = CreateStorage(m_Size, m_LayerCapacity);
+
+  // Reserve the first texel of layer 0 for the null texture.
+  static const GLfloat kNullColor[] = {0.f, 0.f, 0.f, 1.f};
+  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_DrawFramebuffer);
+  glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, m_Texture, 0, 0);
+  glClearBufferfv(GL_COLOR, 0, kNullColor);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+  m_Shelves.emplace_back(1, Shelf{0, 1, 1, 1});
+  m_Regions[0] = {0, 0, 0, 1, 1};
+
+  return true;
+}
+
+void TextureArray::Shutdown()
+{
+  glDeleteTextures(1, &m_Texture);
+  glDeleteFramebuffers(1, &m_ReadFramebuffer);
+  glDeleteFramebuffers(1, &m_DrawFramebuffer);
+  m_Texture = m_ReadFramebuffer = m_DrawFramebuffer = 0;
+
+  m_Shelves.clear();
+  m_Regions.clear();
+  m_Size = m_LayerCapacity = 0;
+}
+
+const TextureArray::Region &TextureArray::GetRegion(GLuint texture)
+{
+  auto it = m_Regions.find(texture);
+  if (it != m_Regions.end())
+  {
+    return it->second;
+  }
+
+  GLint width, height;
+  glBindTexture(GL_TEXTURE_2D, texture);
+  glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width);
+  glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height);
+
+  // Layers are square, and doubled in size until the texture fits in one.
+  const GLsizei neededSize = std::max(width, height);
+  if (neededSize > m_Size)
+  {
+    GLsizei size = m_Size;
+    while (size < neededSize)
+    {
+      size *= 2;
+    }
+    Reallocate(size, m_LayerCapacity);
+  }
+
+  Region region;
+  if (neededSize > m_Size || !Allocate(width, height, region))
+  {
+    LOG_ERROR("Texture array is full, using null texture for texture " << texture
+                                                                         << "\n");
+    return m_Regions[0];
+  }
+
+  Blit(-1, texture, region.layer, region.x, region.y, width, height);
+  return m_Regions[texture] = region;
+}
+
+void TextureArray::Release(GLuint texture)
+{
+  auto it = m_Regions.find(texture);
+  if (texture == 0 || it == m_Regions.end())
+  {
+    return;
+  }
+  const Region region = it->second;
+  m_Regions.erase(it);
+
+  // The end of a shelf can be reused right away, and the rest once it's empty.
+  std::vector<Shelf> &shelves = m_Shelves[region.layer];
+  for (Shelf &shelf : shelves)
+  {
+    if (shelf.y == region.y)
+    {
+      if (--shelf.regionCount == 0)
+      {
+        shelf.usedWidth = 0;
+      }
+      else if (region.x + region.width == shelf.usedWidth)
+      {
+        shelf.usedWidth = region.x;
+      }
+      break;
+    }
+  }
+
+  // Empty shelves at the top of a layer are dropped, so that the space can be
+  // taken by taller ones.
+  while (!shelves.empty() && shelves.back().regionCount == 0)
+  {
+    shelves.pop_back();
+  }
+}
+
+bool TextureArray::Allocate(GLsizei width, GLsizei height, Region &region)
+{
+  // Use the shortest shelf with room, unless it's more than twice as tall as
+  // the texture.
+  GLint layer = 0;
+  Shelf *pShelf = nullptr;
+  for (size_t i = 0; i < m_Shelves.size(); ++i)
+  {
+    for (Shelf &shelf : m_Shelves[i])
+    {
+      if (shelf.height >= height && shelf.height <= 2 * height &&
+          m_Size - shelf.usedWidth >= width && (!pShelf || shelf.height < pShelf->height))
+      {
+        layer = GLint(i);
+        pShelf = &shelf;
+      }
+    }
+  }
+
+  // Otherwise, start a new shelf on top of a layer, or in a new layer.
+  for (size_t i = 0; i < m_Shelves.size() && !pShelf; ++i)
+  {
+    std::vector<Shelf> &shelves = m_Shelves[i];
+    const GLint top = shelves.empty() ? 0 : shelves.back().y + shelves.back().height;
+    if (m_Size - top >= height)
+    {
+      shelves.push_back({top, height, 0, 0});
+      layer = GLint(i);
+      pShelf = &shelves.back();
+    }
+  }
+  if (!pShelf)
+  {
+    if (GLsizei(m_Shelves.size()) == m_LayerCapacity &&
+        !Reallocate(m_Size, m_LayerCapacity * 2))
+    {
+      return false;
+    }
+    m_Shelves.emplace_back(1, Shelf{0, height, 0, 0});
+    layer = GLint(m_Shelves.size() - 1);
+    pShelf = &m_Shelves.back().back();
+  }
+
+  region = {layer, pShelf->usedWidth, pShelf->y, width, height};
+  pShelf->usedWidth += width;
+  ++pShelf->regionCount;
+  return true;
+}
+
+bool TextureArray::Reallocate(GLsizei size, GLsizei layerCapacity)
+{
+  GLint maxSize, maxLayers;
+  glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+  glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+  size = std::min<GLsizei>(size, maxSize);
+  layerCapacity = std::min<GLsizei>(layerCapacity, maxLayers);
+  if (size <= m_Size && layerCapacity <= m_LayerCapacity)
+  {
+    return false;
+  }
+
+  // GL 3.3 has no glCopyImageSubData, so copy the old layers over one by one.
+  // Regions keep their texel coordinates, so they stay valid.
+  GLuint oldTexture = m_Texture;
+  m_Texture = CreateStorage(size, layerCapacity);
+  for (GLint i = 0; i < GLint(m_Shelves.size()); ++i)
+  {
+    Blit(i, oldTexture, i, 0, 0, m_Size, m_Size);
+  }
+  glDeleteTextures(1, &oldTexture);
+
+  m_Size = size;
+  m_LayerCapacity = layerCapacity;
+  return true;
+}
+
+GLuint TextureArray::CreateStorage(GLsizei size, GLsizei layerCapacity) const
+{
+  GLuint texture;
+  glGenTextures(1, &texture);
+  glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, m_InternalFormat, size, size, layerCapacity, 0,
+               GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+  glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+  return texture;
+}
+
+void TextureArray::Blit(GLint srcLayer, GLuint srcTexture, GLint dstLayer, GLint dstX,
+                        GLint dstY, GLsizei width, GLsizei height)
+{
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, m_ReadFramebuffer);
+  if (srcLayer < 0)
+  {
+    glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                           srcTexture, 0);
+  }
+  else
+  {
+    glFramebufferTextureLayer(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, srcTexture, 0,
+                              srcLayer);
+  }
+
+  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_DrawFramebuffer);
+  glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, m_Texture, 0,
+                            dstLayer);
+
+  // Copies are never scaled, so texels are moved as they are.
+  glBlitFramebuffer(0, 0, width, height, dstX, dstY, dstX + width, dstY + height,
+                    GL_COLOR_BUFFER_BIT, GL_NEAREST);
+
+  // Detach the source so later texture uploads to it aren't affected.
+  glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+}  // namespace tetrad
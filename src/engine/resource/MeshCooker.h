@@ -0,0 +1,88 @@
+#pragma once
+
+#include <vector>
+
+#include "core/BaseTypes.h"
+
+namespace tetrad {
+
+/** @brief Offline-style processing applied to meshes as they're loaded. */
+class MeshCooker
+{
+ public:
+  /** @brief Range of a model's index buffer making up one level of detail. */
+  struct Lod
+  {
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    float error;  // Max deviation from the full-detail mesh, in model units
+  };
+
+  /** @brief Simplify a triangle list with quadric error metrics.
+   *
+   * Uses half-edge collapses, so the simplified triangles only reference
+   * existing vertices, and can share the original vertex buffer. Vertices are
+   * welded by position first, so attribute seams don't block simplification.
+   * Open borders are preserved.
+   *
+   * @param indices - triangle list to simplify in place
+   * @param targetIndexCount - stop once there are at most this many indices
+   * @param maxError - stop before collapses that would deviate more than this
+   *
+   * @return The error of the simplified mesh, relative to the input mesh.
+   */
+  static float Simplify(const std::vector<glm::vec3> &positions,
+                        std::vector<uint32_t> &indices, size_t targetIndexCount,
+                        float maxError);
+
+  /** @brief Append a chain of progressively simplified LODs to indices.
+   *
+   * Each LOD roughly halves the triangle count of the previous one. The chain
+   * stops early once simplification stops making progress.
+   *
+   * @return The LODs, starting with the original mesh.
+   */
+  static std::vector<Lod> GenerateLods(const std::vector<glm::vec3> &positions,
+                                       std::vector<uint32_t> &indices,
+                                       size_t maxLodCount);
+
+  /** @brief Merge vertices that are bitwise identical, and remap indices to match.
+   *
+   * @param pVertices - tightly packed vertices, compacted in place
+   *
+   * @return The number of unique vertices left at the start of pVertices.
+   */
+  static size_t DeduplicateVertices(void *pVertices, size_t vertexCount,
+                                    size_t vertexSize, std::vector<uint32_t> &indices);
+
+  /** @brief Reorder triangles to improve post-transform vertex cache hits.
+   *
+   * Greedy triangle ordering driven by per-vertex scores, after Tom Forsyth's
+   * "Linear-Speed Vertex Cache Optimisation". It doesn't depend on the exact
+   * cache size of the GPU, and degrades gracefully on any size.
+   */
+  static void OptimizeVertexCache(uint32_t *pIndices, size_t indexCount,
+                                  size_t vertexCount);
+
+  /** @brief Reorder clusters of triangles so that outward-facing ones come first.
+   *
+   * Splits the (cache optimized) triangle list wherever the vertex cache would
+   * be cold anyway, so the reordering barely affects cache efficiency, and then
+   * sorts those clusters so that triangles likely to occlude the rest of the
+   * mesh are drawn first, reducing overdraw.
+   */
+  static void OptimizeOverdraw(uint32_t *pIndices, size_t indexCount,
+                               const std::vector<glm::vec3> &positions);
+
+  /** @brief Reorder vertices in the order they're first used by indices.
+   *
+   * Should run after every triangle reordering. Vertices that aren't
+   * referenced at all are dropped.
+   *
+   * @return The number of vertices left at the start of pVertices.
+   */
+  static size_t OptimizeVertexFetch(void *pVertices, size_t vertexCount,
+                                    size_t vertexSize, std::vector<uint32_t> &indices);
+};
+
+}  // namespace tetrad
@@ -1,19 +1,45 @@
 #pragma once
 
 #include <unordered_map>
+#include <vector>
 
 #include "core/BaseTypes.h"
 #include "core/GlTypes.h"
+#include "engine/resource/MeshCooker.h"
 
 namespace tetrad {
 
 class Font;
 
+constexpr uint8_t kMaxModelLods = 4;
+
+/** @brief CPU-side copy of a model's full-detail triangles, for scene queries. */
+struct ModelGeometry
+{
+  std::vector<glm::vec3> positions;
+  std::vector<uint32_t> indices;
+};
+
 struct ModelResource
 {
   GLuint m_VBO;
   GLuint m_IBO;
-  GLsizei m_IndexCount;
+  GLsizei m_IndexCount;  // Index count of the full-detail mesh
+  GLenum m_IndexType;    // GL_UNSIGNED_SHORT when the vertex count allows it
+
+  // Levels of detail, stored back to back in m_IBO. LOD 0 is full detail.
+  uint8_t m_LodCount;
+  MeshCooker::Lod m_Lods[kMaxModelLods];
+
+  // Model space bounds, and the triangles within them. Owned by the manager.
+  glm::vec3 m_BoundsMin;
+  glm::vec3 m_BoundsMax;
+  const ModelGeometry *m_pGeometry;
+
+  inline size_t GetIndexSize() const
+  {
+    return (m_IndexType == GL_UNSIGNED_SHORT) ? sizeof(uint16_t) : sizeof(uint32_t);
+  }
 };
 
 /** @brief Class to make sure resources are only loaded as needed. */
@@ -31,6 +57,18 @@ class ResourceManager
   static bool UnloadTexture(const std::string &str);
   static void UnloadAllTextures();
 
+  /** @brief Delete a texture, and report it through TakeDeletedTextures.
+   *
+   * Also used for textures that aren't loaded by name, like font glyphs.
+   */
+  static void DeleteTexture(GLuint texture);
+
+  /** @brief Append the textures deleted since the last call to textures.
+   *
+   * Lets the renderer drop its copies of them before their names are reused.
+   */
+  static void TakeDeletedTextures(std::vector<GLuint> &textures);
+
   //
   // Model functions
   //
@@ -46,7 +84,9 @@ class ResourceManager
 
  private:
   static std::unordered_map<std::string, GLuint> s_Textures;
+  static std::vector<GLuint> s_DeletedTextures;
   static std::unordered_map<std::string, ModelResource> s_Models;
+  static std::unordered_map<std::string, ModelGeometry> s_Geometries;
   static std::unordered_map<std::string, Font> s_Fonts;
 };
 
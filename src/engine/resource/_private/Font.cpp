@@ -93,7 +93,7 @@ void Font::Unload()
   {
     for (GLubyte c = 0; c < 128; c++)
     {
-      glDeleteTextures(1, &m_CharInfo[c].TextureID);
+      ResourceManager::DeleteTexture(m_CharInfo[c].TextureID);
     }
 
     m_IsLoaded = false;
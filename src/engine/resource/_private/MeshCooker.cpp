@@ -0,0 +1,715 @@
+#include "engine/resource/MeshCooker.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <queue>
+#include <string>
+#include <unordered_map>
+
+namespace tetrad {
+
+namespace {
+/** @brief Symmetric 4x4 matrix measuring squared distance to a set of planes. */
+struct Quadric
+{
+  // aa, ab, ac, ad, bb, bc, bd, cc, cd, dd
+  double m[10];
+
+  Quadric() { memset(m, 0, sizeof(m)); }
+
+  static Quadric FromPlane(double a, double b, double c, double d)
+  {
+    Quadric q;
+    q.m[0] = a * a, q.m[1] = a * b, q.m[2] = a * c, q.m[3] = a * d;
+    q.m[4] = b * b, q.m[5] = b * c, q.m[6] = b * d;
+    q.m[7] = c * c, q.m[8] = c * d;
+    q.m[9] = d * d;
+    return q;
+  }
+
+  Quadric &operator+=(const Quadric &that)
+  {
+    for (int i = 0; i < 10; ++i)
+    {
+      m[i] += that.m[i];
+    }
+    return *this;
+  }
+
+  double Evaluate(const glm::vec3 &p) const
+  {
+    double x = p.x, y = p.y, z = p.z;
+    return m[0] * x * x + 2 * m[1] * x * y + 2 * m[2] * x * z + 2 * m[3] * x +
+           m[4] * y * y + 2 * m[5] * y * z + 2 * m[6] * y + m[7] * z * z +
+           2 * m[8] * z + m[9];
+  }
+};
+
+struct Collapse
+{
+  double cost;
+  uint32_t from;
+  uint32_t to;
+  uint32_t fromVersion;
+  uint32_t toVersion;
+
+  bool operator>(const Collapse &that) const { return cost > that.cost; }
+};
+
+inline uint64_t EdgeKey(uint32_t a, uint32_t b)
+{
+  return (uint64_t(std::min(a, b)) << 32) | std::max(a, b);
+}
+
+inline glm::vec3 TriangleNormal(const glm::vec3 &p0, const glm::vec3 &p1,
+                                const glm::vec3 &p2)
+{
+  return glm::cross(p1 - p0, p2 - p0);
+}
+
+// Vertex cache optimization parameters, as suggested by Forsyth.
+constexpr size_t kCacheSize = 32;
+constexpr float kCacheDecayPower = 1.5f;
+constexpr float kLastTriangleScore = .75f;
+constexpr float kValenceBoostScale = 2.f;
+constexpr float kValenceBoostPower = .5f;
+
+// Size of the FIFO cache simulated when looking for cluster boundaries, and
+// how much worse than the unsplit clusters the split ones may hit it.
+constexpr size_t kOverdrawCacheSize = 16;
+constexpr float kOverdrawThreshold = 1.05f;
+
+float VertexScore(int cachePosition, uint32_t remainingValence)
+{
+  if (remainingValence == 0)
+  {
+    return -1.f;
+  }
+
+  float score = 0.f;
+  if (cachePosition >= 3)
+  {
+    const float scaler = 1.f / (kCacheSize - 3);
+    score = std::pow(1.f - (cachePosition - 3) * scaler, kCacheDecayPower);
+  }
+  else if (cachePosition >= 0)
+  {
+    // The last triangle's vertices get a fixed score, so that the next
+    // triangle doesn't depend on the order they were emitted in.
+    score = kLastTriangleScore;
+  }
+
+  // Boost vertices with few triangles left, to get rid of lone triangles.
+  return score + kValenceBoostScale * std::pow(float(remainingValence), -kValenceBoostPower);
+}
+}  // namespace
+
+float MeshCooker::Simplify(const std::vector<glm::vec3> &positions,
+                           std::vector<uint32_t> &indices, size_t targetIndexCount,
+                           float maxError)
+{
+  // Weld vertices by position, so that seams in other attributes (normals,
+  // uvs) don't split the mesh apart. Simplification happens on these welded
+  // vertices, with the first vertex at each position representing it.
+  std::vector<uint32_t> weldedIds(positions.size());
+  std::vector<uint32_t> representatives;
+  {
+    std::unordered_map<std::string, uint32_t> positionIds;
+    for (size_t i = 0; i < positions.size(); ++i)
+    {
+      std::string key(reinterpret_cast<const char *>(&positions[i]), sizeof(glm::vec3));
+      auto result = positionIds.emplace(key, uint32_t(representatives.size()));
+      if (result.second)
+      {
+        representatives.push_back(uint32_t(i));
+      }
+      weldedIds[i] = result.first->second;
+    }
+  }
+  const size_t vertexCount = representatives.size();
+  const size_t triangleCount = indices.size() / 3;
+
+  std::vector<uint32_t> triangles(triangleCount * 3);
+  std::vector<bool> isTriangleAlive(triangleCount, true);
+  size_t aliveCount = 0;
+  for (size_t t = 0; t < triangleCount; ++t)
+  {
+    for (int k = 0; k < 3; ++k)
+    {
+      triangles[3 * t + k] = weldedIds[indices[3 * t + k]];
+    }
+    const uint32_t *pTri = &triangles[3 * t];
+    isTriangleAlive[t] = pTri[0] != pTri[1] && pTri[1] != pTri[2] && pTri[0] != pTri[2];
+    aliveCount += isTriangleAlive[t];
+  }
+
+  auto position = [&](uint32_t vertex) -> const glm::vec3 & {
+    return positions[representatives[vertex]];
+  };
+
+  // Build per-vertex quadrics, adjacency, and lock vertices on open borders.
+  std::vector<Quadric> quadrics(vertexCount);
+  std::vector<std::vector<uint32_t>> vertexTriangles(vertexCount);
+  std::unordered_map<uint64_t, int> edgeUses;
+  for (size_t t = 0; t < triangleCount; ++t)
+  {
+    if (!isTriangleAlive[t])
+    {
+      continue;
+    }
+
+    const uint32_t *pTri = &triangles[3 * t];
+    glm::vec3 normal = TriangleNormal(position(pTri[0]), position(pTri[1]), position(pTri[2]));
+    float length = glm::length(normal);
+    if (length > 0)
+    {
+      normal /= length;
+      Quadric plane = Quadric::FromPlane(normal.x, normal.y, normal.z,
+                                         -glm::dot(normal, position(pTri[0])));
+      for (int k = 0; k < 3; ++k)
+      {
+        quadrics[pTri[k]] += plane;
+      }
+    }
+
+    for (int k = 0; k < 3; ++k)
+    {
+      vertexTriangles[pTri[k]].push_back(uint32_t(t));
+      ++edgeUses[EdgeKey(pTri[k], pTri[(k + 1) % 3])];
+    }
+  }
+
+  std::vector<bool> isLocked(vertexCount, false);
+  for (const auto &edge : edgeUses)
+  {
+    if (edge.second == 1)
+    {
+      isLocked[edge.first >> 32] = true;
+      isLocked[edge.first & 0xFFFFFFFF] = true;
+    }
+  }
+
+  // Collapse edges, cheapest first. Entries in the queue are invalidated
+  // lazily, by bumping the versions of the vertices they reference.
+  std::vector<uint32_t> versions(vertexCount, 0);
+  std::vector<uint32_t> collapsedInto(vertexCount);
+  for (uint32_t i = 0; i < vertexCount; ++i)
+  {
+    collapsedInto[i] = i;
+  }
+
+  std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> queue;
+  auto pushCollapse = [&](uint32_t from, uint32_t to) {
+    if (isLocked[from])
+    {
+      return;
+    }
+    Quadric sum = quadrics[from];
+    sum += quadrics[to];
+    queue.push({std::max(0.0, sum.Evaluate(position(to))), from, to, versions[from],
+                versions[to]});
+  };
+  for (size_t t = 0; t < triangleCount; ++t)
+  {
+    if (isTriangleAlive[t])
+    {
+      for (int k = 0; k < 3; ++k)
+      {
+        pushCollapse(triangles[3 * t + k], triangles[3 * t + (k + 1) % 3]);
+        pushCollapse(triangles[3 * t + (k + 1) % 3], triangles[3 * t + k]);
+      }
+    }
+  }
+
+  const double maxCost = double(maxError) * maxError;
+  double error = 0;
+  while (aliveCount * 3 > targetIndexCount && !queue.empty())
+  {
+    Collapse collapse = queue.top();
+    queue.pop();
+
+    const uint32_t from = collapse.from;
+    const uint32_t to = collapse.to;
+    if (collapse.fromVersion != versions[from] || collapse.toVersion != versions[to] ||
+        collapsedInto[from] != from || collapsedInto[to] != to)
+    {
+      continue;
+    }
+    if (collapse.cost > maxCost)
+    {
+      break;
+    }
+
+    // Reject collapses that would flip a triangle.
+    bool isFlipping = false;
+    for (uint32_t t : vertexTriangles[from])
+    {
+      const uint32_t *pTri = &triangles[3 * t];
+      if (!isTriangleAlive[t] || pTri[0] == to || pTri[1] == to || pTri[2] == to)
+      {
+        continue;
+      }
+
+      glm::vec3 p[3] = {position(pTri[0]), position(pTri[1]), position(pTri[2])};
+      glm::vec3 before = TriangleNormal(p[0], p[1], p[2]);
+      for (int k = 0; k < 3; ++k)
+      {
+        if (pTri[k] == from)
+        {
+          p[k] = position(to);
+        }
+      }
+      if (glm::dot(before, TriangleNormal(p[0], p[1], p[2])) <= 0)
+      {
+        isFlipping = true;
+        break;
+      }
+    }
+    if (isFlipping)
+    {
+      continue;
+    }
+
+    // Perform the collapse.
+    collapsedInto[from] = to;
+    quadrics[to] += quadrics[from];
+    ++versions[to];
+    error = std::max(error, collapse.cost);
+
+    for (uint32_t t : vertexTriangles[from])
+    {
+      if (!isTriangleAlive[t])
+      {
+        continue;
+      }
+
+      uint32_t *pTri = &triangles[3 * t];
+      if (pTri[0] == to || pTri[1] == to || pTri[2] == to)
+      {
+        isTriangleAlive[t] = false;
+        --aliveCount;
+        continue;
+      }
+
+      for (int k = 0; k < 3; ++k)
+      {
+        pTri[k] = (pTri[k] == from) ? to : pTri[k];
+      }
+      vertexTriangles[to].push_back(t);
+    }
+    vertexTriangles[from].clear();
+
+    // Requeue the edges around the merged vertex, dropping dead triangles.
+    std::vector<uint32_t> &toTriangles = vertexTriangles[to];
+    toTriangles.erase(std::remove_if(toTriangles.begin(), toTriangles.end(),
+                                     [&](uint32_t t) { return !isTriangleAlive[t]; }),
+                      toTriangles.end());
+    for (uint32_t t : toTriangles)
+    {
+      for (int k = 0; k < 3; ++k)
+      {
+        uint32_t other = triangles[3 * t + k];
+        if (other != to)
+        {
+          pushCollapse(to, other);
+          pushCollapse(other, to);
+        }
+      }
+    }
+  }
+
+  // Write out the remaining triangles, keeping the original vertex (and so
+  // its attributes) for every corner that wasn't collapsed.
+  size_t outCount = 0;
+  for (size_t t = 0; t < triangleCount; ++t)
+  {
+    if (!isTriangleAlive[t])
+    {
+      continue;
+    }
+
+    for (int k = 0; k < 3; ++k)
+    {
+      uint32_t original = indices[3 * t + k];
+      uint32_t vertex = triangles[3 * t + k];
+      indices[outCount++] = (weldedIds[original] == vertex) ? original
+                                                            : representatives[vertex];
+    }
+  }
+  indices.resize(outCount);
+
+  return float(std::sqrt(error));
+}
+
+std::vector<MeshCooker::Lod> MeshCooker::GenerateLods(
+    const std::vector<glm::vec3> &positions, std::vector<uint32_t> &indices,
+    size_t maxLodCount)
+{
+  // Don't bother creating LODs that save less than this.
+  const float kMinReduction = .8f;
+  const size_t kMinIndexCount = 3 * 16;
+
+  std::vector<Lod> lods;
+  lods.push_back({0, uint32_t(indices.size()), 0.f});
+
+  std::vector<uint32_t> lodIndices(indices);
+  while (lods.size() < maxLodCount && lodIndices.size() > kMinIndexCount)
+  {
+    const size_t previousCount = lodIndices.size();
+    float error = Simplify(positions, lodIndices, previousCount / 2, FLT_MAX);
+    if (lodIndices.empty() || lodIndices.size() > previousCount * kMinReduction)
+    {
+      break;
+    }
+
+    // Errors are measured against the previous LOD, so they accumulate.
+    error += lods.back().error;
+    lods.push_back({uint32_t(indices.size()), uint32_t(lodIndices.size()), error});
+    indices.insert(indices.end(), lodIndices.begin(), lodIndices.end());
+  }
+
+  return lods;
+}
+
+size_t MeshCooker::DeduplicateVertices(void *pVertices, size_t vertexCount,
+                                       size_t vertexSize, std::vector<uint32_t> &indices)
+{
+  char *pData = static_cast<char *>(pVertices);
+
+  std::vector<uint32_t> remap(vertexCount);
+  std::unordered_map<std::string, uint32_t> vertexIds;
+  size_t uniqueCount = 0;
+  for (size_t i = 0; i < vertexCount; ++i)
+  {
+    std::string key(pData + i * vertexSize, vertexSize);
+    auto result = vertexIds.emplace(std::move(key), uint32_t(uniqueCount));
+    if (result.second)
+    {
+      if (uniqueCount != i)
+      {
+        memcpy(pData + uniqueCount * vertexSize, pData + i * vertexSize, vertexSize);
+      }
+      ++uniqueCount;
+    }
+    remap[i] = result.first->second;
+  }
+
+  for (uint32_t &index : indices)
+  {
+    index = remap[index];
+  }
+
+  return uniqueCount;
+}
+
+void MeshCooker::OptimizeVertexCache(uint32_t *pIndices, size_t indexCount,
+                                     size_t vertexCount)
+{
+  const size_t triangleCount = indexCount / 3;
+  if (triangleCount == 0)
+  {
+    return;
+  }
+
+  // Triangles using each vertex, stored back to back. The first
+  // remainingValence[v] entries of a vertex's range are its unemitted triangles.
+  std::vector<uint32_t> remainingValence(vertexCount, 0);
+  for (size_t i = 0; i < triangleCount * 3; ++i)
+  {
+    ++remainingValence[pIndices[i]];
+  }
+
+  std::vector<uint32_t> firstTriangle(vertexCount + 1, 0);
+  for (size_t v = 0; v < vertexCount; ++v)
+  {
+    firstTriangle[v + 1] = firstTriangle[v] + remainingValence[v];
+  }
+
+  std::vector<uint32_t> vertexTriangles(triangleCount * 3);
+  {
+    std::vector<uint32_t> fill(firstTriangle.begin(), firstTriangle.end() - 1);
+    for (size_t i = 0; i < triangleCount * 3; ++i)
+    {
+      vertexTriangles[fill[pIndices[i]]++] = uint32_t(i / 3);
+    }
+  }
+
+  std::vector<int> cachePositions(vertexCount, -1);
+  std::vector<float> vertexScores(vertexCount);
+  for (size_t v = 0; v < vertexCount; ++v)
+  {
+    vertexScores[v] = VertexScore(-1, remainingValence[v]);
+  }
+
+  std::vector<float> triangleScores(triangleCount);
+  for (size_t t = 0; t < triangleCount; ++t)
+  {
+    const uint32_t *pTri = &pIndices[3 * t];
+    triangleScores[t] = vertexScores[pTri[0]] + vertexScores[pTri[1]] + vertexScores[pTri[2]];
+  }
+
+  std::vector<bool> isEmitted(triangleCount, false);
+  std::vector<uint32_t> output;
+  output.reserve(triangleCount * 3);
+
+  // The cache holds up to 3 extra entries, for vertices pushed out by the
+  // triangle being emitted.
+  uint32_t cache[kCacheSize + 3];
+  uint32_t newCache[kCacheSize + 3];
+  size_t cacheCount = 0;
+
+  size_t deadEndCursor = 0;
+  size_t bestTriangle = std::max_element(triangleScores.begin(), triangleScores.end()) -
+                        triangleScores.begin();
+  while (bestTriangle != triangleCount)
+  {
+    const uint32_t *pTri = &pIndices[3 * bestTriangle];
+    output.insert(output.end(), pTri, pTri + 3);
+    isEmitted[bestTriangle] = true;
+
+    // Remove the triangle from its vertices' lists of remaining triangles.
+    for (int k = 0; k < 3; ++k)
+    {
+      const uint32_t vertex = pTri[k];
+      uint32_t *pBegin = &vertexTriangles[firstTriangle[vertex]];
+      uint32_t *pEnd = pBegin + remainingValence[vertex];
+      std::swap(*std::find(pBegin, pEnd, uint32_t(bestTriangle)), *(pEnd - 1));
+      --remainingValence[vertex];
+    }
+
+    // Move the triangle's vertices to the front of the cache.
+    size_t newCacheCount = 0;
+    for (int k = 0; k < 3; ++k)
+    {
+      newCache[newCacheCount++] = pTri[k];
+    }
+    for (size_t i = 0; i < cacheCount; ++i)
+    {
+      const uint32_t vertex = cache[i];
+      if (vertex != pTri[0] && vertex != pTri[1] && vertex != pTri[2])
+      {
+        newCache[newCacheCount++] = vertex;
+      }
+    }
+
+    // Rescore the vertices whose cache position changed, along with their
+    // remaining triangles, and pick the best of those triangles to go next.
+    bestTriangle = triangleCount;
+    float bestScore = -FLT_MAX;
+    for (size_t i = 0; i < newCacheCount; ++i)
+    {
+      const uint32_t vertex = newCache[i];
+      const int position = (i < kCacheSize) ? int(i) : -1;
+      cachePositions[vertex] = position;
+
+      const float score = VertexScore(position, remainingValence[vertex]);
+      const float delta = score - vertexScores[vertex];
+      vertexScores[vertex] = score;
+
+      const uint32_t *pBegin = &vertexTriangles[firstTriangle[vertex]];
+      for (const uint32_t *pT = pBegin; pT != pBegin + remainingValence[vertex]; ++pT)
+      {
+        triangleScores[*pT] += delta;
+        if (triangleScores[*pT] > bestScore)
+        {
+          bestScore = triangleScores[*pT];
+          bestTriangle = *pT;
+        }
+      }
+    }
+
+    cacheCount = std::min(newCacheCount, kCacheSize);
+    std::copy(newCache, newCache + cacheCount, cache);
+
+    // Dead end: nothing in the cache has triangles left, so continue with the
+    // next unemitted triangle in the original order.
+    if (bestTriangle == triangleCount)
+    {
+      while (deadEndCursor < triangleCount && isEmitted[deadEndCursor])
+      {
+        ++deadEndCursor;
+      }
+      bestTriangle = deadEndCursor;
+    }
+  }
+
+  std::copy(output.begin(), output.end(), pIndices);
+}
+
+void MeshCooker::OptimizeOverdraw(uint32_t *pIndices, size_t indexCount,
+                                  const std::vector<glm::vec3> &positions)
+{
+  struct Cluster
+  {
+    size_t firstTriangle;
+    size_t triangleCount;
+    float sortKey;
+  };
+
+  // Counts the cache misses of each triangle, on a FIFO cache.
+  struct CacheSimulator
+  {
+    uint32_t fifo[kOverdrawCacheSize];
+    size_t count = 0;
+    size_t head = 0;
+
+    int Misses(const uint32_t *pTri)
+    {
+      int misses = 0;
+      for (int k = 0; k < 3; ++k)
+      {
+        if (std::find(fifo, fifo + count, pTri[k]) == fifo + count)
+        {
+          ++misses;
+          fifo[head] = pTri[k];
+          head = (head + 1) % kOverdrawCacheSize;
+          count = std::min(count + 1, kOverdrawCacheSize);
+        }
+      }
+      return misses;
+    }
+  };
+
+  const size_t triangleCount = indexCount / 3;
+
+  // Hard boundaries are where a triangle misses the cache on every vertex.
+  std::vector<size_t> hardBoundaries;
+  {
+    CacheSimulator cache;
+    for (size_t t = 0; t < triangleCount; ++t)
+    {
+      if (cache.Misses(&pIndices[3 * t]) == 3 || t == 0)
+      {
+        hardBoundaries.push_back(t);
+      }
+    }
+    hardBoundaries.push_back(triangleCount);
+  }
+
+  // Those are too rare on well optimized meshes, so split further wherever
+  // the misses so far, starting from a cold cache, are within a threshold of
+  // the whole cluster's. The extra misses this causes are bounded by it.
+  std::vector<Cluster> clusters;
+  for (size_t h = 0; h + 1 < hardBoundaries.size(); ++h)
+  {
+    const size_t begin = hardBoundaries[h];
+    const size_t end = hardBoundaries[h + 1];
+
+    CacheSimulator clusterCache;
+    size_t clusterMisses = 0;
+    for (size_t t = begin; t < end; ++t)
+    {
+      clusterMisses += clusterCache.Misses(&pIndices[3 * t]);
+    }
+    const float threshold = kOverdrawThreshold * clusterMisses / (end - begin);
+
+    CacheSimulator cache;
+    size_t misses = 0;
+    clusters.push_back({begin, 0, 0.f});
+    for (size_t t = begin; t < end; ++t)
+    {
+      misses += cache.Misses(&pIndices[3 * t]);
+      ++clusters.back().triangleCount;
+
+      if (t + 1 < end && misses <= threshold * clusters.back().triangleCount)
+      {
+        cache = CacheSimulator();
+        misses = 0;
+        clusters.push_back({t + 1, 0, 0.f});
+      }
+    }
+  }
+  if (clusters.size() < 2)
+  {
+    return;
+  }
+
+  // Find the (area weighted) centroid and normal of each cluster, and of the
+  // whole mesh.
+  std::vector<glm::vec3> centroids(clusters.size());
+  std::vector<glm::vec3> normals(clusters.size());
+  glm::vec3 meshCentroid(0.f);
+  float meshArea = 0.f;
+  for (size_t c = 0; c < clusters.size(); ++c)
+  {
+    glm::vec3 centroid(0.f);
+    glm::vec3 normal(0.f);
+    float area = 0.f;
+
+    const size_t end = clusters[c].firstTriangle + clusters[c].triangleCount;
+    for (size_t t = clusters[c].firstTriangle; t < end; ++t)
+    {
+      const glm::vec3 &p0 = positions[pIndices[3 * t]];
+      const glm::vec3 &p1 = positions[pIndices[3 * t + 1]];
+      const glm::vec3 &p2 = positions[pIndices[3 * t + 2]];
+      glm::vec3 triangleNormal = TriangleNormal(p0, p1, p2);
+      float triangleArea = glm::length(triangleNormal);
+
+      centroid += (p0 + p1 + p2) * (triangleArea / 3.f);
+      normal += triangleNormal;
+      area += triangleArea;
+    }
+
+    meshCentroid += centroid;
+    meshArea += area;
+    centroids[c] = (area > 0) ? centroid / area : centroid;
+    normals[c] = normal;
+  }
+  if (meshArea > 0)
+  {
+    meshCentroid /= meshArea;
+  }
+
+  // Clusters facing away from the center are on the outside of the mesh, so
+  // they're likely to occlude the rest of it.
+  for (size_t c = 0; c < clusters.size(); ++c)
+  {
+    float length = glm::length(normals[c]);
+    clusters[c].sortKey =
+        (length > 0) ? glm::dot(centroids[c] - meshCentroid, normals[c] / length) : 0.f;
+  }
+  std::stable_sort(clusters.begin(), clusters.end(),
+                   [](const Cluster &a, const Cluster &b) { return a.sortKey > b.sortKey; });
+
+  std::vector<uint32_t> output;
+  output.reserve(triangleCount * 3);
+  for (const Cluster &cluster : clusters)
+  {
+    const uint32_t *pFirst = &pIndices[3 * cluster.firstTriangle];
+    output.insert(output.end(), pFirst, pFirst + 3 * cluster.triangleCount);
+  }
+  std::copy(output.begin(), output.end(), pIndices);
+}
+
+size_t MeshCooker::OptimizeVertexFetch(void *pVertices, size_t vertexCount,
+                                       size_t vertexSize, std::vector<uint32_t> &indices)
+{
+  const uint32_t kUnused = ~0u;
+  std::vector<uint32_t> remap(vertexCount, kUnused);
+  uint32_t usedCount = 0;
+  for (uint32_t &index : indices)
+  {
+    if (remap[index] == kUnused)
+    {
+      remap[index] = usedCount++;
+    }
+    index = remap[index];
+  }
+
+  char *pData = static_cast<char *>(pVertices);
+  std::vector<char> reordered(usedCount * vertexSize);
+  for (size_t i = 0; i < vertexCount; ++i)
+  {
+    if (remap[i] != kUnused)
+    {
+      memcpy(&reordered[remap[i] * vertexSize], pData + i * vertexSize, vertexSize);
+    }
+  }
+  std::copy(reordered.begin(), reordered.end(), pData);
+
+  return usedCount;
+}
+
+}  // namespace tetrad
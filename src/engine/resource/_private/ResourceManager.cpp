@@ -1,5 +1,8 @@
 #include "engine/resource/ResourceManager.h"
 
+#include <algorithm>
+#include <limits>
+
 #include "core/Log.h"
 #include "core/Package.h"
 #include "core/Paths.h"
@@ -19,7 +22,9 @@ namespace tetrad {
 
 // Static member variable initialization
 std::unordered_map<std::string, GLuint> ResourceManager::s_Textures;
+std::vector<GLuint> ResourceManager::s_DeletedTextures;
 std::unordered_map<std::string, ModelResource> ResourceManager::s_Models;
+std::unordered_map<std::string, ModelGeometry> ResourceManager::s_Geometries;
 std::unordered_map<std::string, Font> ResourceManager::s_Fonts;
 
 typedef PackageFormat::TextureHeader TextureHeader;
@@ -37,7 +42,7 @@ ModelResource ResourceManager::LoadShape(ShapeType type)
       return LoadModel(MODEL_PATH + "cube.obj");
 
     default:
-      return ModelResource{0, 0, 0};
+      return ModelResource{};
   }
 }
 
@@ -48,11 +53,11 @@ ModelResource ResourceManager::LoadModel(std::string path)
   {
     // Load assimp scene from file
     Assimp::Importer importer;
-    const aiScene *pScene = importer.ReadFile(path, 0);
+    const aiScene *pScene = importer.ReadFile(path, aiProcess_Triangulate);
     if (!pScene)
     {
       LOG_ERROR(importer.GetErrorString() << "\n");
-      return ModelResource{0, 0, 0};
+      return ModelResource{};
     }
 
     // Get the first (and usually the only) mesh in a scene
@@ -73,17 +78,52 @@ ModelResource ResourceManager::LoadModel(std::string path)
     }
 
     // Setup indices
-    // NOTE: Assumes faces consist only of triangles (no quads),
-    // which is a very fair assumption for games
-    std::vector<unsigned int> indices;
+    // NOTE: Polygons are triangulated on import, so only points and lines
+    // need to be skipped here
+    std::vector<uint32_t> indices;
     indices.reserve(3 * pMesh->mNumFaces);
     for (unsigned int i = 0; i < pMesh->mNumFaces; ++i)
     {
+      if (pMesh->mFaces[i].mNumIndices != 3)
+      {
+        continue;
+      }
       indices.push_back(pMesh->mFaces[i].mIndices[0]);
       indices.push_back(pMesh->mFaces[i].mIndices[1]);
       indices.push_back(pMesh->mFaces[i].mIndices[2]);
     }
 
+    if (indices.empty())
+    {
+      LOG_ERROR("Model " << path << " has no triangles\n");
+      return ModelResource{};
+    }
+
+    // Assimp doesn't share vertices between faces without post-processing.
+    vertices.resize(MeshCooker::DeduplicateVertices(
+        vertices.data(), vertices.size(), sizeof(DrawComponent::Vertex), indices));
+
+    // Append simplified versions of the mesh to the index buffer.
+    std::vector<vec3> positions;
+    positions.reserve(vertices.size());
+    for (const DrawComponent::Vertex &vertex : vertices)
+    {
+      positions.push_back(vertex.pos);
+    }
+    std::vector<MeshCooker::Lod> lods =
+        MeshCooker::GenerateLods(positions, indices, kMaxModelLods);
+
+    // Reorder each LOD's triangles for the vertex cache and overdraw, then
+    // the vertices to match the order they are fetched in.
+    for (const MeshCooker::Lod &lod : lods)
+    {
+      MeshCooker::OptimizeVertexCache(&indices[lod.firstIndex], lod.indexCount,
+                                      vertices.size());
+      MeshCooker::OptimizeOverdraw(&indices[lod.firstIndex], lod.indexCount, positions);
+    }
+    vertices.resize(MeshCooker::OptimizeVertexFetch(
+        vertices.data(), vertices.size(), sizeof(DrawComponent::Vertex), indices));
+
     GLuint VBO, IBO;
     glGenBuffers(1, &VBO);
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
@@ -92,11 +132,44 @@ ModelResource ResourceManager::LoadModel(std::string path)
 
     glGenBuffers(1, &IBO);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, IBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int),
-                 &indices[0], GL_STATIC_DRAW);
+    GLenum indexType = GL_UNSIGNED_INT;
+    if (vertices.size() <= std::numeric_limits<uint16_t>::max() + size_t(1))
+    {
+      std::vector<uint16_t> shortIndices(indices.begin(), indices.end());
+      glBufferData(GL_ELEMENT_ARRAY_BUFFER, shortIndices.size() * sizeof(uint16_t),
+                   &shortIndices[0], GL_STATIC_DRAW);
+      indexType = GL_UNSIGNED_SHORT;
+    }
+    else
+    {
+      glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint32_t),
+                   &indices[0], GL_STATIC_DRAW);
+    }
 
-    s_Models[path] = ModelResource{VBO, IBO, (GLsizei)indices.size()};
-    return s_Models[path];
+    // Keep the full-detail triangles around for picking and other queries.
+    ModelGeometry &geometry = s_Geometries[path];
+    geometry.positions.reserve(vertices.size());
+    for (const DrawComponent::Vertex &vertex : vertices)
+    {
+      geometry.positions.push_back(vertex.pos);
+    }
+    geometry.indices.assign(indices.begin(), indices.begin() + lods[0].indexCount);
+
+    ModelResource &model = s_Models[path];
+    model.m_VBO = VBO;
+    model.m_IBO = IBO;
+    model.m_IndexCount = (GLsizei)lods[0].indexCount;
+    model.m_IndexType = indexType;
+    model.m_LodCount = uint8_t(lods.size());
+    std::copy(lods.begin(), lods.end(), model.m_Lods);
+    model.m_BoundsMin = model.m_BoundsMax = geometry.positions[0];
+    for (const vec3 &position : geometry.positions)
+    {
+      model.m_BoundsMin = glm::min(model.m_BoundsMin, position);
+      model.m_BoundsMax = glm::max(model.m_BoundsMax, position);
+    }
+    model.m_pGeometry = &geometry;
+    return model;
   }
   return iter->second;
 }
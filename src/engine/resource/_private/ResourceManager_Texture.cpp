@@ -160,7 +160,7 @@ bool ResourceManager::UnloadTexture(const std::string &str)
   auto iter = s_Textures.find(str);
   if (iter != s_Textures.end())
   {
-    glDeleteTextures(1, &(iter->second));
+    DeleteTexture(iter->second);
     s_Textures.erase(iter);
     return true;
   }
@@ -172,10 +172,22 @@ void ResourceManager::UnloadAllTextures()
 {
   for (auto tex : s_Textures)
   {
-    glDeleteTextures(1, &(tex.second));
+    DeleteTexture(tex.second);
   }
 
   s_Textures.clear();
 }
 
+void ResourceManager::DeleteTexture(GLuint texture)
+{
+  glDeleteTextures(1, &texture);
+  s_DeletedTextures.push_back(texture);
+}
+
+void ResourceManager::TakeDeletedTextures(std::vector<GLuint> &textures)
+{
+  textures.insert(textures.end(), s_DeletedTextures.begin(), s_DeletedTextures.end());
+  s_DeletedTextures.clear();
+}
+
 }  // namespace tetrad
@@ -6,7 +6,8 @@
 #include "core/BaseTypes.h"
 #include "core/GlTypes.h"
 #include "core/PriorityLinkedList.h"
-#include "engine/screen/ScreenPartition.h"
+#include "engine/screen/ScreenQuadTree.h"
+#include "engine/ui/UIBase.h"
 
 namespace tetrad {
 
@@ -15,7 +16,6 @@ struct ScreenAttributes
 {
   ScreenAttributes(uint32_t width, uint32_t height, bool fullscreen = false,
                    bool isResizable = false, bool useVsync = false, uint8_t samples = 4,
-                   uint8_t partitionRows = 4, uint8_t partitionCols = 4,
                    std::string title = "Test Window");
 
   ScreenAttributes() {}
@@ -25,16 +25,15 @@ struct ScreenAttributes
 
   uint8_t m_Flags;
   uint8_t m_SampleCount;
-  uint8_t m_PartitionRows;
-  uint8_t m_PartitionCols;
 
   std::string m_Title;
 };
 
 /** @brief Class representing the game screen.
  *
- * Partitions the screen into sections for optimization purposes, and also
- * provides screen dimensions to the rest of the system
+ * Keeps track of the UI elements on the screen, in render order and in a
+ * quadtree for hit testing, and also provides screen dimensions to the rest of
+ * the system
  */
 class Screen : public ScreenAttributes
 {
@@ -54,10 +53,27 @@ class Screen : public ScreenAttributes
     EIT_UPDATED
   };
 
-  /** @brief Informs all partitions of particular UI events. */
+  /** @brief Informs the screen of particular UI events.
+   *
+   * Created elements are put on top of the other elements of their priority.
+   * Updated ones are only marked for the next layout.
+   */
   void Inform(UIComponent *, EInformType);
 
-  /** @brief Gets the UIComponent at the current screen position, if any. */
+  /** @brief Lay out the elements updated since the last layout.
+   *
+   * Each updated element gets its bounds cached and is put on top of the
+   * other elements of its priority, along with all of its children, in the
+   * order they were last updated. Each element is laid out once, even if it
+   * and its ancestors were all updated, however often that happened. Called
+   * once per frame, before the UI is drawn.
+   */
+  void UpdateLayout();
+
+  /** @brief Gets the UIComponent at the current screen position, if any.
+   *
+   * Lays out pending updates first, so that it sees every change made.
+   */
   UIComponent *FindElementAt(double x, double y);
 
   inline const uint32_t &GetWidth() const { return m_Width; }
@@ -68,16 +84,20 @@ class Screen : public ScreenAttributes
   inline const LinkedList<UIComponent> &GetRenderList() const { return m_RenderList; }
 
  private:
-  bool m_IsInitialized;
+  static_assert(UI_PRIORITY_COUNT <= 256, "Priorities must fit in stacking keys");
+  static constexpr int kStackingOrderBits = 56;
 
-  int m_PartitionCount;
+  uint64_t NextStackingKey(const UIComponent *pElem);
+  /** @brief Lay out an element and its children. */
+  void LayOut(UIComponent *pElem);
 
-  float m_WidthScaleFactor;
-  float m_HeightScaleFactor;
+  bool m_IsInitialized;
 
   GLFWwindow *m_pWindow;
 
-  std::vector<ScreenPartition> m_Partitions;
+  ScreenQuadTree m_UITree;
+  uint64_t m_NextStackingOrder;
+  std::vector<UIComponent *> m_pDirtyUI;  // In the order they were last updated
 
   PriorityLinkedList<UIComponent, UI_PRIORITY_COUNT> m_RenderList;
 };
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "core/BaseTypes.h"
+
+namespace tetrad {
+
+class UIComponent;
+
+/** @brief Quadtree of the UI elements on a screen, used for hit testing.
+ *
+ * Works in normalized screen coordinates, so resizing the window doesn't affect
+ * it. Each element is kept in the deepest node that fully contains it. A leaf
+ * splits once it holds more than kSplitCount elements, and a subtree collapses
+ * back into its root once it holds kMergeCount elements or less, so the tree
+ * adapts as UI is created, moved and deleted instead of being laid out up
+ * front.
+ *
+ * Elements are ordered by their stacking key (their priority, then the order
+ * in which they were last informed), which is how they are ordered for
+ * rendering. Finding the top-most element at a point only looks at the nodes
+ * on the path to it. Nodes keep a copy of the bounds and stacking key of their
+ * elements, so searching them doesn't touch the elements themselves. The copies
+ * aren't kept sorted, and each element knows where its copy is, so an update
+ * that leaves an element in its node just patches the copy.
+ *
+ * @note Never allocates once it has grown to the size the UI needs.
+ */
+class ScreenQuadTree
+{
+ public:
+  ScreenQuadTree();
+
+  ScreenQuadTree(const ScreenQuadTree &) = delete;
+  ScreenQuadTree &operator=(const ScreenQuadTree &) = delete;
+
+  void Insert(UIComponent *pElem, const screenBound_t &bounds, uint64_t stackingKey);
+  /** @brief Give an element new bounds and a new stacking key. */
+  void Update(UIComponent *pElem, const screenBound_t &bounds, uint64_t stackingKey);
+  void Remove(UIComponent *pElem);
+
+  /** @brief Remove all elements. */
+  void Clear();
+
+  /** @brief Gets the top-most element at a point, if any.
+   *
+   * @param x, y - in normalized screen coordinates
+   */
+  UIComponent *FindElementAt(float x, float y) const;
+
+  static constexpr int32_t kNoNode = -1;
+
+ private:
+  static constexpr size_t kSplitCount = 8;
+  static constexpr size_t kMergeCount = 4;
+  static constexpr uint8_t kMaxDepth = 8;
+
+  struct Entry
+  {
+    screenBound_t bounds;
+    uint64_t stackingKey;
+    UIComponent *pElem;
+  };
+
+  struct Node
+  {
+    float centerX;
+    float centerY;
+    float halfSize;
+    int32_t parent;
+    int32_t firstChild;  // The 4 children are consecutive, or kNoNode if a leaf
+    uint32_t subtreeCount;
+    uint8_t depth;
+    std::vector<Entry> entries;  // In no particular order
+  };
+
+  static bool IsStackedBelow(const Entry &lhs, const Entry &rhs)
+  {
+    return lhs.stackingKey < rhs.stackingKey;
+  }
+
+  static bool Contains(const Node &node, const screenBound_t &bounds);
+  /** @return The quadrant of the node that fully contains bounds, or -1. */
+  static int FindQuadrant(const Node &node, const screenBound_t &bounds);
+
+  /** @brief Add an element to a node, without updating subtree counts. */
+  void AddToNode(int32_t nodeIndex, const Entry &entry);
+  /** @brief Remove an element from its node, without updating subtree counts. */
+  void RemoveFromNode(UIComponent *pElem);
+  void Split(int32_t nodeIndex);
+  /** @brief Move all the elements of a subtree into its root. */
+  void Collapse(int32_t nodeIndex);
+  void GatherEntries(int32_t nodeIndex, std::vector<Entry> &entries);
+
+  /** @return Index of 4 consecutive nodes. */
+  int32_t AcquireChildren();
+  void ReleaseChildren(int32_t firstChild);
+
+ private:
+  std::vector<Node> m_Nodes;  // The root is m_Nodes[0]
+  std::vector<int32_t> m_FreeChildren;
+};
+
+}  // namespace tetrad
@@ -1,38 +1,13 @@
 #include "engine/screen/Screen.h"
 
+#include <algorithm>
+
 #include "core/BaseTypes.h"
 #include "engine/game/CallbackContext.h"
 #include "engine/ui/UIComponent.h"
 
 namespace tetrad {
 
-#define GET_COL_FROM_X(x)          (uint8_t(m_WidthScaleFactor * (x)))
-#define GET_ROW_FROM_Y(y)          (uint8_t(m_HeightScaleFactor * (y)))
-#define GET_INDEX_UNSAFE(row, col) (int(col) + int(row) * m_PartitionCols)
-#define GET_INDEX(row, col) \
-  std::min(std::max(0, GET_INDEX_UNSAFE(row, col)), m_PartitionCount - 1)
-
-#define SAFE_ROW(row) std::min(row, uint8_t(m_PartitionRows - 1))
-#define SAFE_COL(col) std::min(col, uint8_t(m_PartitionCols - 1))
-
-#define SET_PARTITIONS_ARRAY(partitions, rectBound) \
-  {                                                 \
-    uint8_t xMin = SAFE_COL(rectBound.points[0].X); \
-    uint8_t xMax = SAFE_COL(rectBound.points[1].X); \
-    uint8_t yMax = SAFE_ROW(rectBound.points[1].Y); \
-    uint8_t yMin = SAFE_ROW(rectBound.points[0].Y); \
-    int prevI = -1;                                 \
-    for (uint8_t y = yMin; y <= yMax; ++y)          \
-    {                                               \
-      for (uint8_t x = xMin; x <= xMax; ++x)        \
-      {                                             \
-        int i = GET_INDEX(y, x);                    \
-        if (i > prevI) partitions.push_back(i);     \
-        prevI = i;                                  \
-      }                                             \
-    }                                               \
-  }
-
 enum EBitPositions
 {
   EBP_FULLSCREEN,
@@ -42,14 +17,11 @@ enum EBitPositions
 
 ScreenAttributes::ScreenAttributes(uint32_t width, uint32_t height, bool fullscreen,
                                    bool isResizable, bool useVsync, uint8_t samples,
-                                   uint8_t partitionRows, uint8_t partitionCols,
                                    std::string title)
     : m_Width(width),
       m_Height(height),
       m_Flags(0),
       m_SampleCount(samples),
-      m_PartitionRows(partitionRows),
-      m_PartitionCols(partitionCols),
       m_Title(title)
 {
   m_Flags |= (fullscreen << EBP_FULLSCREEN);
@@ -57,7 +29,7 @@ ScreenAttributes::ScreenAttributes(uint32_t width, uint32_t height, bool fullscr
   m_Flags |= (useVsync << EBP_VSYNC);
 }
 
-Screen::Screen() : m_IsInitialized(false) {}
+Screen::Screen() : m_IsInitialized(false), m_NextStackingOrder(0) {}
 
 Screen::~Screen() { Shutdown(); }
 
@@ -70,9 +42,6 @@ bool Screen::Initialize(const ScreenAttributes &attributes)
 
   // Set screen data
   *(ScreenAttributes *)this = attributes;
-  m_PartitionCount = m_PartitionRows * m_PartitionCols;
-  m_WidthScaleFactor = float(m_PartitionCols) / m_Width;
-  m_HeightScaleFactor = float(m_PartitionRows) / m_Height;
 
   // Create window
   GLFWmonitor *pMonitor = nullptr;
@@ -105,14 +74,6 @@ bool Screen::Initialize(const ScreenAttributes &attributes)
 
   m_RenderList.Initialize();
 
-  // Create partitions
-  m_Partitions.reserve(m_PartitionCount);
-  for (int i = 0; i < m_PartitionCount; ++i)
-  {
-    m_Partitions.emplace_back();
-    m_Partitions.back().m_SearchList.Initialize();
-  }
-
   m_IsInitialized = true;
   return true;
 }
@@ -121,7 +82,8 @@ void Screen::Shutdown()
 {
   if (m_IsInitialized)
   {
-    m_Partitions.clear();
+    m_UITree.Clear();
+    m_pDirtyUI.clear();
 
     glfwSetWindowShouldClose(m_pWindow, GLFW_TRUE);
     m_IsInitialized = false;
@@ -130,33 +92,40 @@ void Screen::Shutdown()
 
 void Screen::SetSize(int32_t width, int32_t height)
 {
+  // UI is kept in normalized coordinates, so only cursor positions change
   m_Width = width;
   m_Height = height;
-
-  m_WidthScaleFactor = float(m_PartitionCols) / width;
-  m_HeightScaleFactor = float(m_PartitionRows) / height;
 }
 
 void Screen::Inform(UIComponent *pElem, EInformType informType)
 {
-  // Get current partitions
-  if (informType == EIT_DELETED)
+  if (informType == EIT_UPDATED)
   {
-    // Create array of partitions this element is in
-    std::vector<int> partitions;
-    UIRectangleBound_t rBound = pElem->m_PartitionRectangle;
-    SET_PARTITIONS_ARRAY(partitions, rBound);
-
-    // Update render list
-    m_RenderList.Remove(pElem->m_RenderNode, pElem->m_Priority);
+    // Elements being dragged are updated over and over again, and stay last
+    if (!pElem->m_IsLayoutDirty)
+    {
+      pElem->m_IsLayoutDirty = true;
+      m_pDirtyUI.push_back(pElem);
+    }
+    else if (m_pDirtyUI.back() != pElem)
+    {
+      m_pDirtyUI.erase(std::find(m_pDirtyUI.begin(), m_pDirtyUI.end(), pElem));
+      m_pDirtyUI.push_back(pElem);
+    }
+    return;
+  }
 
-    // Inform partitions of deletion
-    for (int partition : partitions)
+  if (informType == EIT_DELETED)
+  {
+    if (pElem->m_IsLayoutDirty)
     {
-      DEBUG_ASSERT(partition < m_PartitionCount);
-      m_Partitions[partition].InformDeleted(pElem);
+      m_pDirtyUI.erase(std::find(m_pDirtyUI.begin(), m_pDirtyUI.end(), pElem));
+      pElem->m_IsLayoutDirty = false;
     }
 
+    m_RenderList.Remove(pElem->m_RenderNode, pElem->m_Priority);
+    m_UITree.Remove(pElem);
+
     // Ensure callback context is not caching current element
     if (CallbackContext::GetCachedUI() == pElem)
     {
@@ -166,129 +135,62 @@ void Screen::Inform(UIComponent *pElem, EInformType informType)
     return;
   }
 
-  // Create "partition rectangle"
-  screenBound_t screenBounds = pElem->GetScreenBounds();
-  screenBounds.points[0].X *= m_Width;
-  screenBounds.points[1].X *= m_Width;
-  screenBounds.points[0].Y *= m_Height;
-  screenBounds.points[1].Y *= m_Height;
-
-  uint8_t sX = GET_COL_FROM_X(screenBounds.points[0].X);
-  uint8_t sY = GET_ROW_FROM_Y(screenBounds.points[0].Y);
-  uint8_t eX = GET_COL_FROM_X(screenBounds.points[1].X);
-  uint8_t eY = GET_ROW_FROM_Y(screenBounds.points[1].Y);
-  UIRectangleBound_t rect(sX, sY, eX, eY);
-
-  std::vector<int> newPartitions;
-  SET_PARTITIONS_ARRAY(newPartitions, rect);
-
-  if (informType == EIT_CREATED)
-  {
-    // Store partition rectangle in element
-    pElem->m_PartitionRectangle.value = rect.value;
-
-    // Update render list
-    m_RenderList.PushBack(pElem->m_RenderNode, pElem->m_Priority);
+  // Put the element on top of its priority, both to render and to hit test
+  m_UITree.Insert(pElem, pElem->GetScreenBounds(), NextStackingKey(pElem));
+  m_RenderList.PushBack(pElem->m_RenderNode, pElem->m_Priority);
+}
 
-    // Inform created for relevant partitions
-    for (int partition : newPartitions)
-    {
-      DEBUG_ASSERT(partition < m_PartitionCount);
-      m_Partitions[partition].InformCreated(pElem);
-    }
-  }
-  else  // informType == EIT_UPDATED
+void Screen::UpdateLayout()
+{
+  // Elements still marked dirty are ahead in the list, and are laid out in
+  // their own turn. Until then, their ancestors' layouts skip them, and they
+  // skip those of their descendants that come before them.
+  for (UIComponent *pElem : m_pDirtyUI)
   {
-    // Update render list
-    m_RenderList.Remove(pElem->m_RenderNode, pElem->m_Priority);
-    m_RenderList.PushBack(pElem->m_RenderNode, pElem->m_Priority);
-
-    // Retrieve element's partition rectangle
-    UIRectangleBound_t rBound = pElem->m_PartitionRectangle;
+    pElem->m_IsLayoutDirty = false;
 
-    // If difference, inform created & deleted as appropriate, then
-    // update element's partition rectangle
-    if (rBound.value != rect.value)
+    UIComponent *pAncestor = pElem->GetParent();
+    while (pAncestor && !pAncestor->m_IsLayoutDirty)
     {
-      std::vector<int> oldPartitions;
-      SET_PARTITIONS_ARRAY(oldPartitions, rBound);
-
-      size_t i = 0, j = 0;
-      uint8_t oldIndex, newIndex;
-      while (i < oldPartitions.size() && j < newPartitions.size())
-      {
-        oldIndex = oldPartitions[i];
-        newIndex = newPartitions[j];
-        if (oldIndex < newIndex)
-        {
-          // oldIndex not contained in new partition list
-          DEBUG_ASSERT(oldIndex < m_PartitionCount);
-          m_Partitions[oldIndex].InformDeleted(pElem);
-          ++i;
-        }
-        else if (oldIndex > newIndex)
-        {
-          // newIndex not contained in old partition list
-          DEBUG_ASSERT(newIndex < m_PartitionCount);
-          m_Partitions[newIndex].InformCreated(pElem);
-          ++j;
-        }
-        else
-        {
-          // partition already contains relevant index
-          DEBUG_ASSERT(oldIndex < m_PartitionCount);
-          m_Partitions[oldIndex].InformUpdated(pElem);
-          ++i;
-          ++j;
-        }
-      }
-
-      // Handle leftover partitions
-      while (i < oldPartitions.size())
-      {
-        DEBUG_ASSERT(oldPartitions[i] < m_PartitionCount);
-        m_Partitions[oldPartitions[i++]].InformDeleted(pElem);
-      }
-      while (j < newPartitions.size())
-      {
-        DEBUG_ASSERT(newPartitions[j] < m_PartitionCount);
-        m_Partitions[newPartitions[j++]].InformCreated(pElem);
-      }
-
-      // Update element's partition rectangle
-      pElem->m_PartitionRectangle.value = rect.value;
+      pAncestor = pAncestor->GetParent();
     }
-    else
-    {
-      // Update all partitions
-      for (int partition : newPartitions)
-      {
-        DEBUG_ASSERT(partition < m_PartitionCount);
-        m_Partitions[partition].InformUpdated(pElem);
-      }
-    }
-
-    // Update all children UI as well
-    for (UIComponent *pUI : pElem->GetChildren())
+    if (!pAncestor)
     {
-      Inform(pUI, EIT_UPDATED);
+      LayOut(pElem);
     }
   }
+  m_pDirtyUI.clear();
 }
 
 UIComponent *Screen::FindElementAt(double x, double y)
 {
-  // Find proper partition
-  uint8_t row = GET_ROW_FROM_Y(y);
-  uint8_t col = GET_COL_FROM_X(x);
+  if (!m_pDirtyUI.empty())
+  {
+    UpdateLayout();
+  }
 
-  int i = GET_INDEX(row, col);
+  return m_UITree.FindElementAt(float(x / m_Width), float(y / m_Height));
+}
 
-  // Normalize coords
-  x /= m_Width;
-  y /= m_Height;
+uint64_t Screen::NextStackingKey(const UIComponent *pElem)
+{
+  return (uint64_t(pElem->m_Priority) << kStackingOrderBits) | m_NextStackingOrder++;
+}
 
-  return m_Partitions[i].FindElementAt(x, y);
+void Screen::LayOut(UIComponent *pElem)
+{
+  m_UITree.Update(pElem, pElem->GetScreenBounds(), NextStackingKey(pElem));
+  m_RenderList.Remove(pElem->m_RenderNode, pElem->m_Priority);
+  m_RenderList.PushBack(pElem->m_RenderNode, pElem->m_Priority);
+
+  // Update all children UI as well
+  for (UIComponent *pUI : pElem->GetChildren())
+  {
+    if (!pUI->m_IsLayoutDirty)
+    {
+      LayOut(pUI);
+    }
+  }
 }
 
 }  // namespace tetrad
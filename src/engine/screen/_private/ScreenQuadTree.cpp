@@ -0,0 +1,278 @@
+#include "engine/screen/ScreenQuadTree.h"
+
+#include "core/Log.h"
+#include "engine/ui/UIComponent.h"
+
+namespace tetrad {
+
+ScreenQuadTree::ScreenQuadTree() { Clear(); }
+
+void ScreenQuadTree::Insert(UIComponent *pElem, const screenBound_t &bounds,
+                            uint64_t stackingKey)
+{
+  DEBUG_ASSERT(pElem->m_TreeNode == kNoNode);
+  pElem->m_StackingKey = stackingKey;
+  const Entry entry = {bounds, stackingKey, pElem};
+
+  int32_t nodeIndex = 0;
+  while (true)
+  {
+    Node &node = m_Nodes[nodeIndex];
+    ++node.subtreeCount;
+    if (node.firstChild == kNoNode)
+    {
+      if (node.entries.size() < kSplitCount || node.depth == kMaxDepth)
+      {
+        AddToNode(nodeIndex, entry);
+        return;
+      }
+      Split(nodeIndex);
+    }
+
+    const Node &parent = m_Nodes[nodeIndex];
+    const int quadrant = FindQuadrant(parent, bounds);
+    if (quadrant < 0)
+    {
+      AddToNode(nodeIndex, entry);
+      return;
+    }
+    nodeIndex = parent.firstChild + quadrant;
+  }
+}
+
+void ScreenQuadTree::Update(UIComponent *pElem, const screenBound_t &bounds,
+                            uint64_t stackingKey)
+{
+  const int32_t nodeIndex = pElem->m_TreeNode;
+  DEBUG_ASSERT(nodeIndex != kNoNode);
+
+  // Small moves usually keep the element in the same node, which then doesn't
+  // need to be found again. Its entry is simply patched.
+  Node &node = m_Nodes[nodeIndex];
+  if ((nodeIndex == 0 || Contains(node, bounds)) &&
+      (node.firstChild == kNoNode || FindQuadrant(node, bounds) < 0))
+  {
+    pElem->m_StackingKey = stackingKey;
+    node.entries[pElem->m_TreeSlot] = {bounds, stackingKey, pElem};
+    return;
+  }
+
+  Remove(pElem);
+  Insert(pElem, bounds, stackingKey);
+}
+
+void ScreenQuadTree::Remove(UIComponent *pElem)
+{
+  const int32_t nodeIndex = pElem->m_TreeNode;
+  if (nodeIndex == kNoNode)
+  {
+    return;
+  }
+  RemoveFromNode(pElem);
+
+  // Collapse the biggest subtree that got small enough
+  int32_t collapseIndex = kNoNode;
+  for (int32_t i = nodeIndex; i != kNoNode; i = m_Nodes[i].parent)
+  {
+    Node &node = m_Nodes[i];
+    --node.subtreeCount;
+    if (node.firstChild != kNoNode && node.subtreeCount <= kMergeCount)
+    {
+      collapseIndex = i;
+    }
+  }
+  if (collapseIndex != kNoNode)
+  {
+    Collapse(collapseIndex);
+  }
+}
+
+void ScreenQuadTree::Clear()
+{
+  m_Nodes.clear();
+  m_FreeChildren.clear();
+
+  m_Nodes.emplace_back();
+  Node &root = m_Nodes.back();
+  root.centerX = root.centerY = root.halfSize = .5f;
+  root.parent = root.firstChild = kNoNode;
+  root.subtreeCount = 0;
+  root.depth = 0;
+}
+
+UIComponent *ScreenQuadTree::FindElementAt(float x, float y) const
+{
+  const Entry *pHit = nullptr;
+  int32_t nodeIndex = 0;
+  while (true)
+  {
+    // Elements of deeper nodes can still be stacked above the current hit
+    const Node &node = m_Nodes[nodeIndex];
+    for (const Entry &entry : node.entries)
+    {
+      const screenBound_t &bounds = entry.bounds;
+      if (bounds.points[0].X <= x && x <= bounds.points[1].X &&
+          bounds.points[0].Y <= y && y <= bounds.points[1].Y &&
+          (!pHit || IsStackedBelow(*pHit, entry)))
+      {
+        pHit = &entry;
+      }
+    }
+
+    if (node.firstChild == kNoNode)
+    {
+      return pHit ? pHit->pElem : nullptr;
+    }
+    nodeIndex = node.firstChild + (x >= node.centerX) + 2 * (y >= node.centerY);
+  }
+}
+
+bool ScreenQuadTree::Contains(const Node &node, const screenBound_t &bounds)
+{
+  return node.centerX - node.halfSize <= bounds.points[0].X &&
+         bounds.points[1].X <= node.centerX + node.halfSize &&
+         node.centerY - node.halfSize <= bounds.points[0].Y &&
+         bounds.points[1].Y <= node.centerY + node.halfSize;
+}
+
+int ScreenQuadTree::FindQuadrant(const Node &node, const screenBound_t &bounds)
+{
+  if (!Contains(node, bounds))
+  {
+    return -1;  // Only happens for the root
+  }
+
+  // Points on a center line belong to the quadrants after it
+  int quadrant = 0;
+  if (bounds.points[0].X >= node.centerX)
+  {
+    quadrant += 1;
+  }
+  else if (bounds.points[1].X >= node.centerX)
+  {
+    return -1;
+  }
+  if (bounds.points[0].Y >= node.centerY)
+  {
+    quadrant += 2;
+  }
+  else if (bounds.points[1].Y >= node.centerY)
+  {
+    return -1;
+  }
+  return quadrant;
+}
+
+void ScreenQuadTree::AddToNode(int32_t nodeIndex, const Entry &entry)
+{
+  std::vector<Entry> &entries = m_Nodes[nodeIndex].entries;
+  entry.pElem->m_TreeNode = nodeIndex;
+  entry.pElem->m_TreeSlot = uint32_t(entries.size());
+  entries.push_back(entry);
+}
+
+void ScreenQuadTree::RemoveFromNode(UIComponent *pElem)
+{
+  // Fill the hole with the last entry
+  std::vector<Entry> &entries = m_Nodes[pElem->m_TreeNode].entries;
+  const uint32_t slot = pElem->m_TreeSlot;
+  DEBUG_ASSERT(slot < entries.size() && entries[slot].pElem == pElem);
+  entries[slot] = entries.back();
+  entries[slot].pElem->m_TreeSlot = slot;
+  entries.pop_back();
+  pElem->m_TreeNode = kNoNode;
+}
+
+void ScreenQuadTree::Split(int32_t nodeIndex)
+{
+  // Acquiring can grow m_Nodes, so only refer to nodes after it
+  const int32_t firstChild = AcquireChildren();
+  Node &node = m_Nodes[nodeIndex];
+  const float quarterSize = node.halfSize / 2;
+  for (int quadrant = 0; quadrant < 4; ++quadrant)
+  {
+    Node &child = m_Nodes[firstChild + quadrant];
+    child.centerX = node.centerX + (quadrant & 1 ? quarterSize : -quarterSize);
+    child.centerY = node.centerY + (quadrant & 2 ? quarterSize : -quarterSize);
+    child.halfSize = quarterSize;
+    child.parent = nodeIndex;
+    child.firstChild = kNoNode;
+    child.subtreeCount = 0;
+    child.depth = node.depth + 1;
+    DEBUG_ASSERT(child.entries.empty());
+  }
+  node.firstChild = firstChild;
+
+  // Move down the elements that fit in a child
+  size_t keptCount = 0;
+  for (const Entry &entry : node.entries)
+  {
+    const int quadrant = FindQuadrant(node, entry.bounds);
+    if (quadrant < 0)
+    {
+      entry.pElem->m_TreeSlot = uint32_t(keptCount);
+      node.entries[keptCount++] = entry;
+      continue;
+    }
+
+    ++m_Nodes[firstChild + quadrant].subtreeCount;
+    AddToNode(firstChild + quadrant, entry);
+  }
+  node.entries.resize(keptCount, Entry{screenBound_t(0, 0, 0, 0), 0, nullptr});
+}
+
+void ScreenQuadTree::Collapse(int32_t nodeIndex)
+{
+  Node &node = m_Nodes[nodeIndex];
+  DEBUG_ASSERT(node.firstChild != kNoNode);
+  for (int quadrant = 0; quadrant < 4; ++quadrant)
+  {
+    GatherEntries(node.firstChild + quadrant, node.entries);
+  }
+  ReleaseChildren(node.firstChild);
+  node.firstChild = kNoNode;
+
+  for (uint32_t slot = 0; slot < node.entries.size(); ++slot)
+  {
+    node.entries[slot].pElem->m_TreeNode = nodeIndex;
+    node.entries[slot].pElem->m_TreeSlot = slot;
+  }
+}
+
+void ScreenQuadTree::GatherEntries(int32_t nodeIndex, std::vector<Entry> &entries)
+{
+  Node &node = m_Nodes[nodeIndex];
+  entries.insert(entries.end(), node.entries.begin(), node.entries.end());
+  node.entries.clear();
+
+  if (node.firstChild != kNoNode)
+  {
+    for (int quadrant = 0; quadrant < 4; ++quadrant)
+    {
+      GatherEntries(node.firstChild + quadrant, entries);
+    }
+    ReleaseChildren(node.firstChild);
+    node.firstChild = kNoNode;
+  }
+}
+
+int32_t ScreenQuadTree::AcquireChildren()
+{
+  if (!m_FreeChildren.empty())
+  {
+    const int32_t firstChild = m_FreeChildren.back();
+    m_FreeChildren.pop_back();
+    return firstChild;
+  }
+
+  const int32_t firstChild = int32_t(m_Nodes.size());
+  m_Nodes.resize(m_Nodes.size() + 4);
+  return firstChild;
+}
+
+void ScreenQuadTree::ReleaseChildren(int32_t firstChild)
+{
+  m_FreeChildren.push_back(firstChild);
+}
+
+}  // namespace tetrad
@@ -6,6 +6,8 @@
 #include "core/BaseTypes.h"
 #include "core/Reflection.h"
 #include "engine/ecs/IComponent.h"
+#include "engine/transform/TransformHierarchy.h"
+#include "engine/transform/TransformKernels.h"
 #include "glm/gtc/quaternion.hpp"
 #include "glm/gtx/quaternion.hpp"
 
@@ -16,18 +18,14 @@ class AttachComponent;
 class CameraComponent;
 class UIComponent;
 
-struct TransformDirs
-{
-  glm::vec3 facingDir;
-  glm::vec3 upDir;
-  glm::vec3 rightDir;
-};
-
 /** @brief Component that allows an entity to exist physically in the game world.
  *
  * Gives an entity a position, scale, and orientation. While certain entities
  * may not need this, anything that will physically exist in the game world will
  * need to have this component.
+ *
+ * The transform data itself lives in the TransformHierarchy, which stores it
+ * as structure-of-arrays for batch updates.
  */
 COMPONENT()
 class TransformComponent : public IComponent
@@ -40,26 +38,80 @@ class TransformComponent : public IComponent
 
   bool Init(const glm::vec3& position = glm::vec3(0, 0, 0),
             const glm::vec3& scale = glm::vec3(1, 1, 1));
+
+  /** @brief Get the world matrix, updating the TransformHierarchy if needed.
+   *
+   * @note The reference is only valid until the next transform is changed.
+   */
   const glm::mat4& GetWorldMatrix() const;
 
-  void MarkDirty();
-  inline bool IsDirty() const { return m_PosMatrix[0][3] == 1.f; }
+  /** @brief Get a counter that changes whenever the world matrix does. */
+  uint32_t GetWorldVersion() const;
+
+  /** @brief Get the world matrix blended between the last two simulation steps.
+   *
+   * @note Computed for every transform at once by TransformHierarchy::Interpolate,
+   *       which must have been called this frame.
+   */
+  inline const glm::mat4& GetInterpolatedWorldMatrix() const
+  {
+    return TransformHierarchy::GetGlobalInstance().GetInterpolatedWorldMatrix(
+        m_HierarchyIndex);
+  }
+  /** @brief Get the local position blended between the last two simulation steps. */
+  glm::vec3 GetInterpolatedPosition(float alpha) const;
+
+  /** @brief Remember the current state as the previous simulation step's.
+   *
+   * Called by the Game before every fixed step. Snapping the previous state to
+   * the current one avoids interpolating across teleports.
+   */
+  inline void StoreState()
+  {
+    TransformHierarchy::GetGlobalInstance().StoreState(m_HierarchyIndex);
+  }
 
-  inline const glm::vec3& GetPosition() const { return m_Position; }
-  inline const glm::quat& GetOrientation() const { return m_Orientation; }
-  inline const glm::vec3& GetScale() const { return m_Scale; }
+  void MarkDirty();
 
-  // TODO cache these values?
+  inline glm::vec3 GetPosition() const
+  {
+    return TransformHierarchy::GetGlobalInstance().GetPosition(m_HierarchyIndex);
+  }
+  inline glm::quat GetOrientation() const
+  {
+    return TransformHierarchy::GetGlobalInstance().GetOrientation(m_HierarchyIndex);
+  }
+  inline glm::vec3 GetScale() const
+  {
+    return TransformHierarchy::GetGlobalInstance().GetScale(m_HierarchyIndex);
+  }
+
+  /** @brief Get the transform relative to the world, rather than to the parent.
+   *
+   * Cached by the TransformHierarchy, and only recomputed when dirty.
+   */
   glm::vec3 GetAbsolutePosition() const;
   glm::quat GetAbsoluteOrientation() const;
   glm::vec3 GetAbsoluteScale() const;
 
   glm::vec3 GetParentScale() const;
 
-  inline const TransformDirs& GetLocalDirs() const { return m_LocalDirs; }
+  /** @brief Get the transform's slot in the TransformHierarchy. */
+  inline uint32_t GetHierarchyIndex() const { return m_HierarchyIndex; }
+
+  inline const TransformDirs& GetLocalDirs() const
+  {
+    return TransformHierarchy::GetGlobalInstance().GetLocalDirs(m_HierarchyIndex);
+  }
 
  private:
-  void UpdateDirs() const;
+  /** @brief Change the local transform, marking it dirty. */
+  void SetPosition(const glm::vec3& position);
+  void SetOrientation(const glm::quat& orientation);
+  void SetScale(const glm::vec3& scale);
+
+  /** @brief Set the parent transform, keeping the TransformHierarchy in sync. */
+  void SetParent(TransformComponent* pParent);
   // TransformComponent(const TransformComponent& that);
   // TransformComponent& operator=(const TransformComponent& that);
 
@@ -67,13 +119,9 @@ class TransformComponent : public IComponent
   friend class AttachComponent;
   friend class CameraComponent;
   friend class UIComponent;
+  friend class TransformHierarchy;
 
-  // Actual transform data goes here //
-  glm::vec3 m_Position;
-  glm::quat m_Orientation;
-  glm::vec3 m_Scale;
-  mutable TransformDirs m_LocalDirs;
-  mutable glm::mat4 m_PosMatrix;  // We use [3][0] as a dirty flag
+  uint32_t m_HierarchyIndex;  // Slot in the TransformHierarchy, with the data
 
   // TransformComponent of parent entity, if exists
   TransformComponent* m_pParentTransform;
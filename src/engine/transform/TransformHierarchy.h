@@ -0,0 +1,250 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "core/BaseTypes.h"
+#include "engine/transform/TransformKernels.h"
+
+namespace tetrad {
+
+class TransformComponent;
+
+/** @brief Flat storage of every transform, parents before children.
+ *
+ * Each transform has a slot in a set of parallel arrays, along with the index
+ * of its parent's slot. Since parents always come first, world matrices can
+ * be brought up to date in a single linear pass: a transform is recomputed if
+ * it was marked dirty, or if its parent was recomputed earlier in the pass.
+ * Marking a transform dirty is O(1), and the pass starts at the first dirty
+ * slot, skipping clean subtrees.
+ *
+ * Local transforms are stored as one array per float (see ETransformChannel),
+ * so the pass can recompute TransformKernels::kBatchSize slots at a time.
+ *
+ * Interpolated world matrices (blended between the last two simulation steps)
+ * are computed the same way, once per frame, by Interpolate. Only the slots that
+ * moved since the last StoreState and their descendants are blended. The others
+ * are drawn where they are.
+ *
+ * New transforms are appended, which keeps the order valid. It only has to be
+ * fixed (by sorting on depth) when an attach puts a parent after its child.
+ * Removed transforms leave holes that are compacted away by the same sort,
+ * once there are enough of them.
+ */
+class TransformHierarchy
+{
+ public:
+  static constexpr uint32_t kNoParent = ~0u;
+
+  TransformHierarchy();
+
+  TransformHierarchy(const TransformHierarchy &) = delete;
+  TransformHierarchy &operator=(const TransformHierarchy &) = delete;
+
+  void Add(TransformComponent &transform);
+  void Remove(TransformComponent &transform);
+  void SetParent(TransformComponent &transform, const TransformComponent *pParent);
+
+  inline void MarkDirty(uint32_t index)
+  {
+    m_IsDirty[index] = true;
+    m_FirstDirty = std::min(m_FirstDirty, index);
+  }
+
+  inline glm::vec3 GetPosition(uint32_t index) const
+  {
+    return LoadVec3(m_Channels, ETC_POSITION_X, index);
+  }
+  inline glm::quat GetOrientation(uint32_t index) const
+  {
+    return LoadQuat(m_Channels, index);
+  }
+  inline glm::vec3 GetScale(uint32_t index) const
+  {
+    return LoadVec3(m_Channels, ETC_SCALE_X, index);
+  }
+
+  /** @brief Set a local transform value. The caller must also MarkDirty. */
+  inline void SetPosition(uint32_t index, const glm::vec3 &position)
+  {
+    StoreVec3(ETC_POSITION_X, index, position);
+  }
+  inline void SetOrientation(uint32_t index, const glm::quat &orientation)
+  {
+    m_Channels[ETC_ORIENTATION_X][index] = orientation.x;
+    m_Channels[ETC_ORIENTATION_Y][index] = orientation.y;
+    m_Channels[ETC_ORIENTATION_Z][index] = orientation.z;
+    m_Channels[ETC_ORIENTATION_W][index] = orientation.w;
+    m_AreDirsStale[index] = true;
+  }
+  inline void SetScale(uint32_t index, const glm::vec3 &scale)
+  {
+    StoreVec3(ETC_SCALE_X, index, scale);
+  }
+
+  /** @brief Move many slots at once, marking those that moved dirty.
+   *
+   * Slot pIndices[i] is moved by ppOffsets[axis][i], plus localScale times
+   * ppLocalOffsets[axis][i] along its own right, up and facing dirs. Slots of
+   * kNoParent and null moves are skipped. Passing slots in increasing order
+   * keeps the accesses sequential.
+   */
+  void Translate(const uint32_t *pIndices, const float *const ppOffsets[3],
+                 const float *const ppLocalOffsets[3], float localScale, size_t count);
+
+  /** @brief Local transform values as of the last StoreState. */
+  inline glm::vec3 GetPrevPosition(uint32_t index) const
+  {
+    return LoadVec3(m_PrevChannels, ETC_POSITION_X, index);
+  }
+  inline glm::quat GetPrevOrientation(uint32_t index) const
+  {
+    return LoadQuat(m_PrevChannels, index);
+  }
+  inline glm::vec3 GetPrevScale(uint32_t index) const
+  {
+    return LoadVec3(m_PrevChannels, ETC_SCALE_X, index);
+  }
+
+  /** @brief Remember the local transforms of all slots, for interpolation. */
+  void StoreState();
+  void StoreState(uint32_t index);
+
+  /** @brief Get the dirs of a slot, computing them on the spot if it was rotated. */
+  const TransformDirs &GetLocalDirs(uint32_t index);
+
+  /** @brief Recompute the world matrices of all dirty subtrees. */
+  void Update();
+  inline bool IsUpToDate() const { return m_FirstDirty == kNoDirty && !m_NeedsRebuild; }
+
+  /** @brief Compute the world matrices blended between the last two steps.
+   *
+   * Brings the world matrices up to date first.
+   *
+   * @param alpha - how far between the previous (0) and current (1) state
+   */
+  void Interpolate(float alpha);
+
+  /** @brief Get a slot's world matrix as of the last Interpolate.
+   *
+   * @note Only valid until the next Update or Interpolate.
+   */
+  inline const glm::mat4 &GetInterpolatedWorldMatrix(uint32_t index) const
+  {
+    return m_IsMoving[index] ? m_InterpolatedMatrices[index] : m_WorldMatrices[index];
+  }
+
+  /** @brief Changes whenever slots are moved around, invalidating slot indices. */
+  inline uint32_t GetLayoutVersion() const { return m_LayoutVersion; }
+
+  /** @note Only valid until the next Update. */
+  inline const glm::mat4 &GetWorldMatrix(uint32_t index) const
+  {
+    return m_WorldMatrices[index];
+  }
+  /** @brief Number of times the world matrix in a slot has been recomputed. */
+  inline uint32_t GetWorldVersion(uint32_t index) const { return m_WorldVersions[index]; }
+
+  /** @brief Absolute transform values, cached along with the world matrix.
+   *
+   * @note Only valid until the next Update.
+   */
+  inline const glm::vec3 &GetAbsolutePosition(uint32_t index) const
+  {
+    return m_AbsolutePositions[index];
+  }
+  inline const glm::quat &GetAbsoluteOrientation(uint32_t index) const
+  {
+    return m_AbsoluteOrientations[index];
+  }
+  inline const glm::vec3 &GetAbsoluteScale(uint32_t index) const
+  {
+    return m_AbsoluteScales[index];
+  }
+
+  /** @brief Returns a static instance of TransformHierarchy. */
+  static TransformHierarchy &GetGlobalInstance()
+  {
+    static TransformHierarchy hierarchy;
+    return hierarchy;
+  }
+
+ private:
+  static constexpr uint32_t kNoDirty = ~0u;
+
+  using Channels = std::vector<float>[ETC_COUNT];
+
+  static inline glm::vec3 LoadVec3(const Channels &channels, int first, uint32_t index)
+  {
+    return glm::vec3(channels[first][index], channels[first + 1][index],
+                     channels[first + 2][index]);
+  }
+  static inline glm::quat LoadQuat(const Channels &channels, uint32_t index)
+  {
+    return glm::quat(
+        channels[ETC_ORIENTATION_W][index], channels[ETC_ORIENTATION_X][index],
+        channels[ETC_ORIENTATION_Y][index], channels[ETC_ORIENTATION_Z][index]);
+  }
+  inline void StoreVec3(int first, uint32_t index, const glm::vec3 &value)
+  {
+    m_Channels[first][index] = value.x;
+    m_Channels[first + 1][index] = value.y;
+    m_Channels[first + 2][index] = value.z;
+  }
+
+  /** @brief Blend the previous and current local transforms into m_BlendChannels. */
+  void BlendStates(float alpha);
+
+  /** @brief Recompute world matrices, kBatchSize slots at a time.
+   *
+   * @param slots - the slots to recompute, parents before their children
+   * @param isPending - which slots are being recomputed. Their children wait for
+   *        them, and read their matrix from pMatrices instead of m_WorldMatrices.
+   * @param onUpdated - called with each slot once its matrix is written
+   */
+  template <typename F>
+  void UpdateBatches(const std::vector<uint32_t> &slots, const Channels &channels,
+                     const std::vector<uint8_t> &isPending, glm::mat4 *pMatrices,
+                     TransformDirs *pDirs, F onUpdated);
+
+  /** @brief Recompute the absolute values of a slot from its parent's. */
+  void UpdateAbsolute(uint32_t index);
+
+  /** @brief Sort slots by depth, dropping removed ones. */
+  void Rebuild();
+
+ private:
+  std::vector<TransformComponent *> m_pTransforms;  // nullptr for removed transforms
+  std::vector<uint32_t> m_ParentIndices;
+  std::vector<uint8_t> m_IsDirty;
+
+  Channels m_Channels;
+  Channels m_PrevChannels;  // As of the last StoreState
+
+  std::vector<glm::mat4> m_WorldMatrices;
+  std::vector<uint32_t> m_WorldVersions;
+  std::vector<TransformDirs> m_LocalDirs;
+  std::vector<uint8_t> m_AreDirsStale;  // Rotated since the dirs were computed
+  std::vector<glm::vec3> m_AbsolutePositions;
+  std::vector<glm::quat> m_AbsoluteOrientations;
+  std::vector<glm::vec3> m_AbsoluteScales;
+
+  // Interpolation
+  std::vector<uint8_t> m_IsMoving;  // Moved since the last StoreState, or a parent did
+  Channels m_BlendChannels;
+  std::vector<glm::mat4> m_InterpolatedMatrices;  // Only valid for moving slots
+  std::vector<uint32_t> m_Levels;  // Depth within the moving subtree, for moving slots
+  std::vector<uint32_t> m_LevelStarts;   // Scratch space for Interpolate
+  std::vector<uint32_t> m_MovingLevels;  // Moving slots, a level after the other
+
+  TransformKernels::UpdateBatchFn m_UpdateBatch;
+  std::vector<uint32_t> m_DirtyIndices;  // Scratch space for Update and Interpolate
+
+  uint32_t m_FirstDirty;
+  uint32_t m_RemovedCount;
+  uint32_t m_LayoutVersion;
+  bool m_NeedsRebuild;
+};
+
+}  // namespace tetrad
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "core/BaseTypes.h"
+#include "glm/gtc/quaternion.hpp"
+
+namespace tetrad {
+
+struct TransformDirs
+{
+  glm::vec3 facingDir;
+  glm::vec3 upDir;
+  glm::vec3 rightDir;
+};
+
+/** @brief The separate arrays local transforms are stored in, one per float. */
+enum ETransformChannel
+{
+  ETC_POSITION_X,
+  ETC_POSITION_Y,
+  ETC_POSITION_Z,
+  ETC_ORIENTATION_X,
+  ETC_ORIENTATION_Y,
+  ETC_ORIENTATION_Z,
+  ETC_ORIENTATION_W,
+  ETC_SCALE_X,
+  ETC_SCALE_Y,
+  ETC_SCALE_Z,
+  ETC_COUNT
+};
+
+/** @brief Batch kernels for recomputing world matrices from local transforms.
+ *
+ * A kernel takes kBatchSize slots, composes their local translate * rotate *
+ * scale matrices, multiplies them by their parents' world matrices and
+ * recomputes their local direction vectors, all 8 at once. There are AVX2,
+ * SSE4.1 and scalar versions, and the fastest one the CPU supports is picked
+ * at runtime.
+ */
+class TransformKernels
+{
+ public:
+  static constexpr size_t kBatchSize = 8;
+
+  /** @brief Update the world matrices and dirs of kBatchSize slots.
+   *
+   * @param ppChannels - ETC_COUNT arrays of local transform values, by slot
+   * @param pIndices - the slots to update. Repeating a slot is fine.
+   * @param ppParents - the parent world matrix of each slot (or identity).
+   *        Mustn't point to a slot being updated by the same batch.
+   * @param pWorldMatrices - world matrices to write to, by slot
+   * @param pDirs - local dirs to write to, by slot, or nullptr to skip them
+   */
+  using UpdateBatchFn = void (*)(const float *const *ppChannels, const uint32_t *pIndices,
+                                 const glm::mat4 *const *ppParents,
+                                 glm::mat4 *pWorldMatrices, TransformDirs *pDirs);
+
+  /** @brief Get the fastest kernel supported by this CPU. */
+  static UpdateBatchFn GetUpdateBatch();
+  /** @brief Name of the instruction set used by GetUpdateBatch's kernel. */
+  static const char *GetInstructionSet();
+
+  /** @brief Compute the dirs of a single orientation, without any SIMD. */
+  static TransformDirs ComputeDirs(const glm::quat &orientation);
+};
+
+}  // namespace tetrad
@@ -60,8 +60,7 @@ bool AttachComponent::Attach(Entity entity)
   TransformComponent *pParent =
       EntityManager::GetComponent<TransformComponent>(m_AttachEntity);
 
-  m_pOwnedTransform->m_pParentTransform = pParent;
-  m_pOwnedTransform->MarkDirty();
+  m_pOwnedTransform->SetParent(pParent);
 
   pParent->m_ChildEntities.insert(m_Entity);
   UIComponent *pUI = EntityManager::GetComponent<UIComponent>(m_Entity);
@@ -90,7 +89,7 @@ void AttachComponent::Unattach()
       }
     }
 
-    m_pOwnedTransform->m_pParentTransform = nullptr;
+    m_pOwnedTransform->SetParent(nullptr);
     m_AttachEntity = Entity();
   }
 }
@@ -99,7 +98,7 @@ void AttachComponent::RefreshParent(TransformComponent *pParent)
 {
   if (m_pOwnedTransform->GetID() != 0)
   {
-    m_pOwnedTransform->m_pParentTransform = pParent;
+    m_pOwnedTransform->SetParent(pParent);
   }
 }
 
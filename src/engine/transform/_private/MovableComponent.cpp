@@ -21,14 +21,12 @@ void MovableComponent::Refresh()
 void MovableComponent::SetPosition(const vec3& position)
 {
   DEBUG_ASSERT(m_pTransformComp);
-  m_pTransformComp->MarkDirty();
-  m_pTransformComp->m_Position = position;
+  m_pTransformComp->SetPosition(position);
 }
 
 void MovableComponent::Move(const vec3& shift, EMoveType moveType)
 {
   DEBUG_ASSERT(m_pTransformComp);
-  m_pTransformComp->MarkDirty();
 
   vec3 moveVec;
   if (moveType == EMoveType::LOCAL)
@@ -41,7 +39,7 @@ void MovableComponent::Move(const vec3& shift, EMoveType moveType)
   {
     moveVec = shift;
   }
-  m_pTransformComp->m_Position += moveVec;
+  m_pTransformComp->SetPosition(m_pTransformComp->GetPosition() + moveVec);
 }
 
 void MovableComponent::AbsoluteMove(const vec3& shift, EMoveType moveType)
@@ -53,49 +51,40 @@ void MovableComponent::AbsoluteMove(const vec3& shift, EMoveType moveType)
 void MovableComponent::SetOrientation(const vec3& radAngles)
 {
   DEBUG_ASSERT(m_pTransformComp);
-  m_pTransformComp->MarkDirty();
-  m_pTransformComp->m_Orientation = quat(radAngles);
-  m_pTransformComp->UpdateDirs();
+  m_pTransformComp->SetOrientation(quat(radAngles));
 }
 
 void MovableComponent::Rotate(float rotationRads, const vec3& rotationAxis)
 {
   DEBUG_ASSERT(m_pTransformComp);
-  m_pTransformComp->MarkDirty();
-  m_pTransformComp->m_Orientation =
-      glm::angleAxis((rotationRads), rotationAxis) * m_pTransformComp->m_Orientation;
-  m_pTransformComp->UpdateDirs();
+  m_pTransformComp->SetOrientation(glm::angleAxis((rotationRads), rotationAxis) *
+                                   m_pTransformComp->GetOrientation());
 }
 
 void MovableComponent::Rotate(const vec3& eulerAngles)
 {
   DEBUG_ASSERT(m_pTransformComp);
-  m_pTransformComp->MarkDirty();
-  m_pTransformComp->m_Orientation = quat(eulerAngles) * m_pTransformComp->m_Orientation;
-  m_pTransformComp->UpdateDirs();
+  m_pTransformComp->SetOrientation(quat(eulerAngles) *
+                                   m_pTransformComp->GetOrientation());
 }
 
 void MovableComponent::Rotate(const mat3& rotationMatrix)
 {
   DEBUG_ASSERT(m_pTransformComp);
-  m_pTransformComp->MarkDirty();
-  m_pTransformComp->m_Orientation =
-      toQuat(rotationMatrix) * m_pTransformComp->m_Orientation;
-  m_pTransformComp->UpdateDirs();
+  m_pTransformComp->SetOrientation(toQuat(rotationMatrix) *
+                                   m_pTransformComp->GetOrientation());
 }
 
 void MovableComponent::SetScale(const vec3& scale)
 {
   DEBUG_ASSERT(m_pTransformComp);
-  m_pTransformComp->MarkDirty();
-  m_pTransformComp->m_Scale = scale;
+  m_pTransformComp->SetScale(scale);
 }
 
 void MovableComponent::Scale(const vec3& amount)
 {
   DEBUG_ASSERT(m_pTransformComp);
-  m_pTransformComp->MarkDirty();
-  m_pTransformComp->m_Scale += amount;
+  m_pTransformComp->SetScale(m_pTransformComp->GetScale() + amount);
 }
 
 }  // namespace tetrad
@@ -4,10 +4,22 @@
 
 #include "engine/ecs/EntityManager.h"
 #include "engine/transform/AttachComponent.h"
+#include "engine/transform/TransformHierarchy.h"
 
 namespace tetrad {
 
-using glm::mat3;
+namespace {
+const TransformHierarchy& GetUpdatedHierarchy()
+{
+  TransformHierarchy& hierarchy = TransformHierarchy::GetGlobalInstance();
+  if (!hierarchy.IsUpToDate())
+  {
+    hierarchy.Update();
+  }
+  return hierarchy;
+}
+}  // namespace
+
 using glm::mat4;
 using glm::quat;
 using glm::vec3;
@@ -15,7 +27,7 @@ using glm::vec3;
 TransformComponent::TransformComponent(Entity entity)
     : IComponent(entity), m_pParentTransform(nullptr)
 {
-  MarkDirty();
+  TransformHierarchy::GetGlobalInstance().Add(*this);
 }
 
 TransformComponent::~TransformComponent()
@@ -30,7 +42,7 @@ TransformComponent::~TransformComponent()
         auto pTrans = EntityManager::GetComponent<TransformComponent>(childEntity);
         if (pTrans->GetID() != 0)
         {
-          pTrans->m_pParentTransform = nullptr;
+          pTrans->SetParent(nullptr);
         }
       }
       else
@@ -39,13 +51,15 @@ TransformComponent::~TransformComponent()
       }
     }
   }
+
+  TransformHierarchy::GetGlobalInstance().Remove(*this);
 }
 
 bool TransformComponent::Init(const vec3& position, const vec3& scale)
 {
-  m_Position = position;
-  m_Scale = scale;
-  UpdateDirs();
+  SetPosition(position);
+  SetScale(scale);
+  StoreState();
   return true;
 }
 
@@ -59,67 +73,65 @@ void TransformComponent::Refresh()
 
 const mat4& TransformComponent::GetWorldMatrix() const
 {
-  if (IsDirty())
-  {
-    m_PosMatrix =
-        glm::translate(m_Position) * glm::mat4_cast(m_Orientation) * glm::scale(m_Scale);
-
-    // Note that there is an edge case where the parent-child graph of
-    // TransformComponents contains a cycle. In this case, an infinite
-    // loop is avoided by virtue of m_PosMatrix having been modified by
-    // this point.
-    //
-    // This is only true for the current implementation of MarkDirty, and
-    // more importantly, it does not make sense for there to be dependency
-    // cycles to begin with.
-    //
-    // TODO detect dependency cycles?
-    if (m_pParentTransform)
-    {
-      m_PosMatrix = m_pParentTransform->GetWorldMatrix() * m_PosMatrix;
-    }
-  }
+  return GetUpdatedHierarchy().GetWorldMatrix(m_HierarchyIndex);
+}
 
-  return m_PosMatrix;
+uint32_t TransformComponent::GetWorldVersion() const
+{
+  return GetUpdatedHierarchy().GetWorldVersion(m_HierarchyIndex);
+}
+
+vec3 TransformComponent::GetInterpolatedPosition(float alpha) const
+{
+  const TransformHierarchy& hierarchy = TransformHierarchy::GetGlobalInstance();
+  return glm::mix(hierarchy.GetPrevPosition(m_HierarchyIndex),
+                  hierarchy.GetPosition(m_HierarchyIndex), alpha);
 }
 
 void TransformComponent::MarkDirty()
 {
-  m_PosMatrix[0][3] = 1.f;
+  // Children are picked up through their parent index during the update pass.
+  TransformHierarchy::GetGlobalInstance().MarkDirty(m_HierarchyIndex);
+}
 
-  for (Entity childEntity : m_ChildEntities)
-  {
-    EntityManager::GetComponent<TransformComponent>(childEntity)->MarkDirty();
-  }
+void TransformComponent::SetParent(TransformComponent* pParent)
+{
+  m_pParentTransform = pParent;
+  TransformHierarchy::GetGlobalInstance().SetParent(*this, pParent);
+}
+
+void TransformComponent::SetPosition(const vec3& position)
+{
+  TransformHierarchy::GetGlobalInstance().SetPosition(m_HierarchyIndex, position);
+  MarkDirty();
 }
 
-void TransformComponent::UpdateDirs() const
+void TransformComponent::SetOrientation(const quat& orientation)
 {
-  mat3 orientationMatrix = toMat3(GetOrientation());
-  m_LocalDirs.facingDir = normalize(orientationMatrix * vec3(0, 0, -1));
-  m_LocalDirs.upDir = normalize(orientationMatrix * vec3(0, 1, 0));
-  m_LocalDirs.rightDir = normalize(cross(m_LocalDirs.facingDir, m_LocalDirs.upDir));
+  TransformHierarchy::GetGlobalInstance().SetOrientation(m_HierarchyIndex, orientation);
+  MarkDirty();
+}
+
+void TransformComponent::SetScale(const vec3& scale)
+{
+  TransformHierarchy::GetGlobalInstance().SetScale(m_HierarchyIndex, scale);
+  MarkDirty();
 }
 
 vec3 TransformComponent::GetAbsolutePosition() const
 {
-  if (m_pParentTransform)
-  {
-    return m_pParentTransform->GetAbsolutePosition() +
-           m_pParentTransform->GetAbsoluteScale() * m_Position;
-  }
-  return m_Position;
+  return GetUpdatedHierarchy().GetAbsolutePosition(m_HierarchyIndex);
 }
 
-#define DEFINE_ABSOLUTE(retType, val)                                                \
-  retType TransformComponent::GetAbsolute##val() const                               \
-  {                                                                                  \
-    if (m_pParentTransform) return m_##val * m_pParentTransform->GetAbsolute##val(); \
-    return m_##val;                                                                  \
-  }
+quat TransformComponent::GetAbsoluteOrientation() const
+{
+  return GetUpdatedHierarchy().GetAbsoluteOrientation(m_HierarchyIndex);
+}
 
-DEFINE_ABSOLUTE(quat, Orientation)
-DEFINE_ABSOLUTE(vec3, Scale)
+vec3 TransformComponent::GetAbsoluteScale() const
+{
+  return GetUpdatedHierarchy().GetAbsoluteScale(m_HierarchyIndex);
+}
 
 vec3 TransformComponent::GetParentScale() const
 {
@@ -0,0 +1,510 @@
+#include "engine/transform/TransformHierarchy.h"
+
+#include <cmath>
+
+#include "core/Log.h"
+#include "engine/transform/TransformComponent.h"
+
+namespace tetrad {
+
+namespace {
+// Compact once this fraction of slots are holes left by removed transforms.
+constexpr float kMaxRemovedFraction = .25f;
+
+// Values for new slots, in channel order: no translation or rotation, unit scale.
+constexpr float kDefaultChannels[ETC_COUNT] = {0.f, 0.f, 0.f, 0.f, 0.f,
+                                               0.f, 1.f, 1.f, 1.f, 1.f};
+
+const glm::mat4 kIdentity(1.f);
+}  // namespace
+
+TransformHierarchy::TransformHierarchy()
+    : m_UpdateBatch(TransformKernels::GetUpdateBatch()),
+      m_FirstDirty(kNoDirty),
+      m_RemovedCount(0),
+      m_LayoutVersion(0),
+      m_NeedsRebuild(false)
+{
+  LOG("Updating transforms with " << TransformKernels::GetInstructionSet()
+                                  << " kernels\n");
+}
+
+void TransformHierarchy::Add(TransformComponent &transform)
+{
+  transform.m_HierarchyIndex = uint32_t(m_pTransforms.size());
+
+  m_pTransforms.push_back(&transform);
+  m_ParentIndices.push_back(kNoParent);
+  m_IsDirty.push_back(false);
+  for (int channel = 0; channel < ETC_COUNT; ++channel)
+  {
+    m_Channels[channel].push_back(kDefaultChannels[channel]);
+    m_PrevChannels[channel].push_back(kDefaultChannels[channel]);
+  }
+  m_WorldMatrices.emplace_back(1.f);
+  m_WorldVersions.push_back(0);
+  m_LocalDirs.push_back(TransformKernels::ComputeDirs(glm::quat()));
+  m_AreDirsStale.push_back(false);
+  m_AbsolutePositions.emplace_back(0.f);
+  m_AbsoluteOrientations.emplace_back();
+  m_AbsoluteScales.emplace_back(1.f);
+  m_IsMoving.push_back(false);
+  for (int channel = 0; channel < ETC_COUNT; ++channel)
+  {
+    m_BlendChannels[channel].push_back(kDefaultChannels[channel]);
+  }
+  m_InterpolatedMatrices.emplace_back(1.f);
+  m_Levels.push_back(0);
+
+  MarkDirty(transform.m_HierarchyIndex);
+}
+
+void TransformHierarchy::Remove(TransformComponent &transform)
+{
+  const uint32_t index = transform.m_HierarchyIndex;
+  DEBUG_ASSERT(m_pTransforms[index] == &transform);
+
+  m_pTransforms[index] = nullptr;
+  m_ParentIndices[index] = kNoParent;
+  m_IsDirty[index] = false;
+  m_IsMoving[index] = false;
+
+  ++m_RemovedCount;
+  if (m_RemovedCount > m_pTransforms.size() * kMaxRemovedFraction)
+  {
+    m_NeedsRebuild = true;
+  }
+}
+
+void TransformHierarchy::SetParent(TransformComponent &transform,
+                                   const TransformComponent *pParent)
+{
+  const uint32_t index = transform.m_HierarchyIndex;
+  const uint32_t parentIndex = pParent ? pParent->m_HierarchyIndex : kNoParent;
+
+  m_ParentIndices[index] = parentIndex;
+  if (parentIndex != kNoParent && parentIndex > index)
+  {
+    m_NeedsRebuild = true;
+  }
+  MarkDirty(index);
+}
+
+void TransformHierarchy::StoreState()
+{
+  for (int channel = 0; channel < ETC_COUNT; ++channel)
+  {
+    m_PrevChannels[channel] = m_Channels[channel];
+  }
+}
+
+void TransformHierarchy::StoreState(uint32_t index)
+{
+  for (int channel = 0; channel < ETC_COUNT; ++channel)
+  {
+    m_PrevChannels[channel][index] = m_Channels[channel][index];
+  }
+}
+
+void TransformHierarchy::Translate(const uint32_t *pIndices,
+                                   const float *const ppOffsets[3],
+                                   const float *const ppLocalOffsets[3], float localScale,
+                                   size_t count)
+{
+  float *pPositionX = m_Channels[ETC_POSITION_X].data();
+  float *pPositionY = m_Channels[ETC_POSITION_Y].data();
+  float *pPositionZ = m_Channels[ETC_POSITION_Z].data();
+  uint8_t *pIsDirty = m_IsDirty.data();
+  const uint8_t *pAreDirsStale = m_AreDirsStale.data();
+  const TransformDirs *pDirs = m_LocalDirs.data();
+  uint32_t firstDirty = m_FirstDirty;
+
+  for (size_t i = 0; i < count; ++i)
+  {
+    const uint32_t index = pIndices[i];
+    if (index == kNoParent)
+    {
+      continue;
+    }
+
+    glm::vec3 offset(ppOffsets[0][i], ppOffsets[1][i], ppOffsets[2][i]);
+    const glm::vec3 localOffset(ppLocalOffsets[0][i], ppLocalOffsets[1][i],
+                                ppLocalOffsets[2][i]);
+    if (localOffset.x != 0.f || localOffset.y != 0.f || localOffset.z != 0.f)
+    {
+      const TransformDirs &dirs =
+          pAreDirsStale[index] ? GetLocalDirs(index) : pDirs[index];
+      offset += localScale * (localOffset.x * dirs.rightDir + localOffset.y * dirs.upDir +
+                              localOffset.z * dirs.facingDir);
+    }
+    if (offset.x == 0.f && offset.y == 0.f && offset.z == 0.f)
+    {
+      continue;
+    }
+
+    pPositionX[index] += offset.x;
+    pPositionY[index] += offset.y;
+    pPositionZ[index] += offset.z;
+    pIsDirty[index] = true;
+    firstDirty = std::min(firstDirty, index);
+  }
+  m_FirstDirty = firstDirty;
+}
+
+const TransformDirs &TransformHierarchy::GetLocalDirs(uint32_t index)
+{
+  // Dirs only depend on the slot's own orientation, so there's no need to
+  // wait for a full update.
+  if (m_AreDirsStale[index])
+  {
+    m_LocalDirs[index] = TransformKernels::ComputeDirs(GetOrientation(index));
+    m_AreDirsStale[index] = false;
+  }
+  return m_LocalDirs[index];
+}
+
+void TransformHierarchy::Update()
+{
+  if (m_NeedsRebuild)
+  {
+    Rebuild();
+  }
+  if (m_FirstDirty == kNoDirty)
+  {
+    return;
+  }
+
+  // Find every slot to recompute: those marked dirty, and their descendants.
+  const uint32_t count = uint32_t(m_pTransforms.size());
+  m_DirtyIndices.clear();
+  for (uint32_t i = m_FirstDirty; i < count; ++i)
+  {
+    const uint32_t parent = m_ParentIndices[i];
+    if (!m_pTransforms[i])
+    {
+      continue;
+    }
+
+    if (parent != kNoParent && m_IsDirty[parent])
+    {
+      m_IsDirty[i] = true;
+    }
+    if (m_IsDirty[i])
+    {
+      m_DirtyIndices.push_back(i);
+    }
+  }
+
+  UpdateBatches(m_DirtyIndices, m_Channels, m_IsDirty, m_WorldMatrices.data(),
+                m_LocalDirs.data(), [this](uint32_t index) {
+                  ++m_WorldVersions[index];
+                  m_AreDirsStale[index] = false;
+                  UpdateAbsolute(index);
+                });
+
+  std::fill(m_IsDirty.begin() + m_FirstDirty, m_IsDirty.end(), false);
+  m_FirstDirty = kNoDirty;
+}
+
+void TransformHierarchy::Interpolate(float alpha)
+{
+  if (!IsUpToDate())
+  {
+    Update();
+  }
+  if (alpha >= 1.f)
+  {
+    std::fill(m_IsMoving.begin(), m_IsMoving.end(), false);
+    return;
+  }
+
+  // Find the slots that moved, a channel at a time so that it vectorizes.
+  const uint32_t count = uint32_t(m_pTransforms.size());
+  uint8_t *pIsMoving = m_IsMoving.data();
+  std::fill(m_IsMoving.begin(), m_IsMoving.end(), false);
+  for (int channel = 0; channel < ETC_COUNT; ++channel)
+  {
+    const float *pCurrent = m_Channels[channel].data();
+    const float *pPrev = m_PrevChannels[channel].data();
+    for (uint32_t i = 0; i < count; ++i)
+    {
+      pIsMoving[i] |= pCurrent[i] != pPrev[i];
+    }
+  }
+
+  // Their descendants move with them. Number the levels of the moving subtrees,
+  // so that they can be blended a level at a time. Going in slot order instead
+  // would cut batches short whenever a parent is right before its child.
+  m_DirtyIndices.clear();
+  m_MovingLevels.clear();
+  uint32_t levelCount = 0;
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    const uint32_t parent = m_ParentIndices[i];
+    const bool isParentMoving = parent != kNoParent && pIsMoving[parent];
+    pIsMoving[i] = m_pTransforms[i] && (pIsMoving[i] || isParentMoving);
+    if (pIsMoving[i])
+    {
+      const uint32_t level = isParentMoving ? m_Levels[parent] + 1 : 0;
+      m_Levels[i] = level;
+      levelCount = std::max(levelCount, level + 1);
+      m_DirtyIndices.push_back(i);
+    }
+  }
+
+  // Counting sort by level, keeping slot order within each.
+  m_LevelStarts.assign(levelCount + 1, 0);
+  for (uint32_t i : m_DirtyIndices)
+  {
+    ++m_LevelStarts[m_Levels[i] + 1];
+  }
+  for (uint32_t level = 1; level <= levelCount; ++level)
+  {
+    m_LevelStarts[level] += m_LevelStarts[level - 1];
+  }
+  m_MovingLevels.resize(m_DirtyIndices.size());
+  for (uint32_t i : m_DirtyIndices)
+  {
+    m_MovingLevels[m_LevelStarts[m_Levels[i]]++] = i;
+  }
+
+  BlendStates(alpha);
+  UpdateBatches(m_MovingLevels, m_BlendChannels, m_IsMoving,
+                m_InterpolatedMatrices.data(), nullptr, [](uint32_t) {});
+}
+
+void TransformHierarchy::BlendStates(float alpha)
+{
+  // Each loop goes over plain arrays, so that it vectorizes. Blending slots that
+  // didn't move too is cheaper than skipping them.
+  const uint32_t count = uint32_t(m_pTransforms.size());
+  for (int channel : {ETC_POSITION_X, ETC_POSITION_Y, ETC_POSITION_Z, ETC_SCALE_X,
+                      ETC_SCALE_Y, ETC_SCALE_Z})
+  {
+    const float *pCurrent = m_Channels[channel].data();
+    const float *pPrev = m_PrevChannels[channel].data();
+    float *pBlend = m_BlendChannels[channel].data();
+    for (uint32_t i = 0; i < count; ++i)
+    {
+      pBlend[i] = pPrev[i] + (pCurrent[i] - pPrev[i]) * alpha;
+    }
+  }
+
+  // Normalized lerp along the shorter arc. Steps are small enough for it to be
+  // indistinguishable from a slerp.
+  const float *pX = m_Channels[ETC_ORIENTATION_X].data();
+  const float *pY = m_Channels[ETC_ORIENTATION_Y].data();
+  const float *pZ = m_Channels[ETC_ORIENTATION_Z].data();
+  const float *pW = m_Channels[ETC_ORIENTATION_W].data();
+  const float *pPrevX = m_PrevChannels[ETC_ORIENTATION_X].data();
+  const float *pPrevY = m_PrevChannels[ETC_ORIENTATION_Y].data();
+  const float *pPrevZ = m_PrevChannels[ETC_ORIENTATION_Z].data();
+  const float *pPrevW = m_PrevChannels[ETC_ORIENTATION_W].data();
+  float *pBlendX = m_BlendChannels[ETC_ORIENTATION_X].data();
+  float *pBlendY = m_BlendChannels[ETC_ORIENTATION_Y].data();
+  float *pBlendZ = m_BlendChannels[ETC_ORIENTATION_Z].data();
+  float *pBlendW = m_BlendChannels[ETC_ORIENTATION_W].data();
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    const float dot = pPrevX[i] * pX[i] + pPrevY[i] * pY[i] + pPrevZ[i] * pZ[i] +
+                      pPrevW[i] * pW[i];
+    const float prevWeight = (dot < 0.f) ? alpha - 1.f : 1.f - alpha;
+    const float x = pPrevX[i] * prevWeight + pX[i] * alpha;
+    const float y = pPrevY[i] * prevWeight + pY[i] * alpha;
+    const float z = pPrevZ[i] * prevWeight + pZ[i] * alpha;
+    const float w = pPrevW[i] * prevWeight + pW[i] * alpha;
+    const float inverseLength = 1.f / std::sqrt(x * x + y * y + z * z + w * w);
+    pBlendX[i] = x * inverseLength;
+    pBlendY[i] = y * inverseLength;
+    pBlendZ[i] = z * inverseLength;
+    pBlendW[i] = w * inverseLength;
+  }
+}
+
+template <typename F>
+void TransformHierarchy::UpdateBatches(const std::vector<uint32_t> &slots,
+                                       const Channels &channels,
+                                       const std::vector<uint8_t> &isPending,
+                                       glm::mat4 *pMatrices, TransformDirs *pDirs,
+                                       F onUpdated)
+{
+  // A batch ends early when a slot's parent is in it, since the parent's world
+  // matrix has to be final first. Slots are sorted by depth after a rebuild, so
+  // this mostly happens between levels.
+  const float *ppChannels[ETC_COUNT];
+  for (int channel = 0; channel < ETC_COUNT; ++channel)
+  {
+    ppChannels[channel] = channels[channel].data();
+  }
+
+  constexpr size_t kBatchSize = TransformKernels::kBatchSize;
+  uint32_t indices[kBatchSize];
+  const glm::mat4 *ppParents[kBatchSize];
+  for (size_t next = 0; next < slots.size();)
+  {
+    size_t laneCount = 0;
+    for (; laneCount < kBatchSize && next < slots.size(); ++laneCount, ++next)
+    {
+      const uint32_t i = slots[next];
+      const uint32_t parent = m_ParentIndices[i];
+      if (parent == kNoParent)
+      {
+        ppParents[laneCount] = &kIdentity;
+      }
+      else if (!isPending[parent])
+      {
+        ppParents[laneCount] = &m_WorldMatrices[parent];
+      }
+      else if (std::find(indices, indices + laneCount, parent) == indices + laneCount)
+      {
+        ppParents[laneCount] = &pMatrices[parent];
+      }
+      else
+      {
+        break;
+      }
+      indices[laneCount] = i;
+    }
+
+    // Pad partial batches by repeating the last slot.
+    for (size_t lane = laneCount; lane < kBatchSize; ++lane)
+    {
+      indices[lane] = indices[laneCount - 1];
+      ppParents[lane] = ppParents[laneCount - 1];
+    }
+
+    m_UpdateBatch(ppChannels, indices, ppParents, pMatrices, pDirs);
+    for (size_t lane = 0; lane < laneCount; ++lane)
+    {
+      onUpdated(indices[lane]);
+    }
+  }
+}
+
+void TransformHierarchy::UpdateAbsolute(uint32_t index)
+{
+  const uint32_t parent = m_ParentIndices[index];
+  if (parent == kNoParent)
+  {
+    m_AbsolutePositions[index] = GetPosition(index);
+    m_AbsoluteOrientations[index] = GetOrientation(index);
+    m_AbsoluteScales[index] = GetScale(index);
+    return;
+  }
+
+  // The parent is either clean or was updated in an earlier batch.
+  m_AbsolutePositions[index] =
+      m_AbsolutePositions[parent] + m_AbsoluteScales[parent] * GetPosition(index);
+  m_AbsoluteOrientations[index] = GetOrientation(index) * m_AbsoluteOrientations[parent];
+  m_AbsoluteScales[index] = GetScale(index) * m_AbsoluteScales[parent];
+}
+
+void TransformHierarchy::Rebuild()
+{
+  const uint32_t count = uint32_t(m_pTransforms.size());
+
+  // Find the depth of every live transform.
+  std::vector<uint32_t> depths(count, 0);
+  std::vector<uint32_t> order;
+  order.reserve(count - m_RemovedCount);
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    if (!m_pTransforms[i])
+    {
+      continue;
+    }
+
+    for (uint32_t parent = m_ParentIndices[i]; parent != kNoParent;
+         parent = m_ParentIndices[parent])
+    {
+      ++depths[i];
+      RELEASE_ASSERT(depths[i] < count);  // Attachments must not form a cycle
+    }
+    order.push_back(i);
+  }
+  std::stable_sort(order.begin(), order.end(),
+                   [&](uint32_t a, uint32_t b) { return depths[a] < depths[b]; });
+
+  std::vector<uint32_t> newIndices(count, kNoParent);
+  for (uint32_t i = 0; i < order.size(); ++i)
+  {
+    newIndices[order[i]] = i;
+  }
+
+  std::vector<TransformComponent *> pTransforms(order.size());
+  std::vector<uint32_t> parentIndices(order.size());
+  std::vector<uint8_t> isDirty(order.size());
+  Channels channels;
+  Channels prevChannels;
+  for (int channel = 0; channel < ETC_COUNT; ++channel)
+  {
+    channels[channel].resize(order.size());
+    prevChannels[channel].resize(order.size());
+  }
+  std::vector<glm::mat4> worldMatrices(order.size());
+  std::vector<uint32_t> worldVersions(order.size());
+  std::vector<TransformDirs> localDirs(order.size());
+  std::vector<uint8_t> areDirsStale(order.size());
+  std::vector<glm::vec3> absolutePositions(order.size());
+  std::vector<glm::quat> absoluteOrientations(order.size());
+  std::vector<glm::vec3> absoluteScales(order.size());
+  m_FirstDirty = kNoDirty;
+  for (uint32_t i = 0; i < order.size(); ++i)
+  {
+    const uint32_t old = order[i];
+    pTransforms[i] = m_pTransforms[old];
+    pTransforms[i]->m_HierarchyIndex = i;
+
+    const uint32_t parent = m_ParentIndices[old];
+    parentIndices[i] = (parent != kNoParent) ? newIndices[parent] : kNoParent;
+    isDirty[i] = m_IsDirty[old];
+    for (int channel = 0; channel < ETC_COUNT; ++channel)
+    {
+      channels[channel][i] = m_Channels[channel][old];
+      prevChannels[channel][i] = m_PrevChannels[channel][old];
+    }
+    worldMatrices[i] = m_WorldMatrices[old];
+    worldVersions[i] = m_WorldVersions[old];
+    localDirs[i] = m_LocalDirs[old];
+    areDirsStale[i] = m_AreDirsStale[old];
+    absolutePositions[i] = m_AbsolutePositions[old];
+    absoluteOrientations[i] = m_AbsoluteOrientations[old];
+    absoluteScales[i] = m_AbsoluteScales[old];
+
+    if (isDirty[i] && m_FirstDirty == kNoDirty)
+    {
+      m_FirstDirty = i;
+    }
+  }
+
+  m_pTransforms.swap(pTransforms);
+  m_ParentIndices.swap(parentIndices);
+  m_IsDirty.swap(isDirty);
+  for (int channel = 0; channel < ETC_COUNT; ++channel)
+  {
+    m_Channels[channel].swap(channels[channel]);
+    m_PrevChannels[channel].swap(prevChannels[channel]);
+  }
+  m_WorldMatrices.swap(worldMatrices);
+  m_WorldVersions.swap(worldVersions);
+  m_LocalDirs.swap(localDirs);
+  m_AreDirsStale.swap(areDirsStale);
+  m_AbsolutePositions.swap(absolutePositions);
+  m_AbsoluteOrientations.swap(absoluteOrientations);
+  m_AbsoluteScales.swap(absoluteScales);
+
+  // Interpolated matrices are recomputed from scratch every frame.
+  m_IsMoving.assign(order.size(), false);
+  for (int channel = 0; channel < ETC_COUNT; ++channel)
+  {
+    m_BlendChannels[channel].resize(order.size());
+  }
+  m_InterpolatedMatrices.resize(order.size());
+  m_Levels.resize(order.size());
+
+  m_RemovedCount = 0;
+  m_NeedsRebuild = false;
+  ++m_LayoutVersion;
+}
+
+}  // namespace tetrad
@@ -0,0 +1,418 @@
+#include "engine/transform/TransformKernels.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define TRANSFORM_KERNELS_X86
+#include <immintrin.h>
+#ifdef COMPILER_IS_MSVC
+#include <intrin.h>
+#endif  // COMPILER_IS_MSVC
+#endif
+
+// MSVC allows any intrinsic anywhere, but GCC and Clang only allow them in
+// functions compiled for an instruction set that has them.
+#ifdef COMPILER_IS_MSVC
+#define TARGET_SSE41
+#define TARGET_AVX2
+#else
+#define TARGET_SSE41 __attribute__((target("sse4.1")))
+#define TARGET_AVX2  __attribute__((target("avx2,fma")))
+#endif
+
+namespace tetrad {
+
+namespace {
+
+void UpdateBatch_Scalar(const float *const *ppChannels, const uint32_t *pIndices,
+                        const glm::mat4 *const *ppParents, glm::mat4 *pWorldMatrices,
+                        TransformDirs *pDirs)
+{
+  for (size_t lane = 0; lane < TransformKernels::kBatchSize; ++lane)
+  {
+    const uint32_t i = pIndices[lane];
+    const glm::quat orientation(ppChannels[ETC_ORIENTATION_W][i],
+                                ppChannels[ETC_ORIENTATION_X][i],
+                                ppChannels[ETC_ORIENTATION_Y][i],
+                                ppChannels[ETC_ORIENTATION_Z][i]);
+
+    glm::mat4 local(glm::mat3_cast(orientation));
+    local[0] *= ppChannels[ETC_SCALE_X][i];
+    local[1] *= ppChannels[ETC_SCALE_Y][i];
+    local[2] *= ppChannels[ETC_SCALE_Z][i];
+    local[3] = glm::vec4(ppChannels[ETC_POSITION_X][i], ppChannels[ETC_POSITION_Y][i],
+                         ppChannels[ETC_POSITION_Z][i], 1.f);
+
+    pWorldMatrices[i] = *ppParents[lane] * local;
+    if (pDirs)
+    {
+      pDirs[i] = TransformKernels::ComputeDirs(orientation);
+    }
+  }
+}
+
+#ifdef TRANSFORM_KERNELS_X86
+
+// Both SIMD kernels work on the transposed batch: one vector per matrix
+// element (column-major, like glm), with one lane per transform.
+
+TARGET_SSE41 inline __m128 Gather4(const float *pValues, const uint32_t *pIndices)
+{
+  __m128 v = _mm_load_ss(pValues + pIndices[0]);
+  v = _mm_insert_ps(v, _mm_load_ss(pValues + pIndices[1]), 0x10);
+  v = _mm_insert_ps(v, _mm_load_ss(pValues + pIndices[2]), 0x20);
+  v = _mm_insert_ps(v, _mm_load_ss(pValues + pIndices[3]), 0x30);
+  return v;
+}
+
+/** @brief Load 4 matrices into 16 vectors of their elements. */
+TARGET_SSE41 inline void LoadMatrices4(const glm::mat4 *const *ppMatrices,
+                                       __m128 *pElements)
+{
+  for (int column = 0; column < 4; ++column)
+  {
+    __m128 *pColumn = pElements + 4 * column;
+    for (int lane = 0; lane < 4; ++lane)
+    {
+      pColumn[lane] =
+          _mm_loadu_ps(reinterpret_cast<const float *>(ppMatrices[lane]) + 4 * column);
+    }
+    _MM_TRANSPOSE4_PS(pColumn[0], pColumn[1], pColumn[2], pColumn[3]);
+  }
+}
+
+/** @brief Store 16 vectors of matrix elements into 4 matrices. */
+TARGET_SSE41 inline void StoreMatrices4(const __m128 *pElements, const uint32_t *pIndices,
+                                        glm::mat4 *pMatrices)
+{
+  for (int column = 0; column < 4; ++column)
+  {
+    __m128 rows[4] = {pElements[4 * column], pElements[4 * column + 1],
+                      pElements[4 * column + 2], pElements[4 * column + 3]};
+    _MM_TRANSPOSE4_PS(rows[0], rows[1], rows[2], rows[3]);
+    for (int lane = 0; lane < 4; ++lane)
+    {
+      _mm_storeu_ps(reinterpret_cast<float *>(pMatrices + pIndices[lane]) + 4 * column,
+                    rows[lane]);
+    }
+  }
+}
+
+/** @brief Write 9 vectors of facing, up and right components into TransformDirs. */
+inline void StoreDirs(const float (*pComponents)[TransformKernels::kBatchSize],
+                      const uint32_t *pIndices, size_t laneCount, TransformDirs *pDirs)
+{
+  for (size_t lane = 0; lane < laneCount; ++lane)
+  {
+    TransformDirs &dirs = pDirs[pIndices[lane]];
+    dirs.facingDir = glm::vec3(pComponents[0][lane], pComponents[1][lane],
+                               pComponents[2][lane]);
+    dirs.upDir =
+        glm::vec3(pComponents[3][lane], pComponents[4][lane], pComponents[5][lane]);
+    dirs.rightDir =
+        glm::vec3(pComponents[6][lane], pComponents[7][lane], pComponents[8][lane]);
+  }
+}
+
+TARGET_SSE41 inline void Normalize4(__m128 &x, __m128 &y, __m128 &z)
+{
+  const __m128 length = _mm_sqrt_ps(
+      _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)));
+  x = _mm_div_ps(x, length);
+  y = _mm_div_ps(y, length);
+  z = _mm_div_ps(z, length);
+}
+
+TARGET_SSE41 void UpdateQuad_Sse41(const float *const *ppChannels,
+                                   const uint32_t *pIndices,
+                                   const glm::mat4 *const *ppParents,
+                                   glm::mat4 *pWorldMatrices, TransformDirs *pDirs)
+{
+  const __m128 one = _mm_set1_ps(1.f);
+
+  const __m128 x = Gather4(ppChannels[ETC_ORIENTATION_X], pIndices);
+  const __m128 y = Gather4(ppChannels[ETC_ORIENTATION_Y], pIndices);
+  const __m128 z = Gather4(ppChannels[ETC_ORIENTATION_Z], pIndices);
+  const __m128 w = Gather4(ppChannels[ETC_ORIENTATION_W], pIndices);
+  const __m128 x2 = _mm_add_ps(x, x);
+  const __m128 y2 = _mm_add_ps(y, y);
+  const __m128 z2 = _mm_add_ps(z, z);
+  const __m128 xx = _mm_mul_ps(x, x2), yy = _mm_mul_ps(y, y2), zz = _mm_mul_ps(z, z2);
+  const __m128 xy = _mm_mul_ps(x, y2), xz = _mm_mul_ps(x, z2), yz = _mm_mul_ps(y, z2);
+  const __m128 wx = _mm_mul_ps(w, x2), wy = _mm_mul_ps(w, y2), wz = _mm_mul_ps(w, z2);
+
+  // Rotation matrix, as in glm::mat3_cast
+  __m128 rotation[9] = {
+      _mm_sub_ps(one, _mm_add_ps(yy, zz)), _mm_add_ps(xy, wz), _mm_sub_ps(xz, wy),
+      _mm_sub_ps(xy, wz), _mm_sub_ps(one, _mm_add_ps(xx, zz)), _mm_add_ps(yz, wx),
+      _mm_add_ps(xz, wy), _mm_sub_ps(yz, wx), _mm_sub_ps(one, _mm_add_ps(xx, yy))};
+
+  // Local matrix, without the constant bottom row
+  const __m128 scale[3] = {Gather4(ppChannels[ETC_SCALE_X], pIndices),
+                           Gather4(ppChannels[ETC_SCALE_Y], pIndices),
+                           Gather4(ppChannels[ETC_SCALE_Z], pIndices)};
+  __m128 local[12];
+  for (int i = 0; i < 9; ++i)
+  {
+    local[i] = _mm_mul_ps(rotation[i], scale[i / 3]);
+  }
+  local[9] = Gather4(ppChannels[ETC_POSITION_X], pIndices);
+  local[10] = Gather4(ppChannels[ETC_POSITION_Y], pIndices);
+  local[11] = Gather4(ppChannels[ETC_POSITION_Z], pIndices);
+
+  __m128 parent[16];
+  LoadMatrices4(ppParents, parent);
+
+  __m128 world[16];
+  for (int column = 0; column < 4; ++column)
+  {
+    const __m128 *pLocal = local + 3 * column;
+    for (int row = 0; row < 4; ++row)
+    {
+      __m128 sum = (column == 3) ? parent[12 + row] : _mm_setzero_ps();
+      sum = _mm_add_ps(sum, _mm_mul_ps(parent[row], pLocal[0]));
+      sum = _mm_add_ps(sum, _mm_mul_ps(parent[4 + row], pLocal[1]));
+      sum = _mm_add_ps(sum, _mm_mul_ps(parent[8 + row], pLocal[2]));
+      world[4 * column + row] = sum;
+    }
+  }
+  StoreMatrices4(world, pIndices, pWorldMatrices);
+  if (!pDirs)
+  {
+    return;
+  }
+
+  // Facing is -Z and up is +Y, rotated. Right is their cross product.
+  __m128 fx = _mm_sub_ps(_mm_setzero_ps(), rotation[6]);
+  __m128 fy = _mm_sub_ps(_mm_setzero_ps(), rotation[7]);
+  __m128 fz = _mm_sub_ps(_mm_setzero_ps(), rotation[8]);
+  __m128 ux = rotation[3], uy = rotation[4], uz = rotation[5];
+  Normalize4(fx, fy, fz);
+  Normalize4(ux, uy, uz);
+  __m128 rx = _mm_sub_ps(_mm_mul_ps(fy, uz), _mm_mul_ps(fz, uy));
+  __m128 ry = _mm_sub_ps(_mm_mul_ps(fz, ux), _mm_mul_ps(fx, uz));
+  __m128 rz = _mm_sub_ps(_mm_mul_ps(fx, uy), _mm_mul_ps(fy, ux));
+  Normalize4(rx, ry, rz);
+
+  alignas(16) float dirs[9][TransformKernels::kBatchSize];
+  const __m128 components[9] = {fx, fy, fz, ux, uy, uz, rx, ry, rz};
+  for (int i = 0; i < 9; ++i)
+  {
+    _mm_store_ps(dirs[i], components[i]);
+  }
+  StoreDirs(dirs, pIndices, 4, pDirs);
+}
+
+TARGET_SSE41 void UpdateBatch_Sse41(const float *const *ppChannels,
+                                    const uint32_t *pIndices,
+                                    const glm::mat4 *const *ppParents,
+                                    glm::mat4 *pWorldMatrices, TransformDirs *pDirs)
+{
+  UpdateQuad_Sse41(ppChannels, pIndices, ppParents, pWorldMatrices, pDirs);
+  UpdateQuad_Sse41(ppChannels, pIndices + 4, ppParents + 4, pWorldMatrices, pDirs);
+}
+
+TARGET_AVX2 inline void Normalize8(__m256 &x, __m256 &y, __m256 &z)
+{
+  const __m256 length =
+      _mm256_sqrt_ps(_mm256_fmadd_ps(x, x, _mm256_fmadd_ps(y, y, _mm256_mul_ps(z, z))));
+  x = _mm256_div_ps(x, length);
+  y = _mm256_div_ps(y, length);
+  z = _mm256_div_ps(z, length);
+}
+
+TARGET_AVX2 inline __m256 Gather8(const float *pValues, __m256i indices)
+{
+  return _mm256_i32gather_ps(pValues, indices, sizeof(float));
+}
+
+TARGET_AVX2 inline __m256 Combine(__m128 low, __m128 high)
+{
+  return _mm256_insertf128_ps(_mm256_castps128_ps256(low), high, 1);
+}
+
+TARGET_AVX2 void UpdateBatch_Avx2(const float *const *ppChannels,
+                                  const uint32_t *pIndices,
+                                  const glm::mat4 *const *ppParents,
+                                  glm::mat4 *pWorldMatrices, TransformDirs *pDirs)
+{
+  const __m256 one = _mm256_set1_ps(1.f);
+  const __m256i indices = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(pIndices));
+
+  const __m256 x = Gather8(ppChannels[ETC_ORIENTATION_X], indices);
+  const __m256 y = Gather8(ppChannels[ETC_ORIENTATION_Y], indices);
+  const __m256 z = Gather8(ppChannels[ETC_ORIENTATION_Z], indices);
+  const __m256 w = Gather8(ppChannels[ETC_ORIENTATION_W], indices);
+  const __m256 x2 = _mm256_add_ps(x, x);
+  const __m256 y2 = _mm256_add_ps(y, y);
+  const __m256 z2 = _mm256_add_ps(z, z);
+  const __m256 xx = _mm256_mul_ps(x, x2), yy = _mm256_mul_ps(y, y2);
+  const __m256 zz = _mm256_mul_ps(z, z2), xy = _mm256_mul_ps(x, y2);
+  const __m256 xz = _mm256_mul_ps(x, z2), yz = _mm256_mul_ps(y, z2);
+  const __m256 wx = _mm256_mul_ps(w, x2), wy = _mm256_mul_ps(w, y2);
+  const __m256 wz = _mm256_mul_ps(w, z2);
+
+  // Rotation matrix, as in glm::mat3_cast
+  __m256 rotation[9] = {_mm256_sub_ps(one, _mm256_add_ps(yy, zz)),
+                        _mm256_add_ps(xy, wz),
+                        _mm256_sub_ps(xz, wy),
+                        _mm256_sub_ps(xy, wz),
+                        _mm256_sub_ps(one, _mm256_add_ps(xx, zz)),
+                        _mm256_add_ps(yz, wx),
+                        _mm256_add_ps(xz, wy),
+                        _mm256_sub_ps(yz, wx),
+                        _mm256_sub_ps(one, _mm256_add_ps(xx, yy))};
+
+  // Local matrix, without the constant bottom row
+  const __m256 scale[3] = {Gather8(ppChannels[ETC_SCALE_X], indices),
+                           Gather8(ppChannels[ETC_SCALE_Y], indices),
+                           Gather8(ppChannels[ETC_SCALE_Z], indices)};
+  __m256 local[12];
+  for (int i = 0; i < 9; ++i)
+  {
+    local[i] = _mm256_mul_ps(rotation[i], scale[i / 3]);
+  }
+  local[9] = Gather8(ppChannels[ETC_POSITION_X], indices);
+  local[10] = Gather8(ppChannels[ETC_POSITION_Y], indices);
+  local[11] = Gather8(ppChannels[ETC_POSITION_Z], indices);
+
+  __m128 parentLow[16], parentHigh[16];
+  LoadMatrices4(ppParents, parentLow);
+  LoadMatrices4(ppParents + 4, parentHigh);
+  __m256 parent[16];
+  for (int i = 0; i < 16; ++i)
+  {
+    parent[i] = Combine(parentLow[i], parentHigh[i]);
+  }
+
+  __m128 worldLow[16], worldHigh[16];
+  for (int column = 0; column < 4; ++column)
+  {
+    const __m256 *pLocal = local + 3 * column;
+    for (int row = 0; row < 4; ++row)
+    {
+      __m256 sum = (column == 3) ? parent[12 + row] : _mm256_setzero_ps();
+      sum = _mm256_fmadd_ps(parent[row], pLocal[0], sum);
+      sum = _mm256_fmadd_ps(parent[4 + row], pLocal[1], sum);
+      sum = _mm256_fmadd_ps(parent[8 + row], pLocal[2], sum);
+      worldLow[4 * column + row] = _mm256_castps256_ps128(sum);
+      worldHigh[4 * column + row] = _mm256_extractf128_ps(sum, 1);
+    }
+  }
+  StoreMatrices4(worldLow, pIndices, pWorldMatrices);
+  StoreMatrices4(worldHigh, pIndices + 4, pWorldMatrices);
+  if (!pDirs)
+  {
+    return;
+  }
+
+  // Facing is -Z and up is +Y, rotated. Right is their cross product.
+  __m256 fx = _mm256_sub_ps(_mm256_setzero_ps(), rotation[6]);
+  __m256 fy = _mm256_sub_ps(_mm256_setzero_ps(), rotation[7]);
+  __m256 fz = _mm256_sub_ps(_mm256_setzero_ps(), rotation[8]);
+  __m256 ux = rotation[3], uy = rotation[4], uz = rotation[5];
+  Normalize8(fx, fy, fz);
+  Normalize8(ux, uy, uz);
+  __m256 rx = _mm256_fmsub_ps(fy, uz, _mm256_mul_ps(fz, uy));
+  __m256 ry = _mm256_fmsub_ps(fz, ux, _mm256_mul_ps(fx, uz));
+  __m256 rz = _mm256_fmsub_ps(fx, uy, _mm256_mul_ps(fy, ux));
+  Normalize8(rx, ry, rz);
+
+  alignas(32) float dirs[9][TransformKernels::kBatchSize];
+  const __m256 components[9] = {fx, fy, fz, ux, uy, uz, rx, ry, rz};
+  for (int i = 0; i < 9; ++i)
+  {
+    _mm256_store_ps(dirs[i], components[i]);
+  }
+  StoreDirs(dirs, pIndices, TransformKernels::kBatchSize, pDirs);
+}
+
+bool SupportsSse41()
+{
+#ifdef COMPILER_IS_MSVC
+  int info[4];
+  __cpuid(info, 1);
+  return info[2] & (1 << 19);
+#else
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("sse4.1");
+#endif
+}
+
+bool SupportsAvx2()
+{
+#ifdef COMPILER_IS_MSVC
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7)
+  {
+    return false;
+  }
+
+  // Needs FMA and AVX, along with the OS saving the YMM registers.
+  __cpuid(info, 1);
+  const int kFmaAvxOsxsave = (1 << 12) | (1 << 27) | (1 << 28);
+  if ((info[2] & kFmaAvxOsxsave) != kFmaAvxOsxsave || (_xgetbv(0) & 6) != 6)
+  {
+    return false;
+  }
+
+  __cpuidex(info, 7, 0);
+  return info[1] & (1 << 5);
+#else
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+}
+
+#endif  // TRANSFORM_KERNELS_X86
+
+struct Kernel
+{
+  TransformKernels::UpdateBatchFn updateBatch;
+  const char *pInstructionSet;
+};
+
+Kernel SelectKernel()
+{
+#ifdef TRANSFORM_KERNELS_X86
+  if (SupportsAvx2())
+  {
+    return {UpdateBatch_Avx2, "AVX2"};
+  }
+  if (SupportsSse41())
+  {
+    return {UpdateBatch_Sse41, "SSE4.1"};
+  }
+#endif  // TRANSFORM_KERNELS_X86
+  return {UpdateBatch_Scalar, "scalar"};
+}
+
+const Kernel &GetKernel()
+{
+  static const Kernel kernel = SelectKernel();
+  return kernel;
+}
+
+}  // namespace
+
+TransformKernels::UpdateBatchFn TransformKernels::GetUpdateBatch()
+{
+  return GetKernel().updateBatch;
+}
+
+const char *TransformKernels::GetInstructionSet()
+{
+  return GetKernel().pInstructionSet;
+}
+
+TransformDirs TransformKernels::ComputeDirs(const glm::quat &orientation)
+{
+  const glm::mat3 rotation = glm::mat3_cast(orientation);
+
+  TransformDirs dirs;
+  dirs.facingDir = glm::normalize(-rotation[2]);
+  dirs.upDir = glm::normalize(rotation[1]);
+  dirs.rightDir = glm::normalize(glm::cross(dirs.facingDir, dirs.upDir));
+  return dirs;
+}
+
+}  // namespace tetrad
@@ -4,8 +4,6 @@
 
 namespace tetrad {
 
-typedef RectangularBound<uint8_t, uint32_t> UIRectangleBound_t;
-
 /*
    +----------+-------------------------------------------------------
    | Priority | General use-case
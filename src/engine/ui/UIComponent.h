@@ -48,15 +48,27 @@ class UIComponent : public IComponent
 
   uint8_t GetPriority() const { return m_Priority; }
 
+  /** @brief Orders elements for rendering and hit testing, bottom to top.
+   *
+   * Set by the Screen whenever it is informed of the element, from its
+   * priority and the order in which elements were informed.
+   */
+  uint64_t GetStackingKey() const { return m_StackingKey; }
+
   screenBound_t GetScreenBounds() const;
 
  protected:
   std::vector<UIComponent *> &GetChildren();
+  /** @brief The UI element this one is attached to, if any. */
+  UIComponent *GetParent() const;
 
  protected:
   friend class Screen;
-  friend class ScreenPartition;
-  UIRectangleBound_t m_PartitionRectangle;
+  friend class ScreenQuadTree;
+  uint64_t m_StackingKey;
+  int32_t m_TreeNode;   // The node of the screen's ScreenQuadTree holding it
+  uint32_t m_TreeSlot;  // Its entry in that node
+  bool m_IsLayoutDirty;
 
   friend class DrawSystem;
   GLuint m_CurrTex;
@@ -12,7 +12,10 @@ namespace tetrad {
 
 UIComponent::UIComponent(Entity entity)
     : IComponent(entity),
-      m_PartitionRectangle(0, 0, 0, 0),
+      m_StackingKey(0),
+      m_TreeNode(ScreenQuadTree::kNoNode),
+      m_TreeSlot(0),
+      m_IsLayoutDirty(false),
       m_CurrTex(0),
       m_IsMovable(false),
       m_bFollowCursor(false),
@@ -76,4 +79,16 @@ std::vector<UIComponent *> &UIComponent::GetChildren()
   return m_pTransformComp->m_pChildUI;
 }
 
+UIComponent *UIComponent::GetParent() const
+{
+  TransformComponent *pParent = m_pTransformComp->m_pParentTransform;
+  if (!pParent)
+  {
+    return nullptr;
+  }
+
+  UIComponent *pUI = EntityManager::GetComponent<UIComponent>(pParent->GetEntity());
+  return (pUI->GetEntity() != kNullEntity) ? pUI : nullptr;
+}
+
 }  // namespace tetrad
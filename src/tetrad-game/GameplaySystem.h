@@ -9,7 +9,8 @@ namespace tetrad {
 class GameplaySystem : public System
 {
  public:
-  virtual void Tick(deltaTime_t dt);
+  void Tick(deltaTime_t dt) override;
+  bool IsFixedStep() const override { return true; }
 };
 
 }  // namespace tetrad
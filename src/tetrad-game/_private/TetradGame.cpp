@@ -58,13 +58,13 @@ void TetradGame::OnInitialized()
   ObserverComponent *pObserver = entity.Add<ObserverComponent>();
   pObserver->Subscribe(*m_pInputSystem);
   pObserver->AddEvent(EGameEvent(EGE_PLAYER1_LEFT),
-                      new Action_Move(entity, Action_Move::EMD_LEFT));
+                      Action_Move(entity, Action_Move::EMD_LEFT));
   pObserver->AddEvent(EGameEvent(EGE_PLAYER1_RIGHT),
-                      new Action_Move(entity, Action_Move::EMD_RIGHT));
+                      Action_Move(entity, Action_Move::EMD_RIGHT));
   pObserver->AddEvent(EGameEvent(EGE_PLAYER1_FORWARDS),
-                      new Action_Move(entity, Action_Move::EMD_FORWARDS));
+                      Action_Move(entity, Action_Move::EMD_FORWARDS));
   pObserver->AddEvent(EGameEvent(EGE_PLAYER1_BACKWARDS),
-                      new Action_Move(entity, Action_Move::EMD_BACKWARDS));
+                      Action_Move(entity, Action_Move::EMD_BACKWARDS));
 
   // Create jumping boxes
   for (int i = 0; i < 2; ++i)
@@ -79,7 +79,7 @@ void TetradGame::OnInitialized()
     entity.Add<PhysicsComponent>();
     ObserverComponent *pObserver = entity.Add<ObserverComponent>();
     pObserver->Subscribe(*m_pInputSystem);
-    pObserver->AddEvent(EGameEvent(EGE_PLAYER1_JUMP + i), new Action_Jump(entity));
+    pObserver->AddEvent(EGameEvent(EGE_PLAYER1_JUMP + i), Action_Jump(entity));
 
     if (i == 0)
     {
@@ -108,7 +108,7 @@ void TetradGame::OnInitialized()
   pDraw->SetGeometry(ShapeType::PLANE);
   pDraw->SetTexture(PAUSE_BACKGROUND_PATH, TextureType::RGBA);
   m_FadeScreen.Add<MaterialComponent>()->SetOpacity(0.f);
-  m_pSystemObserver->AddEvent(EGE_PAUSE, new Action_PauseGame(this));
+  m_pSystemObserver->AddEvent(EGE_PAUSE, Action_PauseGame(this));
 
   // Create text
   entity = EntityManager::CreateEntity();
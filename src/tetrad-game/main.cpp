@@ -1,3 +1,4 @@
+#include <cstring>
 #include <iostream>
 
 #include "core/Platform.h"
@@ -6,7 +7,7 @@
 
 using namespace tetrad;
 
-int main()
+int main(int argc, char **argv)
 {
   if (!programInitialize())
   {
@@ -16,9 +17,43 @@ int main()
   LOG_DEBUG("Platform-specific program initialization successful\n");
 
   TetradGame game;
-  GameAttributes attributes(ScreenAttributes(1280, 960, false, false, false, 4, 4, 4,
+  GameAttributes attributes(ScreenAttributes(1280, 960, false, false, false, 4,
                                              "Tetrad " + kVersionString),
                             MouseMode::DISABLED);
+
+  // --record <file> and --replay <file> [--frame-times <csv>] (see InputRecorder),
+  // --retain-ui (see GameAttributes::m_RetainUi) and --timings <csv> (see
+  // TimingRegistry)
+  for (int i = 1; i < argc; ++i)
+  {
+    const bool hasValue = i + 1 < argc;
+    if (!std::strcmp(argv[i], "--retain-ui"))
+    {
+      attributes.m_RetainUi = true;
+    }
+    else if (hasValue && !std::strcmp(argv[i], "--record"))
+    {
+      attributes.m_InputRecordPath = argv[++i];
+    }
+    else if (hasValue && !std::strcmp(argv[i], "--replay"))
+    {
+      attributes.m_InputReplayPath = argv[++i];
+    }
+    else if (hasValue && !std::strcmp(argv[i], "--frame-times"))
+    {
+      attributes.m_FrameTimesPath = argv[++i];
+    }
+    else if (hasValue && !std::strcmp(argv[i], "--timings"))
+    {
+      attributes.m_TimingsPath = argv[++i];
+    }
+    else
+    {
+      LOG_ERROR("Unknown argument " << argv[i] << "\n");
+      return -1;
+    }
+  }
+
   if (!game.Initialize(attributes))
   {
     return -1;
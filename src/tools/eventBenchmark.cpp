@@ -0,0 +1,96 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "engine/ecs/EntityManager.h"
+#include "engine/event/EventSystem.h"
+#include "engine/event/ObserverComponent.h"
+
+using namespace std;
+using namespace tetrad;
+
+// Times EventSystem::Tick delivering 256 random events to 10k observers, each
+// with actions for one or two of the game events. Then times unsubscribing
+// half of the observers.
+
+constexpr size_t kObserverCount = 10000;
+constexpr size_t kEventsPerTick = 256;
+constexpr int kTickCount = 50;
+
+int main()
+{
+  EntityManager::Initialize();
+
+  EventSystem system;
+  system.GetEventQueue().SetCapacity(1024);
+
+  mt19937 random(1);
+  size_t calls = 0;
+  size_t subscriberCounts[EGE_END] = {};
+  vector<ObserverComponent *> pObservers;
+  for (size_t i = 0; i < kObserverCount; ++i)
+  {
+    ObserverComponent *pObserver =
+        EntityManager::CreateEntity().Add<ObserverComponent>();
+    pObserver->Subscribe(system);
+
+    const size_t eventCount = 1 + random() % 2;
+    for (size_t j = 0; j < eventCount; ++j)
+    {
+      // Skip EGE_NONE, which no observer reacts to
+      const EGameEvent event = EGameEvent(1 + random() % (EGE_END - 1));
+      if (pObserver->AddEvent(event, [&calls](EEventAction) {
+            ++calls;
+            return true;
+          }))
+      {
+        ++subscriberCounts[event];
+      }
+    }
+    pObservers.push_back(pObserver);
+  }
+
+  vector<double> times;
+  size_t expectedCalls = 0;
+  for (int i = 0; i < kTickCount; ++i)
+  {
+    for (size_t j = 0; j < kEventsPerTick; ++j)
+    {
+      Event event;
+      event.event = EGameEvent(random() % EGE_END);
+      event.action = EEventAction::ON;
+      system.Inform(event);
+      expectedCalls += subscriberCounts[event.event];
+    }
+
+    const auto start = chrono::steady_clock::now();
+    system.Tick(0.f);
+    times.push_back(
+        chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+  }
+  sort(times.begin(), times.end());
+
+  cout << kObserverCount << " observers, " << kEventsPerTick
+       << " events per tick: best " << times.front() << " ms, median "
+       << times[times.size() / 2] << " ms\n";
+  if (calls != expectedCalls)
+  {
+    cout << "Expected " << expectedCalls << " calls, but got " << calls << "\n";
+    return 1;
+  }
+
+  // Unsubscribe every other observer, in a scattered order
+  const auto start = chrono::steady_clock::now();
+  for (size_t i = 0; i < kObserverCount / 2; ++i)
+  {
+    pObservers[(i * 7919) % kObserverCount]->Unsubscribe(system);
+  }
+  cout << kObserverCount / 2 << " unsubscribes: "
+       << chrono::duration<double, milli>(chrono::steady_clock::now() - start).count()
+       << " ms\n";
+
+  EntityManager::Shutdown();
+  return 0;
+}
@@ -0,0 +1,80 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "engine/ecs/EntityManager.h"
+#include "engine/physics/Action_Move.h"
+#include "engine/physics/PhysicsBodies.h"
+#include "engine/physics/PhysicsComponent.h"
+#include "engine/transform/TransformComponent.h"
+
+using namespace std;
+using namespace tetrad;
+
+// Times PhysicsBodies::Integrate over 100k awake bodies, a third of them still,
+// the rest moving right along their own dirs. Half have gravity.
+//
+// With --shuffle, bodies are added in a random order, so that their slots don't
+// follow the hierarchy's.
+
+constexpr size_t kBodyCount = 100000;
+constexpr int kTickCount = 300;
+constexpr deltaTime_t kDeltaTime = 1.f / 60.f;
+
+int main(int argc, char **argv)
+{
+  const bool shuffle = argc > 1 && !strcmp(argv[1], "--shuffle");
+
+  EntityManager::Initialize();
+
+  vector<Entity> entities;
+  for (size_t i = 0; i < kBodyCount; ++i)
+  {
+    entities.push_back(EntityManager::CreateEntity());
+    entities.back().Add<TransformComponent>();
+  }
+
+  mt19937 random(1);
+  vector<size_t> order(kBodyCount);
+  for (size_t i = 0; i < kBodyCount; ++i)
+  {
+    order[i] = i;
+  }
+  if (shuffle)
+  {
+    std::shuffle(order.begin(), order.end(), random);
+  }
+
+  uniform_real_distribution<float> velocity(-1.f, 1.f);
+  for (size_t i : order)
+  {
+    PhysicsComponent *pPhysics = entities[i].Add<PhysicsComponent>();
+    pPhysics->SetVelocity(
+        glm::vec3(velocity(random), velocity(random), velocity(random)));
+    pPhysics->SetGravity(i % 2 == 0);
+    if (i % 3 != 0)
+    {
+      Action_Move(entities[i], Action_Move::EMD_RIGHT)(EEventAction::ON);
+    }
+  }
+
+  PhysicsBodies &bodies = PhysicsBodies::GetGlobalInstance();
+  vector<double> times;
+  for (int i = 0; i < kTickCount; ++i)
+  {
+    const auto start = chrono::steady_clock::now();
+    bodies.Integrate(kDeltaTime);
+    times.push_back(
+        chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+  }
+  sort(times.begin(), times.end());
+
+  cout << kBodyCount << " bodies" << (shuffle ? ", shuffled" : "") << ": best "
+       << times.front() << " ms, median " << times[times.size() / 2] << " ms\n";
+
+  EntityManager::Shutdown();
+  return 0;
+}
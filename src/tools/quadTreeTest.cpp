@@ -0,0 +1,122 @@
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "engine/ecs/EntityManager.h"
+#include "engine/screen/ScreenQuadTree.h"
+#include "engine/ui/UIComponent.h"
+
+using namespace std;
+using namespace tetrad;
+
+// Randomly inserts, moves, restacks and removes elements of a ScreenQuadTree,
+// and checks every hit test against a brute-force search. Elements range from
+// tiny to bigger than the screen and can hang off its edges, and most moves are
+// small, so that they keep elements in the same node.
+
+constexpr size_t kElementCount = 300;
+constexpr int kStepCount = 200000;
+constexpr int kQueriesPerStep = 4;
+
+int main()
+{
+  EntityManager::Initialize();
+
+  vector<UIComponent *> pElems;
+  for (size_t i = 0; i < kElementCount; ++i)
+  {
+    pElems.push_back(EntityManager::CreateEntity().Add<UIComponent>());
+  }
+
+  ScreenQuadTree tree;
+  vector<bool> isInTree(kElementCount, false);
+  vector<screenBound_t> bounds(kElementCount, screenBound_t(0, 0, 0, 0));
+  vector<uint64_t> stackingKeys(kElementCount, 0);
+
+  mt19937 random(7);
+  uniform_real_distribution<float> position(-.1f, 1.1f);
+  uniform_real_distribution<float> size(0.f, .3f);
+  uint64_t nextStackingOrder = 0;
+  size_t mismatchCount = 0;
+  for (int step = 0; step < kStepCount; ++step)
+  {
+    const size_t i = random() % kElementCount;
+    const float x = position(random), y = position(random);
+    const float width = size(random) * size(random) * 3;
+    screenBound_t newBounds(x, y, x + width, y + width * .7f);
+    // Priorities go down as well as up, so keys can move either way
+    const uint64_t stackingKey = (uint64_t(random() % 3) << 56) | nextStackingOrder++;
+
+    const int action = random() % 10;
+    if (!isInTree[i])
+    {
+      tree.Insert(pElems[i], newBounds, stackingKey);
+      isInTree[i] = true;
+    }
+    else if (action < 2)
+    {
+      tree.Remove(pElems[i]);
+      isInTree[i] = false;
+    }
+    else
+    {
+      if (action < 6)
+      {
+        newBounds = bounds[i];
+        newBounds.points[0].X += .003f;
+        newBounds.points[1].X += .003f;
+      }
+      tree.Update(pElems[i], newBounds, stackingKey);
+    }
+    bounds[i] = newBounds;
+    stackingKeys[i] = stackingKey;
+
+    for (int j = 0; j < kQueriesPerStep; ++j)
+    {
+      const float queryX = position(random), queryY = position(random);
+      UIComponent *pExpected = nullptr;
+      uint64_t expectedKey = 0;
+      for (size_t k = 0; k < kElementCount; ++k)
+      {
+        const screenBound_t &b = bounds[k];
+        if (isInTree[k] && b.points[0].X <= queryX && queryX <= b.points[1].X &&
+            b.points[0].Y <= queryY && queryY <= b.points[1].Y &&
+            (!pExpected || stackingKeys[k] > expectedKey))
+        {
+          pExpected = pElems[k];
+          expectedKey = stackingKeys[k];
+        }
+      }
+
+      if (tree.FindElementAt(queryX, queryY) != pExpected)
+      {
+        ++mismatchCount;
+      }
+    }
+  }
+
+  // Once emptied, nothing should be found anywhere
+  for (size_t i = 0; i < kElementCount; ++i)
+  {
+    if (isInTree[i])
+    {
+      tree.Remove(pElems[i]);
+    }
+  }
+  for (float y = -.05f; y < 1.1f; y += .05f)
+  {
+    for (float x = -.05f; x < 1.1f; x += .05f)
+    {
+      if (tree.FindElementAt(x, y))
+      {
+        ++mismatchCount;
+      }
+    }
+  }
+
+  cout << kStepCount * kQueriesPerStep << " hit tests, " << mismatchCount
+       << " mismatches\n";
+
+  EntityManager::Shutdown();
+  return mismatchCount == 0 ? 0 : 1;
+}
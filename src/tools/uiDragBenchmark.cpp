@@ -0,0 +1,110 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include "core/GlTypes.h"
+#include "engine/ecs/EntityManager.h"
+#include "engine/screen/Screen.h"
+#include "engine/transform/AttachComponent.h"
+#include "engine/transform/MovableComponent.h"
+#include "engine/transform/TransformComponent.h"
+#include "engine/ui/UIComponent.h"
+
+using namespace std;
+using namespace tetrad;
+
+// Times dragging a 200-element UI tree (a window, 19 panels and 180 widgets)
+// diagonally back and forth across a 1280x960 screen, 1 px per update, the way
+// CallbackContext::Cursor_GUI does, with a layout after every update.
+//
+// Needs a display, as the Screen opens a (hidden) window.
+
+constexpr int kPanelCount = 19;
+constexpr int kWidgetCount = 180;
+constexpr int kSweepLength = 600;  // Updates before the drag turns back
+constexpr int kBlockCount = 10;
+constexpr int kUpdatesPerBlock = 2 * kSweepLength;
+constexpr uint32_t kWidth = 1280;
+constexpr uint32_t kHeight = 960;
+
+namespace {
+
+UIComponent *CreateElement(Screen &screen, const glm::vec3 &position,
+                           const glm::vec3 &scale, UIComponent *pParent)
+{
+  Entity entity = EntityManager::CreateEntity();
+  entity.Add<TransformComponent>()->Init(position, scale);
+  entity.Add<MovableComponent>();
+  if (pParent)
+  {
+    entity.Add<AttachComponent>()->Attach(pParent->GetEntity());
+  }
+  UIComponent *pUI = entity.Add<UIComponent>();
+  pUI->Init(screen);
+  return pUI;
+}
+
+}  // namespace
+
+int main()
+{
+  if (!glfwInit())
+  {
+    cout << "Failed to initialize glfw\n";
+    return 1;
+  }
+  glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+  EntityManager::Initialize();
+
+  Screen screen;
+  if (!screen.Initialize(ScreenAttributes(kWidth, kHeight)))
+  {
+    glfwTerminate();
+    return 1;
+  }
+
+  // Positions and scales are relative to the parent element
+  UIComponent *pWindow =
+      CreateElement(screen, glm::vec3(.1f, .1f, 0), glm::vec3(.3f, .3f, 1), nullptr);
+  vector<UIComponent *> pPanels;
+  for (int i = 0; i < kPanelCount; ++i)
+  {
+    pPanels.push_back(CreateElement(screen, glm::vec3((i % 5) * .2f, (i / 5) * .25f, 0),
+                                    glm::vec3(.18f, .22f, 1), pWindow));
+  }
+  for (int i = 0; i < kWidgetCount; ++i)
+  {
+    const int slot = i / kPanelCount;
+    CreateElement(screen, glm::vec3((slot % 4) * .25f, (slot / 4) * .34f, 0),
+                  glm::vec3(.2f, .3f, 1), pPanels[i % kPanelCount]);
+  }
+  screen.UpdateLayout();
+
+  const glm::vec3 step(1.f / kWidth, 1.f / kHeight, 0);
+  vector<double> times;
+  for (int i = 0; i < kBlockCount; ++i)
+  {
+    const auto start = chrono::steady_clock::now();
+    for (int j = 0; j < kUpdatesPerBlock; ++j)
+    {
+      pWindow->GetMover()->AbsoluteMove(j < kSweepLength ? step : -step);
+      screen.Inform(pWindow, Screen::EIT_UPDATED);
+      screen.UpdateLayout();
+    }
+    times.push_back(
+        chrono::duration<double, micro>(chrono::steady_clock::now() - start).count() /
+        kUpdatesPerBlock);
+  }
+  sort(times.begin(), times.end());
+
+  cout << 1 + kPanelCount + kWidgetCount << " elements, "
+       << kBlockCount * kUpdatesPerBlock << " updates: best " << times.front()
+       << " us, median " << times[times.size() / 2] << " us per update\n";
+
+  screen.Shutdown();
+  glfwTerminate();
+  EntityManager::Shutdown();
+  return 0;
+}